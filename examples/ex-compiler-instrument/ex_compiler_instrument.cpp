@@ -0,0 +1,91 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+// Example of compiler-driven instrumentation: this file contains no timemory
+// instrumentation, it is compiled with -finstrument-functions and linked against
+// timemory-compiler-instrument. The call-graph is written at exit.
+//
+//  usage: ex_compiler_instrument [nthreads] [fibonacci]
+//
+//  try:
+//      TIMEMORY_COMPILER_EXCLUDE="^fibonacci"      ./ex_compiler_instrument
+//      TIMEMORY_COMPILER_INCLUDE="^(main|run)"     ./ex_compiler_instrument
+//      TIMEMORY_COMPILER_MIN_DURATION=10           ./ex_compiler_instrument
+//
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+//======================================================================================//
+
+int64_t
+fibonacci(int64_t n)
+{
+    return (n < 2) ? n : (fibonacci(n - 1) + fibonacci(n - 2));
+}
+
+//======================================================================================//
+
+double
+accumulate(int64_t n)
+{
+    std::vector<double> _data(n, 1.0);
+    double              _sum = 0.0;
+    for(auto itr : _data)
+        _sum += itr;
+    return _sum;
+}
+
+//======================================================================================//
+
+void
+run(int64_t nfib)
+{
+    auto _fib = fibonacci(nfib);
+    auto _sum = accumulate(1000000);
+    if(_fib < 0 || _sum < 0.0)
+        std::cerr << "unexpected result" << std::endl;
+}
+
+//======================================================================================//
+
+int
+main(int argc, char** argv)
+{
+    int     nthreads = (argc > 1) ? atoi(argv[1]) : 4;
+    int64_t nfib     = (argc > 2) ? atol(argv[2]) : 25;
+
+    std::vector<std::thread> threads;
+    for(int i = 0; i < nthreads; ++i)
+        threads.push_back(std::thread(run, nfib));
+    for(auto& itr : threads)
+        itr.join();
+
+    run(nfib);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+// Benchmark for storage<T>::get(): builds call-graphs with 10k - 1M nodes on several
+// threads and reports how long it takes to convert (and collapse) the graph.
+//
+//  usage: ex_cxx_storage [nthreads] [size] [size] ...
+//
+
+#include <timemory/timemory.hpp>
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace tim::component;
+
+using tuple_t   = tim::component_tuple<wall_clock>;
+using storage_t = tim::storage<wall_clock>;
+
+//======================================================================================//
+// create nodes [beg, end) in groups of 'width' children beneath a parent
+//
+void
+create_nodes(int64_t beg, int64_t end, int64_t width)
+{
+    for(int64_t i = beg; i < end; i += width)
+    {
+        tuple_t parent("group_" + std::to_string(i / width));
+        parent.start();
+        for(int64_t j = i; j < std::min<int64_t>(end, i + width); ++j)
+        {
+            tuple_t child("node_" + std::to_string(j));
+            child.start();
+            child.stop();
+        }
+        parent.stop();
+    }
+}
+
+//======================================================================================//
+
+double
+time_get(bool collapse, size_t& nrows)
+{
+    tim::settings::collapse_threads() = collapse;
+    wall_clock timer;
+    timer.start();
+    nrows = storage_t::instance()->get().size();
+    timer.stop();
+    return timer.get();
+}
+
+//======================================================================================//
+
+int
+main(int argc, char** argv)
+{
+    tim::settings::auto_output() = false;
+    tim::settings::json_output() = false;
+    tim::settings::text_output() = false;
+    tim::settings::cout_output() = false;
+    tim::timemory_init(argc, argv);
+
+    int64_t nthreads = 4;
+    if(argc > 1)
+        nthreads = std::max<int64_t>(1, atol(argv[1]));
+
+    std::vector<int64_t> sizes = { 10000, 100000, 1000000 };
+    if(argc > 2)
+    {
+        sizes.clear();
+        for(int i = 2; i < argc; ++i)
+            sizes.push_back(atol(argv[i]));
+    }
+
+    const int64_t width = 1000;
+    int64_t       ncurr = 0;
+
+    std::cout << "\n" << std::setw(12) << "nodes" << std::setw(12) << "rows"
+              << std::setw(16) << "get() [sec]" << std::setw(12) << "rows"
+              << std::setw(24) << "get(collapse) [sec]" << std::setw(16)
+              << "[usec/node]" << std::endl;
+
+    for(auto nsize : sizes)
+    {
+        if(nsize <= ncurr)
+            continue;
+
+        // every thread creates the same nodes so that there is something to collapse
+        std::vector<std::thread> threads;
+        for(int64_t i = 1; i < nthreads; ++i)
+            threads.push_back(std::thread(create_nodes, ncurr, nsize, width));
+        create_nodes(ncurr, nsize, width);
+        for(auto& itr : threads)
+            itr.join();
+        ncurr = nsize;
+
+        size_t nflat     = 0;
+        size_t ncollapse = 0;
+        auto   tflat     = time_get(false, nflat);
+        auto   tcollapse = time_get(true, ncollapse);
+
+        std::cout << std::setw(12) << storage_t::instance()->size() << std::setw(12)
+                  << nflat << std::setw(16) << std::setprecision(6) << std::fixed
+                  << tflat << std::setw(12) << ncollapse << std::setw(24) << tcollapse
+                  << std::setw(16) << (tcollapse / nflat) * 1.0e6 << std::endl;
+    }
+    std::cout << std::endl;
+
+    tim::timemory_finalize();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+// Example of the OMPT tool: this file contains no timemory instrumentation, the
+// OpenMP runtime activates timemory-ompt because the library is linked. Each thread
+// of the parallel region waits a different time before the explicit barrier and the
+// iterations of the loop have different costs so the report shows the load imbalance
+// and the barrier wait time. The recursive tasks are folded into a single node.
+//
+//  usage: ex_ompt [iterations] [fibonacci]
+//
+//  requires an OMPT-capable runtime. With GCC, run against LLVM libomp:
+//      LD_PRELOAD=/path/to/libomp.so ./ex_ompt
+//
+//  try:
+//      TIMEMORY_OMPT_TASKS=OFF     ./ex_ompt
+//
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+#include <omp.h>
+#include <unistd.h>
+
+//======================================================================================//
+
+double
+work(int64_t n)
+{
+    double _sum = 0.0;
+    for(int64_t i = 0; i < n; ++i)
+        _sum += std::sqrt(static_cast<double>(i));
+    return _sum;
+}
+
+//======================================================================================//
+
+int64_t
+fibonacci(int64_t n)
+{
+    if(n < 12)
+        return (n < 2) ? n : (fibonacci(n - 1) + fibonacci(n - 2));
+
+    int64_t a = 0;
+    int64_t b = 0;
+#pragma omp task shared(a)
+    a = fibonacci(n - 1);
+#pragma omp task shared(b)
+    b = fibonacci(n - 2);
+#pragma omp taskwait
+    return a + b;
+}
+
+//======================================================================================//
+
+int
+main(int argc, char** argv)
+{
+    int     nitr = (argc > 1) ? atoi(argv[1]) : 3;
+    int64_t nfib = (argc > 2) ? atol(argv[2]) : 20;
+
+    double _sum = 0.0;
+    for(int i = 0; i < nitr; ++i)
+    {
+#pragma omp parallel reduction(+ : _sum)
+        {
+            // imbalanced arrival at the barrier
+            usleep(2000 * omp_get_thread_num());
+#pragma omp barrier
+
+            // imbalanced iterations
+#pragma omp for schedule(static)
+            for(int j = 0; j < 64; ++j)
+                _sum += work(10000 * (j % 8));
+
+#pragma omp single
+            _sum += fibonacci(nfib);
+        }
+    }
+
+    if(_sum < 0.0)
+        std::cerr << "unexpected result" << std::endl;
+    return EXIT_SUCCESS;
+}
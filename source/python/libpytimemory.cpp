@@ -221,7 +221,11 @@ PYBIND11_MODULE(libpytimemory, tim)
         auto _prefix = tim::settings::output_prefix();
 
         using type_tuple = typename auto_list_t::type_tuple;
-        tim::manager::get_storage<type_tuple>::print();
+        {
+            // merging and writing the output does not touch any python objects
+            py::gil_scoped_release _gil;
+            tim::manager::get_storage<type_tuple>::print();
+        }
 
         if(fname.length() > 0)
         {
@@ -232,11 +236,37 @@ PYBIND11_MODULE(libpytimemory, tim)
     //----------------------------------------------------------------------------------//
     auto _as_json = [&]() {
         using type_tuple = typename auto_list_t::type_tuple;
-        auto json_str    = manager_t::get_storage<type_tuple>::serialize();
+        std::string json_str;
+        {
+            py::gil_scoped_release _gil;
+            json_str = manager_t::get_storage<type_tuple>::serialize();
+        }
         auto json_module = py::module::import("json");
         return json_module.attr("loads")(json_str);
     };
     //----------------------------------------------------------------------------------//
+    auto _pack = [&]() {
+        using type_tuple = typename auto_list_t::type_tuple;
+        std::string _data;
+        {
+            py::gil_scoped_release _gil;
+            _data = manager_t::get_storage<type_tuple>::pack();
+        }
+        return py::bytes(_data);
+    };
+    //----------------------------------------------------------------------------------//
+    auto _merge = [&](py::bytes _packed) {
+        using type_tuple  = typename auto_list_t::type_tuple;
+        std::string _data = _packed;
+        py::gil_scoped_release _gil;
+        manager_t::get_storage<type_tuple>::unpack(_data);
+    };
+    //----------------------------------------------------------------------------------//
+    auto _clear = [&]() {
+        using type_tuple = typename auto_list_t::type_tuple;
+        manager_t::get_storage<type_tuple>::clear();
+    };
+    //----------------------------------------------------------------------------------//
     auto set_rusage_child = [&]() {
 #if !defined(_WINDOWS)
         tim::get_rusage_type() = RUSAGE_CHILDREN;
@@ -317,6 +347,24 @@ PYBIND11_MODULE(libpytimemory, tim)
             py::arg("suffix") = "-output");
     //----------------------------------------------------------------------------------//
     tim.def("get", _as_json, "Get the storage data");
+    //----------------------------------------------------------------------------------//
+    tim.def("pack", _pack,
+            "Get the storage data in a compact binary form (e.g. to send it to "
+            "another process running the same executable)");
+    //----------------------------------------------------------------------------------//
+    tim.def("merge", _merge, "Merge the storage data returned by pack()",
+            py::arg("data"));
+    //----------------------------------------------------------------------------------//
+    tim.def("clear", _clear, "Clear the storage data",
+            py::call_guard<py::gil_scoped_release>());
+    //----------------------------------------------------------------------------------//
+    tim.def("thread_exit", &tim::thread_exit,
+            "Merge the storage data of the calling thread before it exits",
+            py::call_guard<py::gil_scoped_release>());
+    //----------------------------------------------------------------------------------//
+    tim.def("timemory_finalize", &tim::timemory_finalize,
+            "Merge the storage data and generate the output",
+            py::call_guard<py::gil_scoped_release>());
 
     //==================================================================================//
     //
@@ -341,6 +389,8 @@ PYBIND11_MODULE(libpytimemory, tim)
     SETTING_PROPERTY(int, verbose);
     SETTING_PROPERTY(bool, debug);
     SETTING_PROPERTY(bool, banner);
+    SETTING_PROPERTY(bool, thread_output);
+    SETTING_PROPERTY(uint64_t, storage_pool_size);
     SETTING_PROPERTY(uint16_t, max_depth);
     SETTING_PROPERTY(int16_t, precision);
     SETTING_PROPERTY(int16_t, width);
@@ -390,8 +440,20 @@ PYBIND11_MODULE(libpytimemory, tim)
     SETTING_PROPERTY(bool, enable_signal_handler);
     SETTING_PROPERTY(bool, enable_all_signals);
     SETTING_PROPERTY(bool, disable_all_signals);
+    SETTING_PROPERTY(bool, crash_dump);
+    SETTING_PROPERTY(bool, trace);
+    SETTING_PROPERTY(uint64_t, trace_chunk_size);
+    SETTING_PROPERTY(uint64_t, trace_max_chunks);
+    SETTING_PROPERTY(bool, trace_drop_oldest);
+    SETTING_PROPERTY(bool, shared_profile);
+    SETTING_PROPERTY(uint64_t, shared_profile_slots);
+    SETTING_PROPERTY(uint64_t, shared_profile_slot_size);
     SETTING_PROPERTY(int32_t, node_count);
     SETTING_PROPERTY(bool, destructor_report);
+    SETTING_PROPERTY(bool, overhead_correction);
+    SETTING_PROPERTY(string_t, pressure_root);
+    SETTING_PROPERTY(string_t, cgroup_root);
+    SETTING_PROPERTY(string_t, rapl_root);
 
     //==================================================================================//
     //
@@ -0,0 +1,12 @@
+# Runs timemory-compare on two result sets and fails when the exit code differs from
+# EXPECTED (0: no regressions, 1: regressions, 2: error)
+#
+#   cmake -DCOMMAND=<exe> -DBASELINE=<file> -DRESULT=<file> -DEXPECTED=<code> -P <this>
+#
+execute_process(
+    COMMAND         ${COMMAND} ${BASELINE} ${RESULT}
+    RESULT_VARIABLE _RET)
+
+if(NOT "${_RET}" STREQUAL "${EXPECTED}")
+    message(FATAL_ERROR "timemory-compare ${BASELINE} ${RESULT} returned '${_RET}', expected ${EXPECTED}")
+endif()
@@ -0,0 +1,176 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gtest/gtest.h"
+
+#include <timemory/timemory.hpp>
+
+#include "compiler_instrument_tests_lib.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tim::component;
+
+extern "C" void
+timemory_compiler_instrument_stop();
+
+extern "C" void
+timemory_compiler_instrument_finalize();
+
+//--------------------------------------------------------------------------------------//
+
+namespace details
+{
+//--------------------------------------------------------------------------------------//
+//  laps and depth of the entries of the wall_clock call-graph whose prefix contains
+//  "_func"
+//
+struct entry_info
+{
+    int64_t laps  = 0;
+    int64_t depth = -1;
+};
+
+inline entry_info
+get_entry(const std::string& _func)
+{
+    entry_info _info;
+    for(const auto& itr : tim::storage<wall_clock>::instance()->get())
+    {
+        if(std::get<2>(itr).find(_func) == std::string::npos)
+            continue;
+        _info.laps += std::get<1>(itr).nlaps();
+        _info.depth = std::get<3>(itr);
+    }
+    return _info;
+}
+
+//--------------------------------------------------------------------------------------//
+//  finalize while the workers keep calling instrumented functions. Returns whether
+//  the hooks kept working as no-ops afterwards
+//
+inline bool
+finalize_in_flight()
+{
+    std::atomic<bool>        _stop(false);
+    std::atomic<int64_t>     _count(0);
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 4; ++i)
+    {
+        threads.push_back(std::thread([&]() {
+            while(!_stop.load())
+            {
+                ext::outer_work(2, 100);
+                ++_count;
+            }
+        }));
+    }
+
+    while(_count.load() < 100)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    timemory_compiler_instrument_finalize();
+    auto _finalized = _count.load();
+
+    // the hooks are no-ops after finalizing
+    while(_count.load() < _finalized + 100)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    bool _ret = (ext::outer_work(2, 100) != 0.0);
+
+    _stop.store(true);
+    for(auto& itr : threads)
+        itr.join();
+
+    // finalizing again is a no-op
+    timemory_compiler_instrument_finalize();
+    return (_ret && _count.load() >= _finalized + 100);
+}
+
+}  // namespace details
+
+//--------------------------------------------------------------------------------------//
+
+class compiler_instrument_tests : public ::testing::Test
+{};
+
+//--------------------------------------------------------------------------------------//
+//  runs in a child process since recording stops for good
+//
+TEST_F(compiler_instrument_tests, finalize_in_flight)
+{
+    EXPECT_EXIT(std::_Exit(details::finalize_in_flight() ? EXIT_SUCCESS : EXIT_FAILURE),
+                ::testing::ExitedWithCode(EXIT_SUCCESS), "");
+}
+
+//--------------------------------------------------------------------------------------//
+//  must be the last test: recording stops
+//
+TEST_F(compiler_instrument_tests, call_graph)
+{
+    EXPECT_NE(ext::outer_work(5, 1000), 0.0);
+
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 4; ++i)
+        threads.push_back(std::thread([]() { ext::outer_work(3, 1000); }));
+    for(auto& itr : threads)
+        itr.join();
+
+    // the call-graphs are only folded into the storage of the component (and the
+    // threads merged by call-path) when recording stops
+    EXPECT_EQ(details::get_entry("outer_work").laps, 0);
+    timemory_compiler_instrument_stop();
+
+    auto _outer = details::get_entry("outer_work");
+    auto _inner = details::get_entry("inner_work");
+    EXPECT_EQ(_outer.laps, 5);
+    EXPECT_EQ(_inner.laps, 17);
+    EXPECT_GE(_outer.depth, 0);
+    EXPECT_EQ(_inner.depth, _outer.depth + 1);
+
+    // stopping again is a no-op and the hooks do not record anymore
+    EXPECT_NE(ext::outer_work(5, 1000), 0.0);
+    timemory_compiler_instrument_stop();
+    EXPECT_EQ(details::get_entry("outer_work").laps, 5);
+}
+
+//--------------------------------------------------------------------------------------//
+
+int
+main(int argc, char** argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    tim::timemory_init(argc, argv);
+    tim::settings::file_output() = false;
+    tim::settings::banner()      = false;
+
+    return RUN_ALL_TESTS();
+}
+
+//--------------------------------------------------------------------------------------//
@@ -0,0 +1,56 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "compiler_instrument_tests_lib.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+namespace ext
+{
+//--------------------------------------------------------------------------------------//
+
+double
+inner_work(int64_t nitr)
+{
+    double _sum = 0.0;
+    for(int64_t i = 0; i < nitr; ++i)
+        _sum += std::cos(static_cast<double>(i));
+    return _sum;
+}
+
+//--------------------------------------------------------------------------------------//
+
+double
+outer_work(int64_t ninner, int64_t nitr)
+{
+    double _sum = 0.0;
+    for(int64_t i = 0; i < ninner; ++i)
+        _sum += inner_work(nitr);
+    return _sum;
+}
+
+//--------------------------------------------------------------------------------------//
+
+}  // namespace ext
@@ -24,6 +24,8 @@
 //
 
 #include "gotcha_tests_lib.hpp"
+#include "timemory/components/derived/io_tracker.hpp"
+#include "timemory/components/derived/lock_contention.hpp"
 #include "timemory/components/derived/malloc_gotcha.hpp"
 
 #include "gtest/gtest.h"
@@ -50,6 +52,7 @@ using gotcha_hybrid_t = tim::auto_hybrid<gotcha_tuple_t, gotcha_list_t>;
 using mpi_gotcha_t    = tim::component::gotcha<1, gotcha_hybrid_t>;
 using work_gotcha_t   = tim::component::gotcha<1, gotcha_hybrid_t, int>;
 using memfun_gotcha_t = tim::component::gotcha<3, gotcha_tuple_t>;
+using sample_gotcha_t = tim::component::gotcha<1, gotcha_tuple_t, long>;
 
 using comp_t  = component_tuple<real_clock, cpu_clock, peak_rss>;
 using tuple_t = component_tuple<comp_t, mpi_gotcha_t, work_gotcha_t, memfun_gotcha_t>;
@@ -335,6 +338,53 @@ TEST_F(gotcha_tests, work_macro)
 
 //======================================================================================//
 
+TEST_F(gotcha_tests, work_sampled)
+{
+    using pair_type     = std::pair<float, double>;
+    using sample_tool_t = tim::auto_tuple<real_clock, sample_gotcha_t>;
+
+    constexpr int64_t period = 10;
+
+    sample_gotcha_t::get_default_sampler() = gotcha_sampler::every(period);
+    sample_gotcha_t::get_initializer()     = [=]() {
+        PRINT_HERE(details::get_test_name().c_str());
+        TIMEMORY_CXX_GOTCHA_TOOL(sample_gotcha_t, 0, ext::do_work, 0, "sampled");
+    };
+
+    float  fsum = 0.0;
+    double dsum = 0.0;
+    {
+        sample_tool_t tool(details::get_test_name());
+        for(int i = 0; i < nitr; ++i)
+        {
+            auto ret = ext::do_work(1000, pair_type(0.25, 0.125));
+            fsum += std::get<0>(ret);
+            dsum += std::get<1>(ret);
+        }
+    }
+
+    ASSERT_NEAR(fsum, -2416347.50, tolerance);
+    ASSERT_NEAR(dsum, -1829370.79, tolerance);
+
+#if defined(TIMEMORY_USE_GOTCHA)
+    ASSERT_EQ(sample_gotcha_t::get_call_count(0), nitr);
+    ASSERT_EQ(sample_gotcha_t::get_sampled_count(0), nitr / period);
+
+    // the measured laps of the wrapped function are exact even though only one out of
+    // every "period" calls is measured ("nitr" is a multiple of "period"). Only the
+    // nodes with the tool label of this wrapper are counted because the other tests
+    // record "do_work" into the same storage
+    static_assert(nitr % period == 0, "nitr must be a multiple of the period");
+    int64_t nlaps = 0;
+    for(const auto& itr : tim::storage<real_clock>::instance()->get())
+        if(std::get<2>(itr).find("sampled/") != std::string::npos)
+            nlaps += std::get<1>(itr).nlaps();
+    ASSERT_EQ(nlaps, nitr);
+#endif
+}
+
+//======================================================================================//
+
 template <typename func_t>
 void
 print_func_info(const std::string& fname)
@@ -425,6 +475,119 @@ TEST_F(gotcha_tests, malloc_gotcha)
 
 //======================================================================================//
 
+TEST_F(gotcha_tests, lock_contention)
+{
+    using lock_gotcha_spec_t = lock_contention::gotcha_spec<gotcha_tuple_t>;
+    using lock_gotcha_t      = typename lock_gotcha_spec_t::gotcha_type;
+    using toolset_t          = tim::auto_tuple<gotcha_tuple_t, lock_gotcha_t>;
+
+    lock_gotcha_t::get_initializer() = lock_gotcha_spec_t::get_initializer();
+
+    static pthread_mutex_t _mutex   = PTHREAD_MUTEX_INITIALIZER;
+    static constexpr int   nthreads = 4;
+    static constexpr int   nlocks   = 1000;
+    int64_t                _counter = 0;
+
+    auto _contend = [&]() {
+        for(int i = 0; i < nlocks; ++i)
+        {
+            pthread_mutex_lock(&_mutex);
+            ++_counter;
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+            pthread_mutex_unlock(&_mutex);
+        }
+    };
+
+    toolset_t tool(details::get_test_name());
+
+    std::vector<std::thread> _threads;
+    for(int i = 0; i < nthreads; ++i)
+        _threads.push_back(std::thread(_contend));
+    for(auto& itr : _threads)
+        itr.join();
+
+    tool.stop();
+
+    ASSERT_EQ(_counter, nthreads * nlocks);
+
+    // only the contended acquires are recorded for the mutex address
+    auto _addresses = lock_contention::get_addresses();
+    auto _itr       = std::find_if(_addresses.begin(), _addresses.end(),
+                             [](const lock_contention::address_entry& _entry) {
+                                 return _entry.address == (uintptr_t)(&_mutex);
+                             });
+#if defined(TIMEMORY_USE_GOTCHA)
+    ASSERT_TRUE(_itr != _addresses.end());
+    EXPECT_GT(_itr->count, 0);
+    EXPECT_LT(_itr->count, nthreads * nlocks);
+    EXPECT_GT(_itr->wait, 0);
+#else
+    EXPECT_TRUE(_itr == _addresses.end());
+#endif
+}
+
+//======================================================================================//
+
+TEST_F(gotcha_tests, io_tracker)
+{
+    using io_gotcha_spec_t = io_tracker::gotcha_spec<gotcha_tuple_t>;
+    using io_gotcha_t      = typename io_gotcha_spec_t::gotcha_type;
+    using toolset_t        = tim::auto_tuple<gotcha_tuple_t, io_gotcha_t>;
+
+    io_gotcha_t::get_initializer() = io_gotcha_spec_t::get_initializer();
+
+    static constexpr int    niter = 100;
+    static constexpr size_t nsize = 4096;
+    std::string             _path = "/tmp/" + details::get_test_name() + ".dat";
+    std::vector<char>       _buffer(nsize, 'a');
+
+    toolset_t tool(details::get_test_name());
+
+    int _fd = open(_path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+    ASSERT_GE(_fd, 0);
+    for(int i = 0; i < niter; ++i)
+        ASSERT_EQ(write(_fd, _buffer.data(), nsize), (ssize_t) nsize);
+    fsync(_fd);
+    for(int i = 0; i < niter; ++i)
+        ASSERT_EQ(pread(_fd, _buffer.data(), nsize, i * nsize), (ssize_t) nsize);
+    close(_fd);
+
+    FILE* _fp = fopen(_path.c_str(), "r");
+    ASSERT_TRUE(_fp != nullptr);
+    for(int i = 0; i < niter; ++i)
+        ASSERT_EQ(fread(_buffer.data(), 1, nsize, _fp), nsize);
+    fclose(_fp);
+
+    // the descriptor released by fclose is typically reused by the pipe, its I/O must
+    // not be attributed to the path
+    int _pipe[2];
+    ASSERT_EQ(pipe(_pipe), 0);
+    ASSERT_EQ(write(_pipe[1], _buffer.data(), nsize), (ssize_t) nsize);
+    close(_pipe[0]);
+    close(_pipe[1]);
+
+    tool.stop();
+    std::remove(_path.c_str());
+
+    // both the descriptor from open and the stream from fopen map to the same path
+    auto _paths = io_tracker::get_paths();
+    auto _itr   = std::find_if(_paths.begin(), _paths.end(),
+                             [&](const io_tracker::path_entry& _entry) {
+                                 return _entry.path == _path;
+                             });
+#if defined(TIMEMORY_USE_GOTCHA)
+    ASSERT_TRUE(_itr != _paths.end());
+    // open + write + fsync + pread + fopen + fread
+    EXPECT_EQ(_itr->calls, 3 * niter + 3);
+    EXPECT_EQ(_itr->bytes, 3 * niter * (int64_t) nsize);
+    EXPECT_GT(_itr->latency, 0);
+#else
+    EXPECT_TRUE(_itr == _paths.end());
+#endif
+}
+
+//======================================================================================//
+
 TEST_F(gotcha_tests, member_functions)
 {
     using pair_type = std::pair<float, double>;
@@ -154,6 +154,13 @@ report(const _Tp& measured_count, const _Tp& explicit_count, const _Tp& toleranc
     std::cout << "\n";
 }
 //--------------------------------------------------------------------------------------//
+// fibonacci calculation
+int64_t
+fibonacci(int32_t n)
+{
+    return (n < 2) ? n : fibonacci(n - 1) + fibonacci(n - 2);
+}
+//--------------------------------------------------------------------------------------//
 }  // namespace details
 
 //--------------------------------------------------------------------------------------//
@@ -313,6 +320,144 @@ TEST_F(papi_tests, array_load_store_ins_dp)
         FAIL();
 }
 
+//--------------------------------------------------------------------------------------//
+
+TEST_F(papi_tests, compact_graph_node)
+{
+    using array_node_t    = typename papi_array_t::storage_type::graph_node;
+    using roofline_node_t = typename cpu_roofline_dp_flops::storage_type::graph_node;
+    using array_full_t    = std::tuple<uint64_t, papi_array_t, int64_t>;
+    using roofline_full_t = std::tuple<uint64_t, cpu_roofline_dp_flops, int64_t>;
+
+    // both add data members to their base and accumulate through their own operator+=
+    // so the nodes hold the entire component
+    EXPECT_EQ(sizeof(array_node_t), sizeof(array_full_t));
+    EXPECT_EQ(sizeof(roofline_node_t), sizeof(roofline_full_t));
+
+    CHECK_AVAILABLE(papi_array_t);
+
+    papi_array_t::get_initializer() = []() { return std::vector<int>({ PAPI_TOT_INS }); };
+
+    papi_array_t obj;
+    for(int i = 0; i < 2; ++i)
+    {
+        obj.start();
+        details::fibonacci(30);
+        obj.stop();
+    }
+
+    array_node_t node(0, obj, 1);
+    node.accumulate(obj);
+    for(size_t i = 0; i < obj.get_accum().size(); ++i)
+        EXPECT_EQ(node.get_accum()[i], 2 * obj.get_accum()[i]);
+    EXPECT_EQ(node.get_laps(), 2 * obj.nlaps());
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(papi_tests, roofline_ceilings)
+{
+    const double giga = static_cast<double>(tim::units::gigabyte);
+
+    // ERT runs of ascending working-set size (1 op per set): an L1 plateau at ~200
+    // GB/s, a DRAM plateau at ~20 GB/s and the compute peak in a run with 8 ops per set
+    tim::ert::exec_data _data;
+    auto _add = [&](uint64_t _wset, double _bandwidth, double _flops, double _ops) {
+        _data += std::make_tuple(std::string("roofline_ceilings"), _wset, uint64_t(1),
+                                 0.0, uint64_t(0), uint64_t(0), _bandwidth * giga,
+                                 _flops * giga, _ops, std::string("cpu"),
+                                 std::string("double"), tim::ert::exec_params{});
+    };
+    for(uint64_t i = 0; i < 32; ++i)
+        _add(1024 * (i + 1), 200.0 * (1.0 + 0.002 * (i % 5)), 25.0, 1.0);
+    for(uint64_t i = 0; i < 32; ++i)
+        _add(1024 * (i + 33), 20.0 * (1.0 + 0.002 * (i % 5)), 2.5, 1.0);
+    _add(1024, 150.0, 100.0, 8.0);
+    _add(2048, 140.0, 90.0, 8.0);
+
+    auto _ceilings = tim::ert::get_ceilings(_data);
+
+    EXPECT_FALSE(_ceilings.empty());
+    EXPECT_NEAR(_ceilings.peak_flops(), 100.0, 1.0e-6);
+    ASSERT_EQ(_ceilings.bandwidth.size(), 2);
+    EXPECT_EQ(_ceilings.bandwidth.at(0).label, "L1 GB/s");
+    EXPECT_EQ(_ceilings.bandwidth.at(1).label, "DRAM GB/s");
+    EXPECT_NEAR(_ceilings.bandwidth.at(0).value, 200.0, 4.0);
+    EXPECT_NEAR(_ceilings.bandwidth.at(1).value, 20.0, 0.4);
+    EXPECT_NEAR(_ceilings.peak_bandwidth(), _ceilings.bandwidth.at(0).value, 1.0e-6);
+
+    // memory-bound below the ridge point, compute-bound above it
+    EXPECT_NEAR(_ceilings.roof(0.1), 0.1 * _ceilings.peak_bandwidth(), 1.0e-6);
+    EXPECT_NEAR(_ceilings.roof(10.0), 100.0, 1.0e-6);
+    EXPECT_NEAR(_ceilings.roof(0.0), 100.0, 1.0e-6);
+
+    // without runs there are no ceilings
+    tim::ert::exec_data _empty;
+    EXPECT_TRUE(tim::ert::get_ceilings(_empty).empty());
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(papi_tests, roofline_analysis)
+{
+    using roofline_t = cpu_roofline_dp_flops;
+    using value_type = typename roofline_t::value_type;
+    using entry_t    = std::tuple<uint64_t, roofline_t, std::string, int64_t,
+                               std::vector<uint64_t>, std::vector<std::string>>;
+
+    // storage-like type with the layout of the entries of the storage
+    struct synthetic_storage
+    {
+        std::vector<entry_t>        entries;
+        const std::vector<entry_t>& get() const { return entries; }
+    } _store;
+
+    // an entry which counted _ops FLOPs in _sec seconds
+    auto _add = [&](const std::string& _label, long long _ops, double _sec) {
+        roofline_t _obj;
+        bool       _started = false;
+        _obj.configure_record([=]() mutable {
+            auto _ret = (_started) ? value_type({ _ops }, _sec * tim::units::sec)
+                                   : value_type({ 0 }, 0.0);
+            _started  = true;
+            return _ret;
+        });
+        _obj.start();
+        _obj.stop();
+        _store.entries.push_back(entry_t(0, _obj, _label, 0, { 0 }, { _label }));
+    };
+
+    const long long giga = tim::units::gigabyte;
+    _add("compute_bound", 90 * giga, 1.0);  // 90 GFLOP/s
+    _add("memory_bound", 10 * giga, 2.0);   //  5 GFLOP/s
+    _add("short", 1 * giga, 0.1);           // 10 GFLOP/s
+    _add("no_flops", 0, 1.0);
+
+    tim::ert::ceilings _ceilings;
+    _ceilings.flops.value = 100.0;
+    _ceilings.bandwidth   = { { "L1 GB/s", 200.0 }, { "DRAM GB/s", 20.0 } };
+
+    auto _mode               = roofline_t::event_mode();
+    roofline_t::event_mode() = roofline_t::MODE::OP;
+    auto _analysis           = roofline_t::analyze(&_store, _ceilings);
+    roofline_t::event_mode() = _mode;
+
+    // ranked by the time recovered at the roof: 2 * (1 - 0.05), 1 * (1 - 0.9),
+    // 0.1 * (1 - 0.1). Entries without FLOPs are not ranked
+    ASSERT_EQ(_analysis.size(), 3);
+    EXPECT_EQ(_analysis.at(0).label, "memory_bound");
+    EXPECT_EQ(_analysis.at(1).label, "compute_bound");
+    EXPECT_EQ(_analysis.at(2).label, "short");
+
+    EXPECT_NEAR(_analysis.at(0).attained, 5.0, 1.0e-6);
+    EXPECT_NEAR(_analysis.at(0).roof, 100.0, 1.0e-6);
+    EXPECT_NEAR(_analysis.at(0).recoverable(), 1.9, 1.0e-6);
+    EXPECT_NEAR(_analysis.at(1).recoverable(), 0.1, 1.0e-6);
+    EXPECT_NEAR(_analysis.at(2).recoverable(), 0.09, 1.0e-6);
+    for(size_t i = 1; i < _analysis.size(); ++i)
+        EXPECT_GE(_analysis.at(i - 1).recoverable(), _analysis.at(i).recoverable());
+}
+
 //--------------------------------------------------------------------------------------//
 /*
 TEST_F(papi_tests, array_load_store_ins_tp)
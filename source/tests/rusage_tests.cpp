@@ -24,9 +24,17 @@
 
 #include "gtest/gtest.h"
 
+#include <timemory/components/derived/numa_memory.hpp>
+#include <timemory/components/derived/pressure_stall.hpp>
+#include <timemory/components/derived/rapl_energy.hpp>
+#include <timemory/components/derived/sched_delay.hpp>
 #include <timemory/timemory.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <mutex>
 #include <random>
@@ -240,6 +248,268 @@ TEST_F(rusage_tests, written_bytes)
 
 //--------------------------------------------------------------------------------------//
 
+#if defined(_LINUX)
+TEST_F(rusage_tests, sched_delay)
+{
+    // oversubscribe the cores so the threads have to wait in the run-queue
+    auto _nthreads = 4 * std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    std::vector<sched_delay>      _delay(_nthreads);
+    std::vector<oversubscription> _over(_nthreads);
+    std::atomic<bool>             _ready(false);
+
+    // all the threads compete for the cores at the same time
+    auto _run = [&](unsigned i) {
+        while(!_ready.load())
+            std::this_thread::yield();
+        _delay[i].start();
+        _over[i].start();
+        volatile long _ret = details::fibonacci(30);
+        (void) _ret;
+        _over[i].stop();
+        _delay[i].stop();
+    };
+
+    std::vector<std::thread> _threads;
+    for(unsigned i = 0; i < _nthreads; ++i)
+        _threads.push_back(std::thread(_run, i));
+    _ready.store(true);
+    for(auto& itr : _threads)
+        itr.join();
+
+    std::cout << "\n[" << details::get_test_name() << "]> " << _delay.front()
+              << std::endl;
+    std::cout << "[" << details::get_test_name() << "]> " << _over.front() << std::endl;
+
+    // zero when the kernel does not provide schedstat
+    if(_delay.front().get_run_time() == 0)
+        return;
+
+    for(unsigned i = 0; i < _nthreads; ++i)
+    {
+        EXPECT_GT(_delay[i].get_run_time(), 0);
+        EXPECT_GE(_delay[i].get_run_delay(), 0);
+        EXPECT_GE(_delay[i].get_timeslices(), 1);
+        EXPECT_GE(_over[i].get(), 0.0);
+        EXPECT_LE(_over[i].get(), 100.0);
+    }
+
+    // at least one of the threads must have waited in the run-queue
+    int64_t _max_delay = 0;
+    for(const auto& itr : _delay)
+        _max_delay = std::max<int64_t>(_max_delay, itr.get_run_delay());
+    EXPECT_GT(_max_delay, 0);
+}
+#endif
+
+//--------------------------------------------------------------------------------------//
+
+#if defined(_LINUX)
+TEST_F(rusage_tests, pressure_stall)
+{
+    // fake pressure-stall and cgroup files
+    std::string _root = "/tmp/" + details::get_test_name();
+    ASSERT_EQ(system(("mkdir -p " + _root + "/pressure " + _root + "/cgroup").c_str()),
+              0);
+
+    auto _write = [&](const std::string& _fname, const std::string& _contents) {
+        std::ofstream ofs(_root + "/" + _fname);
+        ofs << _contents;
+    };
+
+    auto _write_all = [&](int64_t _total, int64_t _throttled, int64_t _high) {
+        std::stringstream ss;
+        ss << "some avg10=0.00 avg60=0.00 avg300=0.00 total=" << 2 * _total << "\n"
+           << "full avg10=0.00 avg60=0.00 avg300=0.00 total=" << _total << "\n";
+        _write("pressure/cpu", ss.str());
+        _write("pressure/memory", ss.str());
+        _write("pressure/io", ss.str());
+
+        ss.str("");
+        ss << "usage_usec 100\nuser_usec 60\nsystem_usec 40\nnr_periods "
+           << 10 * _throttled << "\nnr_throttled " << _throttled << "\nthrottled_usec "
+           << 1000 * _throttled << "\n";
+        _write("cgroup/cpu.stat", ss.str());
+
+        ss.str("");
+        ss << "low 0\nhigh " << _high << "\nmax 0\noom 0\noom_kill 0\n";
+        _write("cgroup/memory.events", ss.str());
+    };
+
+    auto _pressure_root = tim::settings::pressure_root();
+    auto _cgroup_root   = tim::settings::cgroup_root();
+
+    tim::settings::pressure_root() = _root + "/pressure";
+    tim::settings::cgroup_root()   = _root + "/cgroup";
+    pressure_stall::reset();
+    cgroup_throttle::reset();
+
+    _write_all(1000, 2, 1);
+
+    pressure_stall  _pressure;
+    cgroup_throttle _cgroup;
+    _pressure.start();
+    _cgroup.start();
+
+    // the files are re-written in place so the cached descriptors see the update
+    _write_all(4000, 5, 3);
+
+    _cgroup.stop();
+    _pressure.stop();
+
+    std::cout << "\n[" << details::get_test_name() << "]> " << _pressure << std::endl;
+    std::cout << "[" << details::get_test_name() << "]> " << _cgroup << std::endl;
+
+    for(size_t i = 0; i < 6; ++i)
+        EXPECT_EQ(_pressure.get_accum()[i], (i % 2 == 0) ? 6000 : 3000) << "index " << i;
+
+    EXPECT_EQ(_cgroup.get_accum()[0], 3000);
+    EXPECT_EQ(_cgroup.get_throttled_periods(), 3);
+    EXPECT_EQ(_cgroup.get_memory_high(), 2);
+    EXPECT_EQ(_cgroup.get_oom_kill(), 0);
+
+    tim::settings::pressure_root() = _pressure_root;
+    tim::settings::cgroup_root()   = _cgroup_root;
+    pressure_stall::reset();
+    cgroup_throttle::reset();
+}
+#endif
+
+//--------------------------------------------------------------------------------------//
+
+#if defined(_LINUX)
+TEST_F(rusage_tests, rapl_energy)
+{
+    // fake powercap tree with two packages, the first package wraps around
+    std::string _root = "/tmp/" + details::get_test_name();
+    ASSERT_EQ(system(("rm -rf " + _root + " && mkdir -p " + _root + "/intel-rapl:0 " +
+                      _root + "/intel-rapl:0:0 " + _root + "/intel-rapl:1")
+                         .c_str()),
+              0);
+
+    auto _write = [&](const std::string& _zone, const std::string& _fname,
+                      const std::string& _contents) {
+        std::ofstream ofs(_root + "/" + _zone + "/" + _fname);
+        ofs << _contents << "\n";
+    };
+
+    _write("intel-rapl:0", "name", "package-0");
+    _write("intel-rapl:0:0", "name", "dram");
+    _write("intel-rapl:1", "name", "package-1");
+    for(auto itr : { "intel-rapl:0", "intel-rapl:0:0", "intel-rapl:1" })
+        _write(itr, "max_energy_range_uj", "1000000");
+
+    _write("intel-rapl:0", "energy_uj", "999000");
+    _write("intel-rapl:0:0", "energy_uj", "1000");
+    _write("intel-rapl:1", "energy_uj", "5000");
+
+    auto _rapl_root            = tim::settings::rapl_root();
+    tim::settings::rapl_root() = _root;
+    rapl_energy::reset();
+
+    ASSERT_TRUE(rapl_energy::is_available());
+    ASSERT_EQ(rapl_energy::get_domains().size(), 3u);
+    EXPECT_EQ(rapl_energy::get_domains().at(0).label, "package-0");
+    EXPECT_EQ(rapl_energy::get_domains().at(1).label, "package-0/dram");
+    EXPECT_EQ(rapl_energy::get_domains().at(2).label, "package-1");
+
+    rapl_energy _energy;
+    _energy.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    _write("intel-rapl:0", "energy_uj", "4000");
+    _write("intel-rapl:0:0", "energy_uj", "3000");
+    _write("intel-rapl:1", "energy_uj", "505000");
+    _energy.stop();
+
+    std::cout << "\n[" << details::get_test_name() << "]> " << _energy << std::endl;
+
+    auto _joules = _energy.get();
+    auto _watts  = _energy.get_watts();
+    ASSERT_EQ(_joules.size(), 3u);
+    EXPECT_NEAR(_joules.at(0), 0.005, 1.0e-9);
+    EXPECT_NEAR(_joules.at(1), 0.002, 1.0e-9);
+    EXPECT_NEAR(_joules.at(2), 0.5, 1.0e-9);
+    EXPECT_GT(_watts.at(2), 0.0);
+    EXPECT_LT(_watts.at(2), 10.0);
+
+    // zones are ordered by package and subzone number, not lexicographically
+    ASSERT_EQ(system(("mkdir -p " + _root + "/intel-rapl:0:10 " + _root +
+                      "/intel-rapl:2 " + _root + "/intel-rapl:10")
+                         .c_str()),
+              0);
+    _write("intel-rapl:0:10", "name", "uncore");
+    _write("intel-rapl:2", "name", "package-2");
+    _write("intel-rapl:10", "name", "package-10");
+    for(auto itr : { "intel-rapl:0:10", "intel-rapl:2", "intel-rapl:10" })
+        _write(itr, "energy_uj", "0");
+    rapl_energy::reset();
+
+    std::vector<std::string> _labels;
+    for(const auto& itr : rapl_energy::get_domains())
+        _labels.push_back(itr.label);
+    EXPECT_EQ(_labels, std::vector<std::string>({ "package-0", "package-0/dram",
+                                                  "package-0/uncore", "package-1",
+                                                  "package-2", "package-10" }));
+
+    // no zones: the component is unavailable and measures nothing
+    tim::settings::rapl_root() = _root + "/missing";
+    rapl_energy::reset();
+    EXPECT_FALSE(rapl_energy::is_available());
+
+    rapl_energy _missing;
+    _missing.start();
+    _missing.stop();
+    EXPECT_TRUE(_missing.get().empty());
+
+    tim::settings::rapl_root() = _rapl_root;
+    rapl_energy::reset();
+}
+#endif
+
+//--------------------------------------------------------------------------------------//
+
+#if defined(_LINUX)
+TEST_F(rusage_tests, numa_memory)
+{
+    numa_memory _numa;
+    _numa.start();
+    std::vector<int64_t> _data(nelements, 15);
+    _numa.stop();
+
+    std::cout << "\n[" << details::get_test_name() << "]> " << _numa << std::endl;
+
+    auto _nodes = numa_memory::get_num_nodes();
+    EXPECT_GE(_nodes, 1u);
+    EXPECT_LT(_numa.get_run_node(), std::max<size_t>(_nodes, 1));
+
+    if(_nodes == 1)
+    {
+        // single node: numa_maps is not read
+        EXPECT_TRUE(_numa.get().empty());
+        EXPECT_EQ(_numa.get_memory_node(), 0u);
+        EXPECT_EQ(_numa.get_mismatches(), 0);
+    }
+    else
+    {
+        // the touched pages are resident on some node
+        auto   _bytes = _numa.get();
+        double _total = 0.0;
+        for(auto itr : _bytes)
+            _total += itr;
+        size_t _max_nodes = numa_memory::max_nodes;
+        EXPECT_EQ(_bytes.size(), std::min<size_t>(_nodes, _max_nodes));
+        EXPECT_GT(_total, 0.0);
+        EXPECT_LE(_numa.get_mismatches(), 2);
+        // the memory node is the node with the largest change
+        auto _memory_node = std::max_element(_bytes.begin(), _bytes.end());
+        EXPECT_EQ(_numa.get_memory_node(),
+                  static_cast<size_t>(_memory_node - _bytes.begin()));
+    }
+    EXPECT_EQ(_data.back(), 15);
+}
+#endif
+
+//--------------------------------------------------------------------------------------//
+
 int
 main(int argc, char** argv)
 {
@@ -262,6 +262,37 @@ TEST_F(timing_tests, process_cpu_utilization)
 
 //--------------------------------------------------------------------------------------//
 
+TEST_F(timing_tests, compact_graph_node)
+{
+    using node_t = typename wall_clock::storage_type::graph_node;
+    using full_t = std::tuple<uint64_t, wall_clock, int64_t>;
+
+    // the node only holds the accumulated record, not the entire component
+    EXPECT_LT(sizeof(node_t), sizeof(full_t));
+
+    wall_clock obj;
+    for(int i = 0; i < 2; ++i)
+    {
+        obj.start();
+        details::do_sleep(10);
+        obj.stop();
+    }
+
+    node_t node(0, obj, 1);
+    EXPECT_EQ(node.get_accum(), obj.get_accum());
+    EXPECT_EQ(node.get_laps(), obj.nlaps());
+
+    // accumulating updates the record in place and the unpacked component agrees
+    node.accumulate(obj);
+    node += node;
+    EXPECT_EQ(node.get_accum(), 4 * obj.get_accum());
+    EXPECT_EQ(node.get_laps(), 4 * obj.nlaps());
+    EXPECT_EQ(node.obj().get_accum(), node.get_accum());
+    EXPECT_EQ(node.obj().nlaps(), node.get_laps());
+}
+
+//--------------------------------------------------------------------------------------//
+
 int
 main(int argc, char** argv)
 {
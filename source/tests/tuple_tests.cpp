@@ -24,13 +24,17 @@
 
 #include "gtest/gtest.h"
 
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cmath>
+#include <csignal>
+#include <cstdio>
 #include <fstream>
 #include <future>
 #include <iostream>
 #include <iterator>
+#include <mutex>
 #include <random>
 #include <thread>
 #include <unordered_map>
@@ -38,6 +42,12 @@
 
 #include <timemory/timemory.hpp>
 #include <timemory/utility/signals.hpp>
+#include <timemory/utility/trace.hpp>
+
+#if defined(_UNIX)
+#    include <sys/wait.h>
+#    include <unistd.h>
+#endif
 
 using namespace tim::stl_overload;
 using namespace tim::component;
@@ -141,6 +151,54 @@ time_fibonacci(int32_t n, int32_t cutoff)
     TIMEMORY_MARKER(auto_tuple_t, "");
     return fibonacci(n, cutoff);
 }
+//--------------------------------------------------------------------------------------//
+// fork nproc children, child i (in [1, nproc]) runs _func(i, fd) and exits successfully
+// if it returns true. Returns what each child wrote to fd, after all of them exited
+#if defined(_UNIX)
+template <typename _Func>
+std::vector<std::string>
+fork_children(int64_t nproc, _Func&& _func)
+{
+    std::vector<std::string> _output;
+    for(int64_t i = 1; i <= nproc; ++i)
+    {
+        int _fds[2];
+        if(pipe(_fds) != 0)
+        {
+            ADD_FAILURE() << "pipe() failed for child " << i;
+            break;
+        }
+        auto _pid = fork();
+        if(_pid < 0)
+        {
+            ADD_FAILURE() << "fork() failed for child " << i;
+            close(_fds[0]);
+            close(_fds[1]);
+            break;
+        }
+        if(_pid == 0)
+        {
+            close(_fds[0]);
+            bool _ret = _func(i, _fds[1]);
+            close(_fds[1]);
+            _exit((_ret) ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        close(_fds[1]);
+        std::string _data;
+        char        _buffer[4096];
+        ssize_t     _n = 0;
+        while((_n = read(_fds[0], _buffer, sizeof(_buffer))) > 0)
+            _data.append(_buffer, _n);
+        close(_fds[0]);
+        _output.push_back(_data);
+    }
+
+    int _status = 0;
+    while(wait(&_status) > 0)
+        EXPECT_EQ(WEXITSTATUS(_status), EXIT_SUCCESS);
+    return _output;
+}
+#endif
 
 }  // namespace details
 
@@ -386,10 +444,11 @@ TEST_F(tuple_tests, collapsed_threads)
     auto final_storage_size = tim::manager::get_storage<auto_tuple_t>::size(manager);
     auto expected           = (final_storage_size - starting_storage_size);
 
-    EXPECT_EQ(expected, 19 * data_size);
-
+    // the worker graphs are folded into the master graph when they are merged
     const size_t store_size = 15;
 
+    EXPECT_EQ(expected, store_size * data_size);
+
     if(tim::trait::is_available<wall_clock>::value)
         EXPECT_EQ(tim::storage<wall_clock>::instance()->get().size(), store_size);
 
@@ -414,6 +473,481 @@ TEST_F(tuple_tests, collapsed_threads)
 
 //--------------------------------------------------------------------------------------//
 
+TEST_F(tuple_tests, thread_churn)
+{
+    using tuple_t = tim::component_tuple<wall_clock>;
+
+    auto _label = details::get_test_name();
+    auto _run   = [&]() {
+        tuple_t obj(_label, true);
+        obj.start();
+        obj.stop();
+    };
+
+    // the graphs of the exited threads are folded into the same node of the master
+    auto                _storage = tim::storage<wall_clock>::instance();
+    std::vector<size_t> _sizes;
+    for(int i = 0; i < 4; ++i)
+    {
+        std::vector<std::thread> threads;
+        for(int j = 0; j < 8; ++j)
+            threads.push_back(std::thread(_run));
+        for(auto& itr : threads)
+            itr.join();
+        _sizes.push_back(_storage->size());
+    }
+    for(const auto& itr : _sizes)
+        EXPECT_EQ(itr, _sizes.front());
+
+    // a long-lived thread hands over its data before it exits
+    std::promise<void> _merged;
+    std::promise<void> _exit;
+    std::thread        _worker([&]() {
+        _run();
+        tim::thread_exit();
+        _merged.set_value();
+        _exit.get_future().wait();
+    });
+    _merged.get_future().wait();
+
+    int64_t _laps = 0;
+    for(const auto& itr : _storage->get())
+    {
+        if(std::get<2>(itr).find(_label) != std::string::npos)
+            _laps += std::get<1>(itr).nlaps();
+    }
+    EXPECT_EQ(_laps, 33);
+
+    _exit.set_value();
+    _worker.join();
+    EXPECT_EQ(_storage->size(), _sizes.front());
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(tuple_tests, thread_output)
+{
+    using tuple_t = tim::component_tuple<wall_clock>;
+
+    auto _thread_output            = tim::settings::thread_output();
+    tim::settings::thread_output() = true;
+
+    // each worker sleeps for a different amount of time so the threads are imbalanced
+    std::mutex           _mutex;
+    std::vector<int64_t> _indexes;
+    auto                 _label = details::get_test_name();
+    auto                 _run   = [&](int64_t n) {
+        tuple_t obj(_label, true);
+        obj.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10 * n));
+        obj.stop();
+        std::lock_guard<std::mutex> _lk(_mutex);
+        _indexes.push_back(tim::manager::instance()->instance_count());
+    };
+
+    // the master instance belongs to the thread which creates it first
+    auto _storage = tim::storage<wall_clock>::instance();
+
+    std::vector<std::thread> threads;
+    for(int64_t i = 1; i <= 4; ++i)
+        threads.push_back(std::thread(_run, i));
+    for(auto& itr : threads)
+        itr.join();
+
+    // the worker graphs were handed over without being merged
+    auto _results = _storage->get_thread_results();
+    EXPECT_GE(_results.size(), static_cast<size_t>(4));
+
+    // and are tagged with the index of the manager of each worker thread
+    for(auto itr : _indexes)
+    {
+        bool _tagged = false;
+        for(const auto& ritr : _results)
+            _tagged = _tagged || (ritr.first == itr);
+        EXPECT_TRUE(_tagged) << "thread index " << itr;
+    }
+
+    auto _summary = tim::storage<wall_clock>::get_thread_summary(_results);
+    bool _found   = false;
+    for(const auto& itr : _summary)
+    {
+        if(itr.prefix.find(_label) == std::string::npos)
+            continue;
+        _found = true;
+        EXPECT_EQ(itr.nthreads, 4);
+        EXPECT_LT(itr.min, itr.max);
+        EXPECT_GT(itr.stddev(), 0.0);
+    }
+    EXPECT_TRUE(_found);
+
+    // what was collected is still reported per-thread after turning the setting off
+    tim::settings::thread_output() = false;
+    EXPECT_TRUE(_storage->has_thread_results());
+
+    tim::settings::thread_output() = _thread_output;
+}
+
+//--------------------------------------------------------------------------------------//
+
+#if defined(_UNIX)
+TEST_F(tuple_tests, shared_profile)
+{
+    using tuple_t = tim::component_tuple<wall_clock>;
+
+    // enabled in main(): the graphs only register when it is enabled at creation
+    ASSERT_TRUE(tim::settings::shared_profile());
+    ASSERT_TRUE(tim::shared_profile::create());
+
+    // each child publishes its call-graph into its own slot and exits immediately
+    auto          _label = details::get_test_name();
+    const int64_t nproc  = 3;
+    details::fork_children(nproc, [&](int64_t i, int) {
+        tuple_t obj(_label, true);
+        obj.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10 * i));
+        obj.stop();
+        tim::shared_profile::publish();
+        return true;
+    });
+
+    uint32_t _nprocs  = 0;
+    auto     _results = tim::shared_profile::reduce(&_nprocs);
+    EXPECT_EQ(_nprocs, static_cast<uint32_t>(nproc));
+
+    bool _found = false;
+    for(const auto& itr : _results)
+    {
+        if(itr.label.find(_label) == std::string::npos)
+            continue;
+        _found = true;
+        EXPECT_EQ(itr.type, wall_clock::label());
+        EXPECT_EQ(itr.nprocs, nproc);
+        EXPECT_EQ(itr.laps, nproc);
+        EXPECT_LT(itr.min, itr.max);
+    }
+    EXPECT_TRUE(_found);
+
+    tim::shared_profile::release();
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(tuple_tests, packed_profile)
+{
+    using tuple_t   = tim::component_tuple<wall_clock>;
+    using storage_t = tim::manager::get_storage<tuple_t>;
+
+    auto _storage = tim::storage<wall_clock>::instance();
+    auto _label   = details::get_test_name();
+    auto _inner   = _label + "/inner";
+
+    // each child sends its (nested) call-graph to the parent over a pipe
+    const int64_t nproc   = 3;
+    auto          _packed = details::fork_children(nproc, [&](int64_t i, int _fd) {
+        // drop the data inherited from the parent
+        storage_t::clear();
+        {
+            tuple_t obj(_label, true);
+            obj.start();
+            for(int64_t j = 0; j < i; ++j)
+            {
+                tuple_t inner(_inner, true);
+                inner.start();
+                inner.stop();
+            }
+            obj.stop();
+        }
+        auto _data = storage_t::pack();
+        return write(_fd, _data.data(), _data.size()) ==
+               static_cast<ssize_t>(_data.size());
+    });
+    ASSERT_EQ(_packed.size(), static_cast<size_t>(nproc));
+
+    auto _size = _storage->size();
+    for(const auto& itr : _packed)
+    {
+        EXPECT_FALSE(itr.empty());
+        storage_t::unpack(itr);
+    }
+    // the call-graphs of the children are combined into the same nodes
+    EXPECT_EQ(_storage->size(), _size + 2);
+
+    int64_t _outer_laps = 0;
+    int64_t _inner_laps = 0;
+    for(const auto& itr : _storage->get())
+    {
+        auto _prefix = std::get<2>(itr);
+        if(_prefix.find(_inner) != std::string::npos)
+        {
+            _inner_laps += std::get<1>(itr).nlaps();
+            EXPECT_EQ(std::get<3>(itr), 1);
+        }
+        else if(_prefix.find(_label) != std::string::npos)
+        {
+            _outer_laps += std::get<1>(itr).nlaps();
+            EXPECT_GT(std::get<1>(itr).get(), 0.0);
+        }
+    }
+    EXPECT_EQ(_outer_laps, nproc);
+    EXPECT_EQ(_inner_laps, nproc * (nproc + 1) / 2);
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(tuple_tests, crash_dump)
+{
+    using tuple_t = tim::component_tuple<wall_clock>;
+
+    auto _label = details::get_test_name();
+    auto _inner = _label + "/inner";
+
+    // the parent writes labels of its own first: the child must neither skip them nor
+    // append to the label file of the parent
+    auto _crash_dump            = tim::settings::crash_dump();
+    tim::settings::crash_dump() = true;
+    ASSERT_TRUE(tim::crash_dump::reconfigure());
+    std::string _parent_lbls = tim::crash_dump::label_path();
+    std::thread _parent([&]() {
+        tuple_t obj(_label, true);
+        obj.start();
+        tuple_t inner(_inner, true);
+        inner.start();
+        inner.stop();
+        obj.stop();
+    });
+    _parent.join();
+
+    // the child crashes while "_label" is still running
+    auto _pid = fork();
+    ASSERT_GE(_pid, 0);
+    if(_pid == 0)
+    {
+        if(!tim::crash_dump::reconfigure())
+            _exit(EXIT_FAILURE);
+        tim::enable_signal_detection({ tim::sys_signal::sSegFault });
+        // the graph of a new thread is created after the crash dump was enabled
+        std::thread _worker([&]() {
+            tuple_t obj(_label, true);
+            obj.start();
+            tuple_t inner(_inner, true);
+            inner.start();
+            inner.stop();
+            raise(SIGSEGV);
+        });
+        _worker.join();
+        _exit(EXIT_FAILURE);
+    }
+
+    int _status = 0;
+    ASSERT_EQ(waitpid(_pid, &_status, 0), _pid);
+    EXPECT_TRUE(WIFSIGNALED(_status));
+
+    auto _tag  = std::string("crash_dump_") + std::to_string(_pid);
+    auto _dump = tim::settings::compose_output_filename(_tag, ".bin");
+    auto _lbls = tim::settings::compose_output_filename(_tag + "_labels", ".txt");
+
+    // hash-to-label mapping
+    std::unordered_map<uint64_t, std::string> _labels;
+    std::ifstream                             _lfs(_lbls.c_str());
+    ASSERT_TRUE(_lfs.good());
+    uint64_t    _hash = 0;
+    std::string _line;
+    while(_lfs >> _hash && std::getline(_lfs, _line))
+        _labels[_hash] = _line;
+
+    std::ifstream _ifs(_dump.c_str(), std::ios::binary);
+    ASSERT_TRUE(_ifs.good());
+    tim::crash_dump::header_t _header;
+    _ifs.read(reinterpret_cast<char*>(&_header), sizeof(_header));
+    ASSERT_TRUE(_ifs.good());
+    EXPECT_EQ(std::string(_header.magic, 8), std::string("TIMCRASH"));
+    EXPECT_EQ(_header.signal, SIGSEGV);
+    EXPECT_EQ(_header.pid, static_cast<int64_t>(_pid));
+    EXPECT_GE(_header.nstorage, static_cast<uint64_t>(1));
+
+    // every section is terminated by a record with a depth of -1
+    int64_t _outer_depth = -1;
+    int64_t _inner_depth = -1;
+    int64_t _inner_laps  = 0;
+    for(uint64_t i = 0; i < _header.nstorage; ++i)
+    {
+        tim::crash_dump::section_t _section;
+        _ifs.read(reinterpret_cast<char*>(&_section), sizeof(_section));
+        ASSERT_TRUE(_ifs.good());
+        bool _timer = (std::string(_section.label) == wall_clock::label());
+        while(true)
+        {
+            tim::crash_dump::record_t _record;
+            _ifs.read(reinterpret_cast<char*>(&_record), sizeof(_record));
+            ASSERT_TRUE(_ifs.good());
+            if(_record.depth < 0)
+                break;
+            if(!_timer || _labels.count(_record.hash) == 0)
+                continue;
+            const auto& _prefix = _labels[_record.hash];
+            if(_prefix.find(_inner) != std::string::npos)
+            {
+                _inner_depth = _record.depth;
+                _inner_laps += _record.laps;
+            }
+            else if(_prefix.find(_label) != std::string::npos)
+            {
+                _outer_depth = _record.depth;
+            }
+        }
+    }
+
+    EXPECT_GE(_outer_depth, 0);
+    EXPECT_EQ(_inner_depth, _outer_depth + 1);
+    EXPECT_EQ(_inner_laps, 1);
+
+    remove(_dump.c_str());
+    remove(_lbls.c_str());
+    remove(_parent_lbls.c_str());
+
+    tim::settings::crash_dump() = _crash_dump;
+    tim::crash_dump::reconfigure();
+}
+#endif
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(tuple_tests, trace_ring)
+{
+    using tim::trace::record;
+    using record_array_t = std::vector<record>;
+
+    // drains every completed chunk (and optionally the partial one) into "_out"
+    auto _drain = [](tim::trace::thread_buffer& _buffer, record_array_t& _out,
+                     bool _partial) {
+        record_array_t _scratch;
+        _buffer.drain(
+            _scratch,
+            [&](const record_array_t& _records) {
+                _out.insert(_out.end(), _records.begin(), _records.end());
+            },
+            _partial);
+    };
+
+    // two chunks of four records: the ring is full after eight records
+    const uint64_t nchunk = 4;
+    const uint64_t nmax   = 2;
+    const uint64_t npush  = 12;
+
+    // drop-oldest: the first chunk is evicted, the newest eight records are kept
+    {
+        tim::trace::thread_buffer _buffer(0, nchunk, nmax, true);
+        for(uint64_t i = 0; i < npush; ++i)
+            _buffer.push('B', 1, i);
+
+        record_array_t _records;
+        _drain(_buffer, _records, false);
+        ASSERT_EQ(_records.size(), nchunk);
+        _drain(_buffer, _records, true);
+        ASSERT_EQ(_records.size(), 2 * nchunk);
+        EXPECT_EQ(_buffer.dropped(), nchunk);
+        for(uint64_t i = 0; i < _records.size(); ++i)
+            EXPECT_EQ(_records.at(i).timestamp, nchunk + i);
+    }
+
+    // drop-newest: the first eight records are kept, the rest are dropped
+    {
+        tim::trace::thread_buffer _buffer(0, nchunk, nmax, false);
+        for(uint64_t i = 0; i < npush; ++i)
+            _buffer.push('B', 1, i);
+
+        record_array_t _records;
+        _drain(_buffer, _records, true);
+        ASSERT_EQ(_records.size(), 2 * nchunk);
+        EXPECT_EQ(_buffer.dropped(), npush - 2 * nchunk);
+        for(uint64_t i = 0; i < _records.size(); ++i)
+            EXPECT_EQ(_records.at(i).timestamp, i);
+    }
+
+    // concurrent producer and consumer: every drained chunk must be intact, i.e. a
+    // consecutive sequence of timestamps, and every record is either written or dropped
+    {
+        const uint64_t            ntotal = 200000;
+        tim::trace::thread_buffer _buffer(0, 64, 4, true);
+        std::atomic<bool>         _done{ false };
+        record_array_t            _records;
+        std::vector<size_t>       _chunks;
+
+        std::thread _consumer([&]() {
+            record_array_t _scratch;
+            auto           _write = [&](const record_array_t& _chunk) {
+                _chunks.push_back(_chunk.size());
+                _records.insert(_records.end(), _chunk.begin(), _chunk.end());
+            };
+            while(!_done.load())
+                _buffer.drain(_scratch, _write, false);
+            _buffer.drain(_scratch, _write, true);
+        });
+
+        for(uint64_t i = 0; i < ntotal; ++i)
+            _buffer.push('B', 1, i);
+        _done.store(true);
+        _consumer.join();
+
+        EXPECT_EQ(_records.size() + _buffer.dropped(), ntotal);
+        size_t _offset = 0;
+        for(auto _size : _chunks)
+        {
+            for(size_t i = 1; i < _size; ++i)
+                ASSERT_EQ(_records.at(_offset + i).timestamp,
+                          _records.at(_offset).timestamp + i);
+            _offset += _size;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+
+TEST_F(tuple_tests, trace_export)
+{
+    using tuple_t = tim::component_tuple<wall_clock>;
+
+    auto _trace            = tim::settings::trace();
+    tim::settings::trace() = true;
+
+    auto _label = details::get_test_name();
+    for(int i = 0; i < 3; ++i)
+    {
+        tuple_t obj(_label, true);
+        obj.start();
+        obj.stop();
+    }
+    tim::trace::counter(_label + "_counter", 42.0);
+    tim::trace::finalize();
+    tim::settings::trace() = _trace;
+
+    auto          _fname = tim::settings::compose_output_filename("trace", ".json");
+    std::ifstream ifs(_fname.c_str());
+    ASSERT_TRUE(ifs.good());
+    std::string _json((std::istreambuf_iterator<char>(ifs)),
+                      std::istreambuf_iterator<char>());
+
+    auto _count = [&](const std::string& _str) {
+        int64_t _n   = 0;
+        size_t  _pos = 0;
+        while((_pos = _json.find(_str, _pos)) != std::string::npos)
+        {
+            ++_n;
+            _pos += _str.length();
+        }
+        return _n;
+    };
+
+    EXPECT_EQ(_json.find("{\"traceEvents\":["), static_cast<size_t>(0));
+    EXPECT_NE(_json.find("\"displayTimeUnit\":\"ns\""), std::string::npos);
+    EXPECT_NE(_json.find("\"dropped\":0"), std::string::npos);
+    EXPECT_EQ(_count("\"name\":\"" + _label + "\",\"cat\":\"timemory\",\"ph\":\"B\""), 3);
+    EXPECT_EQ(_count("\"name\":\"" + _label + "\",\"cat\":\"timemory\",\"ph\":\"E\""), 3);
+    EXPECT_EQ(_count("\"args\":{\"value\":42"), 1);
+}
+
+//--------------------------------------------------------------------------------------//
+
 TEST_F(tuple_tests, measure)
 {
     tim::component_tuple<page_rss, peak_rss> prss(TIMEMORY_LABEL(""));
@@ -442,6 +976,69 @@ TEST_F(tuple_tests, measure)
 
 //--------------------------------------------------------------------------------------//
 
+TEST_F(tuple_tests, overhead_calibration)
+{
+    using calib_tuple_t = tim::component_tuple<wall_clock, peak_rss>;
+    using other_tuple_t = tim::component_tuple<wall_clock, cpu_clock>;
+    using calib_t       = tim::operation::calibrate<wall_clock>;
+
+    auto _storage = tim::storage<wall_clock>::instance();
+    auto _nnodes  = _storage->size();
+
+    EXPECT_TRUE(calib_tuple_t::calibrate(1000));
+    EXPECT_TRUE(other_tuple_t::calibrate(1000));
+
+    // the scratch nodes of the calibration are removed from the call-graph
+    EXPECT_EQ(_storage->size(), _nnodes);
+
+    // each bundle has its own estimate: timers are calibrated, peak values are not
+    EXPECT_NE(calib_tuple_t::bundle_id(), other_tuple_t::bundle_id());
+    EXPECT_TRUE(calib_t::is_calibrated(calib_tuple_t::bundle_id()));
+    EXPECT_TRUE(calib_t::is_calibrated(other_tuple_t::bundle_id()));
+    EXPECT_FALSE(tim::operation::calibrate<peak_rss>::is_calibrated());
+    EXPECT_GT(calib_t::estimate(calib_tuple_t::bundle_id()), 0.0);
+    EXPECT_GT(calib_t::estimate(other_tuple_t::bundle_id()), 0.0);
+
+    // a stored node is attributed the estimate of the bundle which inserted it
+    auto _overhead_correction            = tim::settings::overhead_correction();
+    tim::settings::overhead_correction() = true;
+    auto _label                          = details::get_test_name();
+    {
+        other_tuple_t obj(_label, true);
+        obj.start();
+        obj.stop();
+    }
+    tim::settings::overhead_correction() = _overhead_correction;
+
+    bool _found = false;
+    for(const auto& itr : _storage->get())
+    {
+        if(std::get<2>(itr).find(_label) == std::string::npos)
+            continue;
+        _found = true;
+        EXPECT_DOUBLE_EQ(calib_t::node_estimate(std::get<0>(itr)),
+                         calib_t::estimate(other_tuple_t::bundle_id()));
+    }
+    EXPECT_TRUE(_found);
+
+    // correction is bounded by the measured value
+    wall_clock obj;
+    obj.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    obj.stop();
+    auto corrected = obj;
+    tim::operation::compensate<wall_clock>(
+        corrected, 100 * calib_t::estimate(calib_tuple_t::bundle_id()));
+    EXPECT_LT(corrected.get_accum(), obj.get_accum());
+    EXPECT_GE(corrected.get_accum(), 0);
+
+    auto zeroed = obj;
+    tim::operation::compensate<wall_clock>(zeroed, 2.0 * obj.get_accum());
+    EXPECT_EQ(zeroed.get_accum(), 0);
+}
+
+//--------------------------------------------------------------------------------------//
+
 int
 main(int argc, char** argv)
 {
@@ -450,6 +1047,9 @@ main(int argc, char** argv)
     tim::settings::verbose()     = 0;
     tim::settings::debug()       = false;
     tim::settings::json_output() = true;
+#if defined(_UNIX)
+    tim::settings::shared_profile() = true;
+#endif
     tim::timemory_init(argc, argv);  // parses environment, sets output paths
     tim::settings::dart_output() = true;
     tim::settings::dart_count()  = 1;
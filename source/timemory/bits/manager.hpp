@@ -102,6 +102,8 @@ inline manager::manager()
     {
         settings::parse();
         papi::init();
+        // must exist before the application forks its worker processes
+        shared_profile::create();
         std::atexit(manager::exit_hook);
     }
 
@@ -149,6 +151,33 @@ manager::add_finalizer(_Func&& _func, bool _is_master)
 
 //======================================================================================//
 
+template <typename _Func>
+inline void
+manager::add_merger(_Func&& _func)
+{
+    auto_lock_t lk(m_mutex, std::defer_lock);
+    if(!lk.owns_lock())
+        lk.lock();
+
+    m_worker_mergers.push_back(std::forward<_Func>(_func));
+}
+
+//======================================================================================//
+
+inline void
+manager::merge()
+{
+    auto_lock_t lk(m_mutex, std::defer_lock);
+    if(!lk.owns_lock())
+        lk.lock();
+
+    // the storage instances stay alive so the mergers are kept for the next call
+    for(auto& itr : m_worker_mergers)
+        itr();
+}
+
+//======================================================================================//
+
 inline void
 manager::finalize()
 {
@@ -156,6 +185,9 @@ manager::finalize()
     if(!lk.owns_lock())
         lk.lock();
 
+    // the finalizers release the storage instances the mergers refer to
+    m_worker_mergers.clear();
+
     auto _finalize = [](finalizer_list_t& _finalizers) {
         // reverse to delete the most recent additions first
         std::reverse(_finalizers.begin(), _finalizers.end());
@@ -182,11 +214,14 @@ manager::exit_hook()
 {
     try
     {
+        // publish (child) or reduce (parent) before the storage is released
+        shared_profile::finalize();
         if(f_manager_instance_count() > 0)
         {
             auto master_manager = get_shared_ptr_pair_master_instance<manager>();
             master_manager.reset();
         }
+        trace::finalize();
         papi::shutdown();
         mpi::finalize();
     } catch(...)
@@ -91,6 +91,15 @@ TIMEMORY_ENV_STATIC_ACCESSOR(bool, debug, "TIMEMORY_DEBUG", false)
 TIMEMORY_ENV_STATIC_ACCESSOR(bool, banner, "TIMEMORY_BANNER", true)
 TIMEMORY_ENV_STATIC_ACCESSOR(bool, flat_profile, "TIMEMORY_FLAT_PROFILE", false)
 TIMEMORY_ENV_STATIC_ACCESSOR(bool, collapse_threads, "TIMEMORY_COLLAPSE_THREADS", true)
+/// write each thread's call-graph separately (with cross-thread summary statistics)
+/// instead of merging the worker threads into the master
+TIMEMORY_ENV_STATIC_ACCESSOR(bool, thread_output, "TIMEMORY_THREAD_OUTPUT", false)
+/// max number of storage instances (per component) released by exited threads which
+/// are kept for reuse by new threads instead of being deleted. This does not cap the
+/// live instances: every thread which is recording holds one until it exits or calls
+/// tim::thread_exit()
+TIMEMORY_ENV_STATIC_ACCESSOR(uint64_t, storage_pool_size, "TIMEMORY_STORAGE_POOL_SIZE",
+                             64)
 TIMEMORY_ENV_STATIC_ACCESSOR(uint16_t, max_depth, "TIMEMORY_MAX_DEPTH",
                              std::numeric_limits<uint16_t>::max())
 
@@ -277,6 +286,43 @@ TIMEMORY_ENV_STATIC_ACCESSOR(bool, enable_all_signals, "TIMEMORY_ENABLE_ALL_SIGN
 TIMEMORY_ENV_STATIC_ACCESSOR(bool, disable_all_signals, "TIMEMORY_DISABLE_ALL_SIGNALS",
                              false)
 
+/// write an async-signal-safe binary dump of the in-flight call-graphs when a
+/// termination signal is caught (see timemory/utility/crash_dump.hpp)
+TIMEMORY_ENV_STATIC_ACCESSOR(bool, crash_dump, "TIMEMORY_CRASH_DUMP", false)
+
+//--------------------------------------------------------------------------------------//
+//     Event-trace (timeline) mode
+//--------------------------------------------------------------------------------------//
+
+/// record begin/end events and write a Chrome trace-event JSON file
+TIMEMORY_ENV_STATIC_ACCESSOR(bool, trace, "TIMEMORY_TRACE", false)
+
+/// number of records per trace buffer chunk
+TIMEMORY_ENV_STATIC_ACCESSOR(uint64_t, trace_chunk_size, "TIMEMORY_TRACE_CHUNK_SIZE",
+                             4096)
+
+/// max number of chunks per thread before records are dropped
+TIMEMORY_ENV_STATIC_ACCESSOR(uint64_t, trace_max_chunks, "TIMEMORY_TRACE_MAX_CHUNKS", 16)
+
+/// when the buffers are full, drop the oldest chunk instead of the newest records
+TIMEMORY_ENV_STATIC_ACCESSOR(bool, trace_drop_oldest, "TIMEMORY_TRACE_DROP_OLDEST", true)
+
+//--------------------------------------------------------------------------------------//
+//     Shared-memory aggregation across forked processes
+//--------------------------------------------------------------------------------------//
+
+/// create a shared-memory segment at initialization which forked child processes
+/// publish their call-graphs into (see timemory/utility/shared_profile.hpp)
+TIMEMORY_ENV_STATIC_ACCESSOR(bool, shared_profile, "TIMEMORY_SHARED_PROFILE", false)
+
+/// max number of processes which can publish into the shared-memory segment
+TIMEMORY_ENV_STATIC_ACCESSOR(uint64_t, shared_profile_slots,
+                             "TIMEMORY_SHARED_PROFILE_SLOTS", 256)
+
+/// bytes reserved per process in the shared-memory segment
+TIMEMORY_ENV_STATIC_ACCESSOR(uint64_t, shared_profile_slot_size,
+                             "TIMEMORY_SHARED_PROFILE_SLOT_SIZE", 1024 * 1024)
+
 //--------------------------------------------------------------------------------------//
 //     Number of nodes
 //--------------------------------------------------------------------------------------//
@@ -290,6 +336,31 @@ TIMEMORY_ENV_STATIC_ACCESSOR(int32_t, node_count, "TIMEMORY_NODE_COUNT", 0)
 /// default setting for auto_{list,tuple,hybrid} "report_at_exit" member variable
 TIMEMORY_ENV_STATIC_ACCESSOR(bool, destructor_report, "TIMEMORY_DESTRUCTOR_REPORT", false)
 
+//--------------------------------------------------------------------------------------//
+//     Overhead compensation
+//--------------------------------------------------------------------------------------//
+
+/// calibrate the per-marker overhead of each bundle and report overhead-corrected
+/// inclusive values
+TIMEMORY_ENV_STATIC_ACCESSOR(bool, overhead_correction, "TIMEMORY_OVERHEAD_CORRECTION",
+                             false)
+
+//--------------------------------------------------------------------------------------//
+//     Pressure-stall, cgroup and powercap files
+//--------------------------------------------------------------------------------------//
+
+/// directory containing the cpu, memory and io pressure-stall files
+TIMEMORY_ENV_STATIC_ACCESSOR(string_t, pressure_root, "TIMEMORY_PRESSURE_ROOT",
+                             "/proc/pressure")
+
+/// cgroup v2 directory containing cpu.stat and memory.events (empty == the cgroup of
+/// the process under /sys/fs/cgroup)
+TIMEMORY_ENV_STATIC_ACCESSOR(string_t, cgroup_root, "TIMEMORY_CGROUP_ROOT", "")
+
+/// directory containing the intel-rapl:* powercap zones
+TIMEMORY_ENV_STATIC_ACCESSOR(string_t, rapl_root, "TIMEMORY_RAPL_ROOT",
+                             "/sys/class/powercap")
+
 //--------------------------------------------------------------------------------------//
 //     For plotting
 //--------------------------------------------------------------------------------------//
@@ -62,6 +62,7 @@ private:
     friend struct operation::live_count<_Tp>;
     friend struct operation::set_prefix<_Tp>;
     friend struct operation::pop_node<_Tp>;
+    friend struct operation::erase_node<_Tp>;
     friend struct operation::record<_Tp>;
     friend struct operation::reset<_Tp>;
     friend struct operation::measure<_Tp>;
@@ -71,6 +72,8 @@ private:
     friend struct operation::plus<_Tp>;
     friend struct operation::multiply<_Tp>;
     friend struct operation::divide<_Tp>;
+    friend struct operation::scale<_Tp>;
+    friend struct operation::calibrate<_Tp>;
     friend struct operation::base_printer<_Tp>;
     friend struct operation::print<_Tp>;
     friend struct operation::print_storage<_Tp>;
@@ -432,14 +435,11 @@ private:
             auto _storage   = get_storage();
             auto _beg_depth = _storage->depth();
 
-            Type& obj = graph_itr->obj();
             Type& rhs = static_cast<Type&>(*this);
-            obj += rhs;
-            obj.plus(rhs);
+            graph_itr->accumulate(rhs);
             Type::append(graph_itr, rhs);
             _storage->pop();
-            obj.is_running = false;
-            is_on_stack    = false;
+            is_on_stack = false;
 
             auto _end_depth = _storage->depth();
             depth_change    = (_beg_depth > _end_depth);
@@ -451,6 +451,24 @@ private:
     void pop_node()
     {}
 
+    //----------------------------------------------------------------------------------//
+    // remove the node (and its subtree) from the graph
+    //
+    template <typename _Up = this_type, enable_if_t<(_Up::implements_storage_v), int> = 0>
+    void erase_node()
+    {
+        if(!is_on_stack && graph_itr)
+        {
+            get_storage()->erase(graph_itr);
+            graph_itr = graph_iterator{ nullptr };
+        }
+    }
+
+    template <typename _Up                                   = this_type,
+              enable_if_t<!(_Up::implements_storage_v), int> = 0>
+    void erase_node()
+    {}
+
     //----------------------------------------------------------------------------------//
     // initialize the storage
     //
@@ -663,6 +681,7 @@ private:
     friend struct operation::live_count<_Tp>;
     friend struct operation::set_prefix<_Tp>;
     friend struct operation::pop_node<_Tp>;
+    friend struct operation::erase_node<_Tp>;
     friend struct operation::record<_Tp>;
     friend struct operation::reset<_Tp>;
     friend struct operation::measure<_Tp>;
@@ -862,6 +881,11 @@ private:
     //
     void pop_node() { is_on_stack = false; }
 
+    //----------------------------------------------------------------------------------//
+    // remove the node from the graph
+    //
+    void erase_node() {}
+
 protected:
     void plus(const this_type& rhs)
     {
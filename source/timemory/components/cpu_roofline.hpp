@@ -29,6 +29,7 @@
 #include "timemory/components/base.hpp"
 #include "timemory/components/timing.hpp"
 #include "timemory/components/types.hpp"
+#include "timemory/ert/ceilings.hpp"
 #include "timemory/ert/configuration.hpp"
 #include "timemory/ert/data.hpp"
 #include "timemory/ert/kernels.hpp"
@@ -36,9 +37,15 @@
 #include "timemory/units.hpp"
 #include "timemory/utility/macros.hpp"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <limits>
 #include <memory>
 #include <numeric>
+#include <sstream>
 #include <utility>
 
 //======================================================================================//
@@ -148,6 +155,31 @@ struct cpu_roofline
     using intvec_t          = std::vector<int>;
     using events_callback_t = std::function<intvec_t(const MODE&)>;
 
+    //----------------------------------------------------------------------------------//
+    /// an entry of the roofline analysis generated at finalization. In OP mode,
+    /// attained and roof are GFLOP/s (the intensity is only known when PAPI_LST_INS
+    /// was counted along with the FLOPs). In AI mode, attained and roof are GB/s
+    struct analysis_entry
+    {
+        std::string label     = "";
+        int64_t     depth     = 0;
+        int64_t     laps      = 0;
+        double      runtime   = 0.0;  // seconds
+        double      intensity = 0.0;  // FLOPs / byte
+        double      attained  = 0.0;
+        double      roof      = 0.0;
+
+        double fraction() const { return (roof > 0.0) ? (attained / roof) : 0.0; }
+
+        /// the time which would be saved if the entry ran at the roof
+        double recoverable() const
+        {
+            return (roof > 0.0) ? (runtime * std::max(0.0, 1.0 - fraction())) : 0.0;
+        }
+    };
+
+    using analysis_type = std::vector<analysis_entry>;
+
     //----------------------------------------------------------------------------------//
     /// replace this callback to add in custom HW counters
     static events_callback_t& get_events_callback()
@@ -218,6 +250,22 @@ struct cpu_roofline
 
     //----------------------------------------------------------------------------------//
 
+    static ert::ceilings& get_ceilings()
+    {
+        static ert::ceilings _instance;
+        return _instance;
+    }
+
+    //----------------------------------------------------------------------------------//
+    /// entries of the storage ranked by their distance to the roof
+    static analysis_type& get_analysis()
+    {
+        static analysis_type _instance;
+        return _instance;
+    }
+
+    //----------------------------------------------------------------------------------//
+
     static void invoke_thread_init(storage_type*)
     {
         papi::init();
@@ -286,6 +334,10 @@ struct cpu_roofline
             if(_events_ptr()->size() > 0)
                 papi::start(event_set());
         }
+
+        auto _lst = std::find(events().begin(), events().end(), PAPI_LST_INS);
+        if(_lst != events().end())
+            _lst_index() = static_cast<int>(std::distance(events().begin(), _lst));
     }
 
     //----------------------------------------------------------------------------------//
@@ -329,9 +381,133 @@ struct cpu_roofline
             apply<void>::access<ert_executor_t>(ert_config, ert_data);
             if(ert_data && (settings::verbose() > 0 || settings::debug()))
                 std::cout << *(ert_data) << std::endl;
+            if(ert_data)
+            {
+                get_ceilings() = ert::get_ceilings(*ert_data);
+                get_analysis() = analyze(_store, get_ceilings());
+                report_analysis(get_ceilings(), get_analysis());
+            }
         }
     }
 
+    //----------------------------------------------------------------------------------//
+    /// compute the attained performance of each entry in the storage and rank the
+    /// entries by the time which would be recovered if they ran at the roof
+    static analysis_type analyze(storage_type* _store, const ert::ceilings& _ceilings)
+    {
+        return analyze(_store, _ceilings,
+                       std::integral_constant<bool, implements_storage_v>{});
+    }
+
+    //----------------------------------------------------------------------------------//
+    /// analyze() for any type whose get() returns entries laid out as the entries of
+    /// the storage: (hash, object, prefix, depth, ..., hierarchy)
+    template <typename _Storage>
+    static analysis_type analyze(_Storage* _store, const ert::ceilings& _ceilings)
+    {
+        return analyze(_store, _ceilings, std::true_type{});
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static void write_analysis(std::ostream& os, const ert::ceilings& _ceilings,
+                               const analysis_type& _analysis)
+    {
+        auto _unit = (event_mode() == MODE::OP) ? "GFLOP/s" : "GB/s";
+
+        std::stringstream ss;
+        ss << "[" << label() << "]> roofline ceilings: " << _ceilings.flops.label
+           << " = " << std::fixed << std::setprecision(precision)
+           << _ceilings.flops.value;
+        for(const auto& itr : _ceilings.bandwidth)
+            ss << ", " << itr.label << " = " << itr.value;
+        ss << "\n[" << label() << "]> attained and roof are " << _unit
+           << ", runtime and recoverable are seconds, AI is FLOPs / byte\n";
+
+        size_t _width = 8;
+        for(const auto& itr : _analysis)
+            _width = std::max<size_t>(_width, indented(itr).length());
+
+        ss << std::left << std::setw(_width) << "label" << std::right;
+        for(const auto& itr :
+            { "laps", "runtime", "AI", "attained", "roof", "% of roof", "recoverable" })
+            ss << std::setw(12) << itr;
+        ss << "\n";
+
+        for(const auto& itr : _analysis)
+        {
+            ss << std::left << std::setw(_width) << indented(itr) << std::right
+               << std::setw(12) << itr.laps << std::setw(12) << itr.runtime
+               << std::setw(12) << itr.intensity << std::setw(12) << itr.attained
+               << std::setw(12) << itr.roof << std::setw(12) << 100.0 * itr.fraction()
+               << std::setw(12) << itr.recoverable() << "\n";
+        }
+        os << ss.str() << std::flush;
+    }
+
+    //----------------------------------------------------------------------------------//
+    /// compact output: one JSON object per line, in the order of the ranking
+    static void write_analysis_json(std::ostream& os, const ert::ceilings& _ceilings,
+                                    const analysis_type& _analysis)
+    {
+        std::stringstream ss;
+        ss.precision(std::numeric_limits<double>::digits10);
+        ss << "{\"timemory\":{\"" << label() << "\":{\"mode\":\"" << get_mode_string()
+           << "\",\"ceilings\":{\"" << escape(_ceilings.flops.label)
+           << "\":" << _ceilings.flops.value;
+        for(const auto& itr : _ceilings.bandwidth)
+            ss << ",\"" << escape(itr.label) << "\":" << itr.value;
+        ss << "},\n\"analysis\":[";
+        for(size_t i = 0; i < _analysis.size(); ++i)
+        {
+            const auto& itr = _analysis.at(i);
+            ss << ((i == 0) ? "\n" : ",\n") << "{\"label\":\"" << escape(itr.label)
+               << "\",\"depth\":" << itr.depth << ",\"laps\":" << itr.laps
+               << ",\"runtime\":" << itr.runtime << ",\"intensity\":" << itr.intensity
+               << ",\"attained\":" << itr.attained << ",\"roof\":" << itr.roof
+               << ",\"recoverable\":" << itr.recoverable() << "}";
+        }
+        ss << "]}}}\n";
+        os << ss.str() << std::flush;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static void report_analysis(const ert::ceilings& _ceilings,
+                                const analysis_type& _analysis)
+    {
+        if(_ceilings.empty() || _analysis.empty())
+            return;
+
+        if(settings::cout_output())
+            write_analysis(std::cout, _ceilings, _analysis);
+
+        if(!settings::file_output())
+            return;
+
+        auto _write = [&](const std::string& _ext, bool _json) {
+            auto          fname = settings::compose_output_filename(label() + "_analysis",
+                                                           _ext);
+            std::ofstream ofs(fname.c_str());
+            if(ofs)
+            {
+                printf("[%s]> Outputting '%s'...\n", label().c_str(), fname.c_str());
+                if(_json)
+                    write_analysis_json(ofs, _ceilings, _analysis);
+                else
+                    write_analysis(ofs, _ceilings, _analysis);
+            }
+            else
+                fprintf(stderr, "[%s]> opening output file '%s' failed\n",
+                        label().c_str(), fname.c_str());
+        };
+
+        if(settings::text_output())
+            _write(".txt", false);
+        if(settings::json_output())
+            _write(".json", true);
+    }
+
     //----------------------------------------------------------------------------------//
 
     template <typename _Archive>
@@ -708,6 +884,120 @@ private:
 
     //----------------------------------------------------------------------------------//
 
+    static std::atomic<int>& _lst_index()
+    {
+        static std::atomic<int> _instance(-1);
+        return _instance;
+    }
+
+    //----------------------------------------------------------------------------------//
+    /// bytes per load/store
+    static double get_type_size() { return std::max({ sizeof(_Types)... }); }
+
+    //----------------------------------------------------------------------------------//
+
+    static analysis_type analyze(storage_type*, const ert::ceilings&, std::false_type)
+    {
+        return analysis_type{};
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    template <typename _Storage>
+    static analysis_type analyze(_Storage* _store, const ert::ceilings& _ceilings,
+                                 std::true_type)
+    {
+        analysis_type _ret;
+        if(!_store || _ceilings.empty())
+            return _ret;
+
+        const double giga = static_cast<double>(units::gigabyte);
+        const int    _lst = _lst_index();
+        for(const auto& itr : _store->get())
+        {
+            const auto&    _obj = std::get<1>(itr);
+            analysis_entry _entry;
+            _entry.label   = std::get<5>(itr).back();
+            _entry.depth   = std::get<3>(itr);
+            _entry.laps    = _obj.laps;
+            _entry.runtime = _obj.get_elapsed(units::sec);
+            if(!(_entry.runtime > 0.0))
+                continue;
+
+            double _ops   = 0.0;
+            double _bytes = 0.0;
+            int    _idx   = 0;
+            for(auto ditr = _obj.begin(); ditr != _obj.end(); ++ditr, ++_idx)
+            {
+                if(_idx == _lst)
+                    _bytes = static_cast<double>(*ditr) * get_type_size();
+                else
+                    _ops += static_cast<double>(*ditr);
+            }
+
+            if(event_mode() == MODE::OP)
+            {
+                _entry.intensity = (_bytes > 0.0) ? (_ops / _bytes) : 0.0;
+                _entry.attained  = _ops / _entry.runtime / giga;
+                _entry.roof      = _ceilings.roof(_entry.intensity);
+            }
+            else
+            {
+                _entry.attained = _bytes / _entry.runtime / giga;
+                _entry.roof     = _ceilings.peak_bandwidth();
+            }
+
+            if(_entry.attained > 0.0)
+                _ret.push_back(_entry);
+        }
+
+        std::stable_sort(_ret.begin(), _ret.end(),
+                         [](const analysis_entry& lhs, const analysis_entry& rhs) {
+                             return lhs.recoverable() > rhs.recoverable();
+                         });
+        return _ret;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static std::string indented(const analysis_entry& itr)
+    {
+        std::string _indent = "";
+        if(itr.depth > 0)
+        {
+            for(int64_t i = 0; i < itr.depth - 1; ++i)
+                _indent += "  ";
+            _indent += "|_";
+        }
+        return _indent + itr.label;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static std::string escape(const std::string& _str)
+    {
+        std::stringstream _ss;
+        for(auto c : _str)
+        {
+            switch(c)
+            {
+                case '"': _ss << "\\\""; break;
+                case '\\': _ss << "\\\\"; break;
+                case '\n': _ss << "\\n"; break;
+                case '\t': _ss << "\\t"; break;
+                default:
+                    if(static_cast<unsigned char>(c) < 0x20)
+                        _ss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                            << static_cast<int>(c) << std::dec << std::setfill(' ');
+                    else
+                        _ss << c;
+            }
+        }
+        return _ss.str();
+    }
+
+    //----------------------------------------------------------------------------------//
+
     static event_type*& _events_ptr()
     {
         static thread_local event_type* _instance = new event_type;
@@ -0,0 +1,657 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory/components/derived/io_tracker.hpp
+ * \headerfile timemory/components/derived/io_tracker.hpp
+ * "timemory/components/derived/io_tracker.hpp"
+ * GOTCHA-based component which measures the latency and throughput of file I/O.
+ * read, write, pread, pwrite, fsync, open, close, fopen, fclose, fread and fwrite
+ * are wrapped and every call records the bytes transferred, the latency and the log2
+ * bucket of the latency in a child node of the active call-graph node, i.e. each node
+ * carries a latency histogram in addition to the totals. The paths passed to open and
+ * fopen are registered in a process-wide table indexed by file descriptor so the
+ * read/write wrappers attribute the bytes and latency to a path with a single atomic
+ * load (no string operations). The per-path totals are reported at finalization.
+ *
+ */
+
+#pragma once
+
+#include "timemory/bits/settings.hpp"
+#include "timemory/components/base.hpp"
+#include "timemory/components/gotcha.hpp"
+#include "timemory/components/timing.hpp"
+#include "timemory/components/types.hpp"
+#include "timemory/mpl/apply.hpp"
+#include "timemory/units.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#if defined(_UNIX)
+
+#    include <cstdio>
+#    include <fcntl.h>
+#    include <sys/types.h>
+#    include <unistd.h>
+
+namespace tim
+{
+//
+// clang-format off
+namespace component { struct io_tracker; }
+// clang-format on
+//
+//======================================================================================//
+
+namespace trait
+{
+// read
+template <>
+struct supports_args<component::io_tracker, std::tuple<std::string, int, void*, size_t>>
+: std::true_type
+{};
+
+// write
+template <>
+struct supports_args<component::io_tracker,
+                     std::tuple<std::string, int, const void*, size_t>> : std::true_type
+{};
+
+// pread
+template <>
+struct supports_args<component::io_tracker,
+                     std::tuple<std::string, int, void*, size_t, off_t>> : std::true_type
+{};
+
+// pwrite
+template <>
+struct supports_args<component::io_tracker,
+                     std::tuple<std::string, int, const void*, size_t, off_t>>
+: std::true_type
+{};
+
+// fsync, close (arguments) and open, fsync, close (return value)
+template <>
+struct supports_args<component::io_tracker, std::tuple<std::string, int>>
+: std::true_type
+{};
+
+// open
+template <>
+struct supports_args<component::io_tracker,
+                     std::tuple<std::string, const char*, int, mode_t>> : std::true_type
+{};
+
+// fopen
+template <>
+struct supports_args<component::io_tracker,
+                     std::tuple<std::string, const char*, const char*>> : std::true_type
+{};
+
+// fread
+template <>
+struct supports_args<component::io_tracker,
+                     std::tuple<std::string, void*, size_t, size_t, FILE*>>
+: std::true_type
+{};
+
+// fwrite
+template <>
+struct supports_args<component::io_tracker,
+                     std::tuple<std::string, const void*, size_t, size_t, FILE*>>
+: std::true_type
+{};
+
+// read, write, pread, pwrite (return value)
+template <>
+struct supports_args<component::io_tracker, std::tuple<std::string, ssize_t>>
+: std::true_type
+{};
+
+// fread, fwrite (return value)
+template <>
+struct supports_args<component::io_tracker, std::tuple<std::string, size_t>>
+: std::true_type
+{};
+
+// fopen (return value), fclose (arguments)
+template <>
+struct supports_args<component::io_tracker, std::tuple<std::string, FILE*>>
+: std::true_type
+{};
+
+template <>
+struct is_memory_category<component::io_tracker> : std::true_type
+{};
+
+template <>
+struct uses_memory_units<component::io_tracker> : std::true_type
+{};
+
+template <>
+struct custom_unit_printing<component::io_tracker> : std::true_type
+{};
+
+template <>
+struct custom_label_printing<component::io_tracker> : std::true_type
+{};
+
+}  // namespace trait
+
+namespace component
+{
+//--------------------------------------------------------------------------------------//
+/// \class io_tracker
+/// \brief I/O tracer: the value is { bytes, latency (nsec), histogram... } where
+/// histogram bin N counts the calls with a latency in [2^(N-1), 2^N) nanoseconds
+//
+struct io_tracker
+: base<io_tracker, std::array<int64_t, 34>, policy::global_init, policy::global_finalize>
+{
+    /// number of log2 latency bins, the last bin collects everything above ~1 second
+    static constexpr uintmax_t histogram_size = 32;
+
+    // clang-format off
+    using ratio_t        = std::nano;
+    using value_type     = std::array<int64_t, histogram_size + 2>;
+    using this_type      = io_tracker;
+    using base_type      = base<this_type, value_type, policy::global_init, policy::global_finalize>;
+    using storage_type   = typename base_type::storage_type;
+    using timer_type     = real_clock;
+    using result_type    = std::tuple<double, double, double>;
+    using histogram_type = std::array<int64_t, histogram_size>;
+    // clang-format on
+
+    /// indices of the wrappers in the gotcha initializer
+    enum : size_t
+    {
+        read_idx = 0,
+        write_idx,
+        pread_idx,
+        pwrite_idx,
+        fsync_idx,
+        open_idx,
+        close_idx,
+        fopen_idx,
+        fclose_idx,
+        fread_idx,
+        fwrite_idx
+    };
+
+    /// number of wrapped functions
+    static constexpr uintmax_t data_size = 11;
+    /// file descriptors at or above this value are reported as "(other)"
+    static constexpr uintmax_t fd_table_size = 16384;
+    /// number of paths in the report at finalization
+    static constexpr uintmax_t path_report_size = 20;
+
+    // required static functions
+    static int64_t     unit() { return units::kilobyte; }
+    static std::string label() { return "io_tracker"; }
+    static std::string description() { return "file I/O latency and throughput"; }
+    static value_type  record() { return value_type{}; }
+
+    using base_type::accum;
+    using base_type::is_transient;
+    using base_type::set_started;
+    using base_type::set_stopped;
+    using base_type::value;
+
+    /// accumulated bytes, latency (in nanoseconds) and calls of a path
+    struct path_entry
+    {
+        std::string path;
+        int64_t     bytes;
+        int64_t     latency;
+        int64_t     calls;
+    };
+
+public:
+    template <typename... _Types>
+    struct gotcha_spec;
+
+    template <typename... _Types, template <typename...> class _Tuple>
+    struct gotcha_spec<_Tuple<_Types...>>
+    {
+        using gotcha_component_type = _Tuple<_Types..., this_type>;
+        using gotcha_type           = gotcha<data_size, gotcha_component_type, this_type>;
+        using component_type        = _Tuple<_Types..., gotcha_type>;
+
+        static std::function<void()>& get_initializer()
+        {
+            static std::function<void()> _lambda = []() {
+                TIMEMORY_C_GOTCHA(gotcha_type, read_idx, read);
+                TIMEMORY_C_GOTCHA(gotcha_type, write_idx, write);
+                TIMEMORY_C_GOTCHA(gotcha_type, pread_idx, pread);
+                TIMEMORY_C_GOTCHA(gotcha_type, pwrite_idx, pwrite);
+                TIMEMORY_C_GOTCHA(gotcha_type, fsync_idx, fsync);
+                // open is variadic: the wrapper always forwards the mode
+                using open_args_t = std::tuple<const char*, int, mode_t>;
+                gotcha_type::template instrument<open_idx, int, open_args_t>::generate(
+                    "open");
+                TIMEMORY_C_GOTCHA(gotcha_type, close_idx, close);
+                TIMEMORY_C_GOTCHA(gotcha_type, fopen_idx, fopen);
+                TIMEMORY_C_GOTCHA(gotcha_type, fclose_idx, fclose);
+                TIMEMORY_C_GOTCHA(gotcha_type, fread_idx, fread);
+                TIMEMORY_C_GOTCHA(gotcha_type, fwrite_idx, fwrite);
+            };
+            return _lambda;
+        }
+    };
+
+    //----------------------------------------------------------------------------------//
+    //  invoked by the gotcha wrapper before anything is measured: the path of a
+    //  descriptor is released before close (or fclose of its stream) so a reused
+    //  descriptor (e.g. a socket) is never attributed to the previous path
+    //
+    template <size_t _N, typename _Ret, typename... _Args>
+    static bool gotcha_fast_path(_Ret&, _Args... _args)
+    {
+        release(std::integral_constant<size_t, _N>{}, _args...);
+        return false;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static void invoke_global_init(storage_type*) {}
+
+    //----------------------------------------------------------------------------------//
+
+    static void invoke_global_finalize(storage_type*)
+    {
+        if(settings::cout_output())
+            print_paths(std::cout);
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  the paths sorted by decreasing latency. I/O on descriptors which were not
+    //  opened through the wrappers (or exceed the table) is reported as "(other)"
+    //
+    static std::vector<path_entry> get_paths()
+    {
+        std::vector<path_entry> _ret;
+        auto_lock_t             _lk(get_path_mutex());
+        for(const auto& itr : get_path_records())
+        {
+            if(itr.second->calls.load() == 0)
+                continue;
+            _ret.push_back(path_entry{ itr.first, itr.second->bytes.load(),
+                                       itr.second->latency.load(),
+                                       itr.second->calls.load() });
+        }
+        auto& _other = get_other();
+        if(_other.calls.load() > 0)
+            _ret.push_back(path_entry{ "(other)", _other.bytes.load(),
+                                       _other.latency.load(), _other.calls.load() });
+
+        std::sort(_ret.begin(), _ret.end(),
+                  [](const path_entry& lhs, const path_entry& rhs) {
+                      return lhs.latency > rhs.latency;
+                  });
+        return _ret;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static void print_paths(std::ostream& os, uintmax_t _n = path_report_size)
+    {
+        auto _paths = get_paths();
+        if(_paths.empty())
+            return;
+
+        std::stringstream ss;
+        ss << "\n[" << label() << "]> paths with the largest I/O latency ("
+           << base_type::get_display_unit() << ", " << timer_type::get_display_unit()
+           << "):\n";
+        for(uintmax_t i = 0; i < _paths.size() && i < _n; ++i)
+        {
+            const auto& itr = _paths.at(i);
+            ss << "    " << std::setw(40) << std::left << itr.path << std::right
+               << " : bytes = " << std::setw(12) << std::fixed << std::setprecision(3)
+               << (static_cast<double>(itr.bytes) / base_type::get_unit())
+               << ", latency = " << std::setw(12) << std::setprecision(6)
+               << (static_cast<double>(itr.latency) / ratio_t::den *
+                   timer_type::get_unit())
+               << ", calls = " << itr.calls << "\n";
+        }
+        if(_paths.size() > _n)
+            ss << "    ... " << (_paths.size() - _n) << " more\n";
+        os << ss.str() << std::flush;
+    }
+
+public:
+    //----------------------------------------------------------------------------------//
+
+    io_tracker()                   = default;
+    ~io_tracker()                  = default;
+    io_tracker(const this_type&)   = default;
+    io_tracker(this_type&&)        = default;
+    io_tracker& operator=(const this_type&) = default;
+    io_tracker& operator=(this_type&&) = default;
+
+public:
+    //----------------------------------------------------------------------------------//
+
+    void start()
+    {
+        set_started();
+        m_start = tim::get_clock_real_now<int64_t, ratio_t>();
+    }
+
+    void stop()
+    {
+        auto _latency = tim::get_clock_real_now<int64_t, ratio_t>() - m_start;
+
+        value    = value_type{};
+        value[0] = m_bytes;
+        value[1] = _latency;
+        value[2 + histogram_bin(_latency)] = 1;
+        accum += value;
+
+        if(m_record)
+        {
+            m_record->bytes.fetch_add(m_bytes, std::memory_order_relaxed);
+            m_record->latency.fetch_add(_latency, std::memory_order_relaxed);
+            m_record->calls.fetch_add(1, std::memory_order_relaxed);
+        }
+        set_stopped();
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    std::string get_display() const
+    {
+        std::stringstream ss, ssv, ssr, ssl;
+        auto              _prec  = base_type::get_precision();
+        auto              _width = base_type::get_width();
+        auto              _flags = base_type::get_format_flags();
+        auto              _disp  = base_type::get_display_unit();
+
+        auto _val = get();
+
+        ssv.setf(_flags);
+        ssv << std::setw(_width) << std::setprecision(_prec) << std::get<0>(_val);
+        if(!_disp.empty())
+            ssv << " " << _disp;
+
+        ssr.setf(_flags);
+        ssr << std::setw(_width) << std::setprecision(_prec) << std::get<1>(_val);
+        if(!_disp.empty())
+            ssr << " " << _disp << "/" << timer_type::get_display_unit();
+
+        ssl.setf(_flags);
+        ssl << std::setw(_width) << std::setprecision(_prec) << std::get<2>(_val) << " "
+            << timer_type::get_display_unit();
+
+        ss << ssv.str() << ", " << ssr.str() << ", " << ssl.str() << " latency";
+        return ss.str();
+    }
+
+    /// bytes, throughput and latency
+    result_type get() const
+    {
+        auto& val = (is_transient) ? accum : value;
+
+        auto data  = static_cast<double>(val[0]) / base_type::get_unit();
+        auto delta = static_cast<double>(val[1]) / static_cast<double>(ratio_t::den) *
+                     timer_type::get_unit();
+        auto rate = data / delta;
+        if(!std::isfinite(rate))
+            rate = 0.0;
+        return result_type(data, rate, delta);
+    }
+
+    /// number of calls per log2 latency bin
+    histogram_type get_histogram() const
+    {
+        auto&          val = (is_transient) ? accum : value;
+        histogram_type _ret;
+        std::copy(val.begin() + 2, val.end(), _ret.begin());
+        return _ret;
+    }
+
+    int64_t get_bytes() const { return ((is_transient) ? accum : value)[0]; }
+    int64_t get_latency() const { return ((is_transient) ? accum : value)[1]; }
+
+    /// the bin which a latency (in nanoseconds) is counted in
+    static uintmax_t histogram_bin(int64_t _latency)
+    {
+        uintmax_t _bin = 0;
+        for(auto _val = static_cast<uint64_t>(std::max<int64_t>(_latency, 0));
+            _val > 0 && _bin + 1 < histogram_size; _val >>= 1)
+            ++_bin;
+        return _bin;
+    }
+
+    //----------------------------------------------------------------------------------//
+    // serialization
+    //
+    template <typename Archive>
+    void serialize(Archive& ar, const unsigned int)
+    {
+        auto _data = get();
+        auto _hist = get_histogram();
+        ar(serializer::make_nvp("is_transient", is_transient),
+           serializer::make_nvp("laps", laps), serializer::make_nvp("repr_data", _data),
+           serializer::make_nvp("value", value), serializer::make_nvp("accum", accum),
+           serializer::make_nvp("histogram", _hist));
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  arguments
+    //
+    void customize(const std::string&, int _fd, void*, size_t)
+    {
+        m_record = get_record(_fd);
+    }
+
+    void customize(const std::string&, int _fd, const void*, size_t)
+    {
+        m_record = get_record(_fd);
+    }
+
+    void customize(const std::string&, int _fd, void*, size_t, off_t)
+    {
+        m_record = get_record(_fd);
+    }
+
+    void customize(const std::string&, int _fd, const void*, size_t, off_t)
+    {
+        m_record = get_record(_fd);
+    }
+
+    void customize(const std::string&, const char* _path, int, mode_t)
+    {
+        m_path = _path;
+    }
+
+    void customize(const std::string&, const char* _path, const char*) { m_path = _path; }
+
+    void customize(const std::string&, void*, size_t _size, size_t, FILE* _fp)
+    {
+        m_size   = _size;
+        m_record = (_fp) ? get_record(fileno(_fp)) : nullptr;
+    }
+
+    void customize(const std::string&, const void*, size_t _size, size_t, FILE* _fp)
+    {
+        m_size   = _size;
+        m_record = (_fp) ? get_record(fileno(_fp)) : nullptr;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  return values
+    //
+    void customize(const std::string&, ssize_t _ret)
+    {
+        if(_ret > 0)
+            m_bytes = _ret;
+    }
+
+    void customize(const std::string&, size_t _ret)
+    {
+        m_bytes = static_cast<int64_t>(_ret * m_size);
+    }
+
+    // the stream returned by fopen or the stream passed to fclose
+    void customize(const std::string&, FILE* _fp)
+    {
+        if(_fp && m_path)
+            m_record = register_path(fileno(_fp), m_path);
+        else if(!m_path)
+            m_has_args = true;
+        m_path = nullptr;
+    }
+
+    // the descriptor passed to fsync/close or the descriptor returned by open. The
+    // descriptor of close (and fclose) was already released by gotcha_fast_path so
+    // close is only recorded in the call-graph
+    void customize(const std::string&, int _val)
+    {
+        if(m_path)
+        {
+            if(_val >= 0)
+                m_record = register_path(_val, m_path);
+            m_path = nullptr;
+        }
+        else if(!m_has_args)
+        {
+            m_record   = find_record(_val);
+            m_has_args = true;
+        }
+    }
+
+private:
+    //----------------------------------------------------------------------------------//
+
+    struct path_record
+    {
+        std::atomic<int64_t> bytes;
+        std::atomic<int64_t> latency;
+        std::atomic<int64_t> calls;
+    };
+
+    using record_map_t = std::map<std::string, path_record*>;
+
+    // zero-initialized and never destroyed so it can be updated during shutdown
+    static std::atomic<path_record*>* get_fd_table()
+    {
+        static auto* _instance = new std::atomic<path_record*>[fd_table_size]();
+        return _instance;
+    }
+
+    static path_record& get_other()
+    {
+        static path_record* _instance = new path_record();
+        return *_instance;
+    }
+
+    static record_map_t& get_path_records()
+    {
+        static record_map_t* _instance = new record_map_t();
+        return *_instance;
+    }
+
+    static mutex_t& get_path_mutex()
+    {
+        static mutex_t* _instance = new mutex_t();
+        return *_instance;
+    }
+
+    // the only place where strings are handled: open and fopen
+    static path_record* register_path(int _fd, const char* _path)
+    {
+        if(static_cast<uintmax_t>(_fd) >= fd_table_size)
+            return &get_other();
+        path_record* _record = nullptr;
+        {
+            auto_lock_t _lk(get_path_mutex());
+            auto&       _records = get_path_records();
+            auto        itr      = _records.find(_path);
+            if(itr == _records.end())
+                itr = _records.insert({ _path, new path_record() }).first;
+            _record = itr->second;
+        }
+        get_fd_table()[_fd].store(_record, std::memory_order_release);
+        return _record;
+    }
+
+    // the record of a registered descriptor or nullptr
+    static path_record* find_record(int _fd)
+    {
+        if(static_cast<uintmax_t>(_fd) >= fd_table_size)
+            return nullptr;
+        return get_fd_table()[_fd].load(std::memory_order_acquire);
+    }
+
+    // the record of a descriptor, unregistered descriptors map to "(other)"
+    static path_record* get_record(int _fd)
+    {
+        auto* _record = find_record(_fd);
+        return (_record) ? _record : &get_other();
+    }
+
+    static void release(std::integral_constant<size_t, close_idx>, int _fd)
+    {
+        if(_fd >= 0 && static_cast<uintmax_t>(_fd) < fd_table_size)
+            get_fd_table()[_fd].store(nullptr, std::memory_order_release);
+    }
+
+    static void release(std::integral_constant<size_t, fclose_idx>, FILE* _fp)
+    {
+        if(_fp)
+            release(std::integral_constant<size_t, close_idx>{}, fileno(_fp));
+    }
+
+    template <size_t _N, typename... _Args>
+    static void release(std::integral_constant<size_t, _N>, _Args...)
+    {}
+
+private:
+    bool         m_has_args = false;
+    int64_t      m_start    = 0;
+    int64_t      m_bytes    = 0;
+    size_t       m_size     = 1;
+    const char*  m_path     = nullptr;
+    path_record* m_record   = nullptr;
+};
+
+}  // namespace component
+
+}  // namespace tim
+
+#endif
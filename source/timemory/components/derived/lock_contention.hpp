@@ -0,0 +1,418 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory/components/derived/lock_contention.hpp
+ * \headerfile timemory/components/derived/lock_contention.hpp
+ * "timemory/components/derived/lock_contention.hpp"
+ * GOTCHA-based component which measures the time spent waiting on contended pthread
+ * locks. The wrappers for pthread_mutex_lock, pthread_rwlock_rdlock and
+ * pthread_rwlock_wrlock first attempt the corresponding trylock: when the lock is
+ * acquired, the wrapper returns immediately without constructing the bundle so
+ * uncontended locks only pay for the trylock. Otherwise, the blocking call is timed,
+ * i.e. the wait time and the number of contended acquires (laps) are recorded in a
+ * child node of the active call-graph node. pthread_cond_wait and
+ * pthread_cond_timedwait are always timed. The wait time and count are also
+ * accumulated per lock address and the addresses with the largest wait times are
+ * reported at finalization.
+ *
+ */
+
+#pragma once
+
+#include "timemory/bits/settings.hpp"
+#include "timemory/components/base.hpp"
+#include "timemory/components/gotcha.hpp"
+#include "timemory/components/types.hpp"
+#include "timemory/mpl/apply.hpp"
+#include "timemory/units.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#if defined(_UNIX)
+
+#    include <pthread.h>
+#    include <time.h>
+
+namespace tim
+{
+//
+// clang-format off
+namespace component { struct lock_contention; }
+// clang-format on
+//
+//======================================================================================//
+
+namespace trait
+{
+// pthread_mutex_lock
+template <>
+struct supports_args<component::lock_contention, std::tuple<std::string, pthread_mutex_t*>>
+: std::true_type
+{};
+
+// pthread_rwlock_rdlock, pthread_rwlock_wrlock
+template <>
+struct supports_args<component::lock_contention,
+                     std::tuple<std::string, pthread_rwlock_t*>> : std::true_type
+{};
+
+// pthread_cond_wait
+template <>
+struct supports_args<component::lock_contention,
+                     std::tuple<std::string, pthread_cond_t*, pthread_mutex_t*>>
+: std::true_type
+{};
+
+// pthread_cond_timedwait
+template <>
+struct supports_args<
+    component::lock_contention,
+    std::tuple<std::string, pthread_cond_t*, pthread_mutex_t*, const struct timespec*>>
+: std::true_type
+{};
+
+template <>
+struct is_timing_category<component::lock_contention> : std::true_type
+{};
+
+template <>
+struct uses_timing_units<component::lock_contention> : std::true_type
+{};
+
+}  // namespace trait
+
+namespace component
+{
+struct lock_contention
+: base<lock_contention, int64_t, policy::global_init, policy::global_finalize>
+{
+    // clang-format off
+    using ratio_t      = std::nano;
+    using value_type   = int64_t;
+    using this_type    = lock_contention;
+    using base_type    = base<this_type, value_type, policy::global_init, policy::global_finalize>;
+    using storage_type = typename base_type::storage_type;
+    // clang-format on
+
+    /// indices of the wrappers in the gotcha initializer
+    enum : size_t
+    {
+        mutex_lock_idx = 0,
+        rwlock_rdlock_idx,
+        rwlock_wrlock_idx,
+        cond_wait_idx,
+        cond_timedwait_idx
+    };
+
+    /// number of wrapped functions
+    static constexpr uintmax_t data_size = 5;
+    /// max number of distinct lock addresses which are tracked individually
+    static constexpr uintmax_t address_table_size = 4096;
+    /// number of lock addresses in the report at finalization
+    static constexpr uintmax_t address_report_size = 20;
+
+    // required static functions
+    static std::string label() { return "lock_contention"; }
+    static std::string description()
+    {
+        return "time spent waiting on contended pthread locks";
+    }
+    static value_type record() { return tim::get_clock_real_now<int64_t, ratio_t>(); }
+
+    using base_type::accum;
+    using base_type::is_transient;
+    using base_type::set_started;
+    using base_type::set_stopped;
+    using base_type::value;
+
+    /// accumulated wait time (in nanoseconds) and contended acquires of a lock
+    struct address_entry
+    {
+        uintptr_t address;
+        int64_t   wait;
+        int64_t   count;
+    };
+
+public:
+    template <typename... _Types>
+    struct gotcha_spec;
+
+    template <typename... _Types, template <typename...> class _Tuple>
+    struct gotcha_spec<_Tuple<_Types...>>
+    {
+        using gotcha_component_type = _Tuple<_Types..., this_type>;
+        using gotcha_type           = gotcha<data_size, gotcha_component_type, this_type>;
+        using component_type        = _Tuple<_Types..., gotcha_type>;
+
+        static std::function<void()>& get_initializer()
+        {
+            static std::function<void()> _lambda = []() {
+                TIMEMORY_C_GOTCHA(gotcha_type, mutex_lock_idx, pthread_mutex_lock);
+                TIMEMORY_C_GOTCHA(gotcha_type, rwlock_rdlock_idx, pthread_rwlock_rdlock);
+                TIMEMORY_C_GOTCHA(gotcha_type, rwlock_wrlock_idx, pthread_rwlock_wrlock);
+                TIMEMORY_C_GOTCHA(gotcha_type, cond_wait_idx, pthread_cond_wait);
+                TIMEMORY_C_GOTCHA(gotcha_type, cond_timedwait_idx,
+                                  pthread_cond_timedwait);
+            };
+            return _lambda;
+        }
+    };
+
+    //----------------------------------------------------------------------------------//
+    //  invoked by the gotcha wrapper before anything is measured: returning true
+    //  means the lock was acquired without waiting
+    //
+    template <size_t _N, typename _Ret, typename... _Args>
+    static bool gotcha_fast_path(_Ret& _ret, _Args... _args)
+    {
+        return try_lock(std::integral_constant<size_t, _N>{}, _ret, _args...);
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static void invoke_global_init(storage_type*) {}
+
+    //----------------------------------------------------------------------------------//
+
+    static void invoke_global_finalize(storage_type*)
+    {
+        if(settings::cout_output())
+            print_addresses(std::cout);
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  the lock addresses sorted by decreasing wait time. Contended acquires of locks
+    //  which did not fit in the table are reported with an address of zero
+    //
+    static std::vector<address_entry> get_addresses()
+    {
+        std::vector<address_entry> _ret;
+        auto*                      _table = get_address_table();
+        for(uintmax_t i = 0; i < address_table_size; ++i)
+        {
+            auto _addr = _table[i].address.load(std::memory_order_acquire);
+            if(_addr == 0)
+                continue;
+            _ret.push_back(
+                address_entry{ _addr, _table[i].wait.load(std::memory_order_relaxed),
+                               _table[i].count.load(std::memory_order_relaxed) });
+        }
+        auto& _overflow = get_overflow();
+        if(_overflow.count.load() > 0)
+            _ret.push_back(
+                address_entry{ 0, _overflow.wait.load(), _overflow.count.load() });
+
+        std::sort(_ret.begin(), _ret.end(),
+                  [](const address_entry& lhs, const address_entry& rhs) {
+                      return lhs.wait > rhs.wait;
+                  });
+        return _ret;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static void print_addresses(std::ostream& os, uintmax_t _n = address_report_size)
+    {
+        auto _addresses = get_addresses();
+        if(_addresses.empty())
+            return;
+
+        std::stringstream ss;
+        ss << "\n[" << label() << "]> lock addresses with the largest wait times ("
+           << base_type::get_display_unit() << "):\n";
+        for(uintmax_t i = 0; i < _addresses.size() && i < _n; ++i)
+        {
+            const auto& itr = _addresses.at(i);
+            ss << "    " << std::setw(18) << std::left;
+            if(itr.address == 0)
+                ss << "(other)";
+            else
+                ss << (void*) itr.address;
+            ss << std::right << " : wait = " << std::setw(12) << std::fixed
+               << std::setprecision(6)
+               << (static_cast<double>(itr.wait) / ratio_t::den * base_type::get_unit())
+               << ", contended = " << itr.count << "\n";
+        }
+        if(_addresses.size() > _n)
+            ss << "    ... " << (_addresses.size() - _n) << " more\n";
+        os << ss.str() << std::flush;
+    }
+
+public:
+    //----------------------------------------------------------------------------------//
+
+    lock_contention()                   = default;
+    ~lock_contention()                  = default;
+    lock_contention(const this_type&)   = default;
+    lock_contention(this_type&&)        = default;
+    lock_contention& operator=(const this_type&) = default;
+    lock_contention& operator=(this_type&&) = default;
+
+public:
+    //----------------------------------------------------------------------------------//
+
+    void start()
+    {
+        set_started();
+        value = record();
+    }
+
+    void stop()
+    {
+        auto _wait = record() - value;
+        accum += _wait;
+        value = _wait;
+        if(m_address != 0)
+            add_address(m_address, _wait);
+        set_stopped();
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    double get_display() const { return get(); }
+
+    double get() const
+    {
+        auto val = (is_transient) ? accum : value;
+        return static_cast<double>(val) / ratio_t::den * base_type::get_unit();
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    void customize(const std::string&, pthread_mutex_t* _mutex)
+    {
+        m_address = reinterpret_cast<uintptr_t>(_mutex);
+    }
+
+    void customize(const std::string&, pthread_rwlock_t* _rwlock)
+    {
+        m_address = reinterpret_cast<uintptr_t>(_rwlock);
+    }
+
+    void customize(const std::string&, pthread_cond_t* _cond, pthread_mutex_t*)
+    {
+        m_address = reinterpret_cast<uintptr_t>(_cond);
+    }
+
+    void customize(const std::string&, pthread_cond_t* _cond, pthread_mutex_t*,
+                   const struct timespec*)
+    {
+        m_address = reinterpret_cast<uintptr_t>(_cond);
+    }
+
+private:
+    //----------------------------------------------------------------------------------//
+
+    static bool try_lock(std::integral_constant<size_t, mutex_lock_idx>, int& _ret,
+                         pthread_mutex_t* _mutex)
+    {
+        _ret = pthread_mutex_trylock(_mutex);
+        return (_ret == 0);
+    }
+
+    static bool try_lock(std::integral_constant<size_t, rwlock_rdlock_idx>, int& _ret,
+                         pthread_rwlock_t* _rwlock)
+    {
+        _ret = pthread_rwlock_tryrdlock(_rwlock);
+        return (_ret == 0);
+    }
+
+    static bool try_lock(std::integral_constant<size_t, rwlock_wrlock_idx>, int& _ret,
+                         pthread_rwlock_t* _rwlock)
+    {
+        _ret = pthread_rwlock_trywrlock(_rwlock);
+        return (_ret == 0);
+    }
+
+    // condition variables (and anything else) always take the measured path
+    template <size_t _N, typename _Ret, typename... _Args>
+    static bool try_lock(std::integral_constant<size_t, _N>, _Ret&, _Args...)
+    {
+        return false;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    struct address_slot
+    {
+        std::atomic<uintptr_t> address;
+        std::atomic<int64_t>   wait;
+        std::atomic<int64_t>   count;
+    };
+
+    // zero-initialized and never destroyed so it can be updated during shutdown
+    static address_slot* get_address_table()
+    {
+        static address_slot* _instance = new address_slot[address_table_size]();
+        return _instance;
+    }
+
+    static address_slot& get_overflow()
+    {
+        static address_slot* _instance = new address_slot();
+        return *_instance;
+    }
+
+    // lock-free insertion with linear probing
+    static void add_address(uintptr_t _addr, int64_t _wait)
+    {
+        auto*     _table = get_address_table();
+        uintmax_t _idx   = (_addr >> 4) % address_table_size;
+        for(uintmax_t i = 0; i < address_table_size; ++i)
+        {
+            auto&     _slot = _table[(_idx + i) % address_table_size];
+            uintptr_t _curr = _slot.address.load(std::memory_order_acquire);
+            if(_curr == 0 &&
+               _slot.address.compare_exchange_strong(_curr, _addr,
+                                                     std::memory_order_acq_rel))
+                _curr = _addr;
+            if(_curr == _addr)
+            {
+                _slot.wait.fetch_add(_wait, std::memory_order_relaxed);
+                _slot.count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        get_overflow().wait.fetch_add(_wait, std::memory_order_relaxed);
+        get_overflow().count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    uintptr_t m_address = 0;
+};
+
+}  // namespace component
+
+}  // namespace tim
+
+#endif
@@ -0,0 +1,711 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory/components/derived/mpi_comm_matrix.hpp
+ * \headerfile timemory/components/derived/mpi_comm_matrix.hpp
+ * "timemory/components/derived/mpi_comm_matrix.hpp"
+ * GOTCHA-based component which uses the customize hooks to record the peer rank,
+ * byte count, and communicator of MPI calls. Each rank accumulates its row of the
+ * rank x rank (sender x receiver) bytes/messages matrix in preallocated arrays and a
+ * log2 message-size histogram per call site, i.e. per call-graph path leading to the
+ * MPI function. The row and the histograms are written to "mpi_comm_matrix_<RANK>.txt"
+ * at finalization. No collective operations
+ * are performed at finalization so concatenating the per-rank files in rank order
+ * yields the full matrix.
+ *
+ */
+
+#pragma once
+
+#include "timemory/backends/mpi.hpp"
+#include "timemory/bits/settings.hpp"
+#include "timemory/bits/types.hpp"
+#include "timemory/components/base.hpp"
+#include "timemory/components/gotcha.hpp"
+#include "timemory/components/types.hpp"
+#include "timemory/mpl/apply.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#if defined(TIMEMORY_USE_MPI)
+
+namespace tim
+{
+//
+// clang-format off
+namespace component { struct mpi_comm_matrix; }
+// clang-format on
+//
+//======================================================================================//
+
+namespace trait
+{
+// MPI_Send, MPI_Bsend, MPI_Ssend, MPI_Rsend
+template <>
+struct supports_args<component::mpi_comm_matrix,
+                     std::tuple<std::string, const void*, int, MPI_Datatype, int, int,
+                                MPI_Comm>> : std::true_type
+{};
+
+// MPI_Isend, MPI_Ibsend, MPI_Issend, MPI_Irsend
+template <>
+struct supports_args<component::mpi_comm_matrix,
+                     std::tuple<std::string, const void*, int, MPI_Datatype, int, int,
+                                MPI_Comm, MPI_Request*>> : std::true_type
+{};
+
+// MPI_Recv
+template <>
+struct supports_args<component::mpi_comm_matrix,
+                     std::tuple<std::string, void*, int, MPI_Datatype, int, int, MPI_Comm,
+                                MPI_Status*>> : std::true_type
+{};
+
+// MPI_Irecv
+template <>
+struct supports_args<component::mpi_comm_matrix,
+                     std::tuple<std::string, void*, int, MPI_Datatype, int, int, MPI_Comm,
+                                MPI_Request*>> : std::true_type
+{};
+
+// MPI_Bcast
+template <>
+struct supports_args<component::mpi_comm_matrix,
+                     std::tuple<std::string, void*, int, MPI_Datatype, int, MPI_Comm>>
+: std::true_type
+{};
+
+// MPI_Reduce
+template <>
+struct supports_args<component::mpi_comm_matrix,
+                     std::tuple<std::string, const void*, void*, int, MPI_Datatype,
+                                MPI_Op, int, MPI_Comm>> : std::true_type
+{};
+
+// MPI_Allreduce
+template <>
+struct supports_args<component::mpi_comm_matrix,
+                     std::tuple<std::string, const void*, void*, int, MPI_Datatype,
+                                MPI_Op, MPI_Comm>> : std::true_type
+{};
+
+// return value of every MPI function (used to complete MPI_Recv)
+template <>
+struct supports_args<component::mpi_comm_matrix, std::tuple<std::string, int>>
+: std::true_type
+{};
+
+template <>
+struct uses_memory_units<component::mpi_comm_matrix> : std::true_type
+{};
+
+template <>
+struct is_memory_category<component::mpi_comm_matrix> : std::true_type
+{};
+
+}  // namespace trait
+
+namespace component
+{
+struct mpi_comm_matrix
+: base<mpi_comm_matrix, double, policy::global_init, policy::global_finalize>
+{
+    // clang-format off
+    using value_type   = double;
+    using this_type    = mpi_comm_matrix;
+    using base_type    = base<this_type, value_type, policy::global_init, policy::global_finalize>;
+    using storage_type = typename base_type::storage_type;
+    using string_hash  = std::hash<std::string>;
+    using count_type   = unsigned long long;
+    // clang-format on
+
+    /// functions whose arguments are recorded
+    static constexpr uintmax_t data_size = 13;
+    /// number of log2 bins: bin 0 is zero bytes, bin N is [2^(N-1), 2^N) bytes
+    static constexpr uintmax_t hist_size = 48;
+
+    // formatting
+    static const short precision = 3;
+    static const short width     = 12;
+
+    // required static functions
+    static std::string label() { return "mpi_comm_matrix"; }
+    static std::string description()
+    {
+        return "MPI communication matrix and message-size histogram";
+    }
+    static std::string display_unit() { return "MB"; }
+    static int64_t     unit() { return units::megabyte; }
+    static value_type  record() { return value_type{ 0.0 }; }
+
+    using base_type::accum;
+    using base_type::is_transient;
+    using base_type::set_started;
+    using base_type::set_stopped;
+    using base_type::value;
+
+public:
+    //----------------------------------------------------------------------------------//
+
+    static void invoke_global_init(storage_type*) {}
+
+    //----------------------------------------------------------------------------------//
+
+    static void invoke_global_finalize(storage_type*) { write_matrix(); }
+
+    //----------------------------------------------------------------------------------//
+
+    static uintmax_t get_index(const std::string& fname)
+    {
+        // strip any tool prefix, e.g. "mpip/MPI_Send"
+        auto      _pos  = fname.find_last_of('/');
+        auto      _hash = string_hash()((_pos == std::string::npos) ? fname
+                                                              : fname.substr(_pos + 1));
+        uintmax_t idx   = std::numeric_limits<uintmax_t>::max();
+        for(uintmax_t i = 0; i < get_hash_array().size(); ++i)
+        {
+            if(_hash == get_hash_array()[i])
+                idx = i;
+        }
+        return idx;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static const std::array<std::string, data_size>& get_function_names()
+    {
+        static std::array<std::string, data_size> _instance = {
+            { "MPI_Send", "MPI_Bsend", "MPI_Ssend", "MPI_Rsend", "MPI_Isend",
+              "MPI_Ibsend", "MPI_Issend", "MPI_Irsend", "MPI_Recv", "MPI_Irecv",
+              "MPI_Bcast", "MPI_Reduce", "MPI_Allreduce" }
+        };
+        return _instance;
+    }
+
+public:
+    //----------------------------------------------------------------------------------//
+
+    mpi_comm_matrix()
+    {
+        value = 0.0;
+        accum = 0.0;
+    }
+
+    ~mpi_comm_matrix()                = default;
+    mpi_comm_matrix(const this_type&) = default;
+    mpi_comm_matrix(this_type&&)      = default;
+    mpi_comm_matrix& operator=(const this_type&) = default;
+    mpi_comm_matrix& operator=(this_type&&) = default;
+
+public:
+    //----------------------------------------------------------------------------------//
+
+    void start()
+    {
+        set_started();
+        value = record();
+    }
+
+    void stop()
+    {
+        // value is updated via customize in-between start() and stop()
+        accum += value;
+        set_stopped();
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    double get_display() const { return get(); }
+
+    //----------------------------------------------------------------------------------//
+
+    double get() const { return accum / base_type::get_unit(); }
+
+    //----------------------------------------------------------------------------------//
+    // MPI_Send, MPI_Bsend, MPI_Ssend, MPI_Rsend
+    //
+    void customize(const std::string& fname, const void*, int count,
+                   MPI_Datatype datatype, int dest, int, MPI_Comm comm)
+    {
+        add_send(get_index(fname), count, datatype, dest, comm);
+    }
+
+    //----------------------------------------------------------------------------------//
+    // MPI_Isend, MPI_Ibsend, MPI_Issend, MPI_Irsend
+    //
+    void customize(const std::string& fname, const void*, int count,
+                   MPI_Datatype datatype, int dest, int, MPI_Comm comm, MPI_Request*)
+    {
+        add_send(get_index(fname), count, datatype, dest, comm);
+    }
+
+    //----------------------------------------------------------------------------------//
+    // MPI_Recv: the received size is read from the status after the call completes
+    //
+    void customize(const std::string& fname, void*, int count, MPI_Datatype datatype,
+                   int, int, MPI_Comm, MPI_Status* status)
+    {
+        auto idx = get_index(fname);
+        if(idx >= data_size)
+            return;
+        if(status != MPI_STATUS_IGNORE)
+        {
+            m_status   = status;
+            m_datatype = datatype;
+            m_index    = idx;
+        }
+        else
+        {
+            add_message(idx, get_bytes(count, datatype));
+        }
+    }
+
+    //----------------------------------------------------------------------------------//
+    // MPI_Irecv: only the posted size is known
+    //
+    void customize(const std::string& fname, void*, int count, MPI_Datatype datatype,
+                   int, int, MPI_Comm, MPI_Request*)
+    {
+        auto idx = get_index(fname);
+        if(idx < data_size)
+            add_message(idx, get_bytes(count, datatype));
+    }
+
+    //----------------------------------------------------------------------------------//
+    // MPI_Bcast: the root sends to every other rank in the communicator
+    //
+    void customize(const std::string& fname, void*, int count, MPI_Datatype datatype,
+                   int root, MPI_Comm comm)
+    {
+        auto idx = get_index(fname);
+        if(idx >= data_size)
+            return;
+        auto _bytes = get_bytes(count, datatype);
+        add_message(idx, _bytes);
+        const auto& _info = get_comm_info(comm);
+        if(_info.rank != root)
+            return;
+        for(int i = 0; i < _info.size; ++i)
+            if(i != root)
+                add_peer(translate(_info, i), _bytes);
+    }
+
+    //----------------------------------------------------------------------------------//
+    // MPI_Reduce: every rank except the root sends to the root
+    //
+    void customize(const std::string& fname, const void*, void*, int count,
+                   MPI_Datatype datatype, MPI_Op, int root, MPI_Comm comm)
+    {
+        auto idx = get_index(fname);
+        if(idx >= data_size)
+            return;
+        auto _bytes = get_bytes(count, datatype);
+        add_message(idx, _bytes);
+        const auto& _info = get_comm_info(comm);
+        if(_info.rank != root)
+            add_peer(translate(_info, root), _bytes);
+    }
+
+    //----------------------------------------------------------------------------------//
+    // MPI_Allreduce: no single peer so only the histogram is updated
+    //
+    void customize(const std::string& fname, const void*, void*, int count,
+                   MPI_Datatype datatype, MPI_Op, MPI_Comm)
+    {
+        auto idx = get_index(fname);
+        if(idx < data_size)
+            add_message(idx, get_bytes(count, datatype));
+    }
+
+    //----------------------------------------------------------------------------------//
+    // return value: complete a pending MPI_Recv
+    //
+    void customize(const std::string&, int ret)
+    {
+        if(!m_status)
+            return;
+        if(ret == MPI_SUCCESS)
+        {
+            int _count = 0;
+            MPI_Get_count(m_status, m_datatype, &_count);
+            if(_count != MPI_UNDEFINED)
+                add_message(m_index, get_bytes(_count, m_datatype));
+        }
+        m_status = nullptr;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    this_type& operator+=(const this_type& rhs)
+    {
+        value += rhs.value;
+        accum += rhs.accum;
+        if(rhs.is_transient)
+            is_transient = rhs.is_transient;
+        return *this;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    this_type& operator-=(const this_type& rhs)
+    {
+        value -= rhs.value;
+        accum -= rhs.accum;
+        if(rhs.is_transient)
+            is_transient = rhs.is_transient;
+        return *this;
+    }
+
+private:
+    using atomic_type  = std::atomic<count_type>;
+    using row_type     = std::unique_ptr<atomic_type[]>;
+    using hist_type    = std::array<atomic_type, hist_size>;
+    using hash_array_t = std::array<uintmax_t, data_size>;
+    using graph_t      = typename storage_type::graph_t;
+
+    //----------------------------------------------------------------------------------//
+    //  rank of this process in a communicator and the MPI_COMM_WORLD rank of every
+    //  member, "world" is left empty for MPI_COMM_WORLD
+    //
+    struct comm_info
+    {
+        int              rank = 0;
+        int              size = 0;
+        std::vector<int> world;
+    };
+
+    //----------------------------------------------------------------------------------//
+    //  message-size histogram of one call site. The call site is the call-graph path
+    //  leading to the MPI function so the same function called from two different
+    //  regions gets two histograms
+    //
+    struct call_site
+    {
+        uintmax_t   index = 0;
+        std::string path;
+        hist_type   hist;
+
+        call_site(uintmax_t _index, std::string _path)
+        : index(_index)
+        , path(std::move(_path))
+        {
+            for(auto& itr : hist)
+                itr.store(0);
+        }
+    };
+
+    using rank_map_t      = std::unordered_map<MPI_Comm, comm_info>;
+    using call_site_map_t = std::map<uint64_t, std::unique_ptr<call_site>>;
+    using call_site_ptr_t = std::unordered_map<uint64_t, call_site*>;
+
+    //----------------------------------------------------------------------------------//
+    //  row of the matrix for this rank, allocated once the size of MPI_COMM_WORLD is
+    //  known
+    //
+    struct matrix_row
+    {
+        int32_t        size = 0;
+        row_type       bytes;
+        row_type       messages;
+        std::once_flag flag;
+    };
+
+    static matrix_row& get_row()
+    {
+        static matrix_row _instance;
+        std::call_once(_instance.flag, []() {
+            _instance.size     = mpi::size();
+            _instance.bytes    = row_type(new atomic_type[_instance.size]);
+            _instance.messages = row_type(new atomic_type[_instance.size]);
+            for(int32_t i = 0; i < _instance.size; ++i)
+            {
+                _instance.bytes[i].store(0);
+                _instance.messages[i].store(0);
+            }
+        });
+        return _instance;
+    }
+
+    static call_site_map_t& get_call_sites()
+    {
+        static call_site_map_t _instance;
+        return _instance;
+    }
+
+    static std::mutex& get_call_site_mutex()
+    {
+        static std::mutex _instance;
+        return _instance;
+    }
+
+    // thread-local lookup so the mutex is only taken the first time a thread sees a
+    // call site
+    static call_site_ptr_t& get_call_site_cache()
+    {
+        static thread_local call_site_ptr_t _instance;
+        return _instance;
+    }
+
+    static rank_map_t& get_rank_map()
+    {
+        static thread_local rank_map_t _instance;
+        return _instance;
+    }
+
+    static hash_array_t& get_hash_array()
+    {
+        static auto _get = []() {
+            hash_array_t _instance;
+            for(uintmax_t i = 0; i < data_size; ++i)
+                _instance[i] = string_hash()(get_function_names()[i]);
+            return _instance;
+        };
+        static hash_array_t _instance = _get();
+        return _instance;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static uintmax_t get_bin(count_type _bytes)
+    {
+        if(_bytes == 0)
+            return 0;
+#    if defined(__GNUC__) || defined(__clang__)
+        uintmax_t _bin = 64 - __builtin_clzll(_bytes);
+#    else
+        uintmax_t _bin = 0;
+        while(_bytes > 0)
+        {
+            _bytes >>= 1;
+            ++_bin;
+        }
+#    endif
+        return (_bin < hist_size) ? _bin : (hist_size - 1);
+    }
+
+    static count_type get_bytes(int count, MPI_Datatype datatype)
+    {
+        int _size = 0;
+        MPI_Type_size(datatype, &_size);
+        return static_cast<count_type>(std::max(count, 0)) *
+               static_cast<count_type>(std::max(_size, 0));
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  rank, size, and MPI_COMM_WORLD ranks of "comm". The result is cached per
+    //  communicator so the group translation is done once instead of on every call,
+    //  this assumes communicator handles are not reused after being freed while
+    //  measurements are taken
+    //
+    static const comm_info& get_comm_info(MPI_Comm comm)
+    {
+        auto& _map = get_rank_map();
+        auto  itr  = _map.find(comm);
+        if(itr != _map.end())
+            return itr->second;
+
+        comm_info _info;
+        MPI_Comm_rank(comm, &_info.rank);
+        MPI_Comm_size(comm, &_info.size);
+        if(comm != MPI_COMM_WORLD)
+        {
+            std::vector<int> _local(_info.size);
+            for(int i = 0; i < _info.size; ++i)
+                _local[i] = i;
+            _info.world.resize(_info.size, MPI_UNDEFINED);
+            MPI_Group _comm_group;
+            MPI_Group _world_group;
+            MPI_Comm_group(comm, &_comm_group);
+            MPI_Comm_group(MPI_COMM_WORLD, &_world_group);
+            MPI_Group_translate_ranks(_comm_group, _info.size, _local.data(),
+                                      _world_group, _info.world.data());
+            MPI_Group_free(&_comm_group);
+            MPI_Group_free(&_world_group);
+        }
+        return _map.insert({ comm, std::move(_info) }).first->second;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  convert a rank in the communicator to the rank in MPI_COMM_WORLD
+    //
+    static int translate(const comm_info& _info, int _rank)
+    {
+        if(_info.world.empty() || _rank < 0)
+            return _rank;
+        return (_rank < static_cast<int>(_info.world.size())) ? _info.world[_rank]
+                                                               : MPI_UNDEFINED;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  the call-site hash is the rolling hash of the call-graph node of this
+    //  measurement and its ancestors (the same key storage uses to identify a node
+    //  across threads). Without a node, e.g. when storage is disabled, every call of
+    //  the function shares one call site
+    //
+    call_site& get_call_site(uintmax_t idx) const
+    {
+        uint64_t _hash = get_hash_array()[idx];
+        if(graph_itr)
+        {
+            _hash       = graph_itr->id();
+            auto _paren = graph_t::parent(graph_itr);
+            while(_paren && _paren->depth() > 0)
+            {
+                _hash += _paren->id();
+                _paren = graph_t::parent(_paren);
+            }
+        }
+
+        auto& _cache = get_call_site_cache();
+        auto  citr   = _cache.find(_hash);
+        if(citr != _cache.end())
+            return *citr->second;
+
+        std::unique_lock<std::mutex> _lk(get_call_site_mutex());
+        auto&                        _sites = get_call_sites();
+        auto                         sitr   = _sites.find(_hash);
+        if(sitr == _sites.end())
+        {
+            std::string _path = get_function_names()[idx];
+            if(graph_itr)
+            {
+                std::vector<std::string> _hierarchy;
+                auto                     _paren = graph_t::parent(graph_itr);
+                while(_paren && _paren->depth() > 0)
+                {
+                    _hierarchy.push_back(get_hash_identifier(_paren->id()));
+                    _paren = graph_t::parent(_paren);
+                }
+                std::reverse(_hierarchy.begin(), _hierarchy.end());
+                _hierarchy.push_back(_path);
+                _path = "";
+                for(const auto& itr : _hierarchy)
+                    _path += ((_path.empty()) ? "" : "/") + itr;
+            }
+            auto _site = std::unique_ptr<call_site>(new call_site(idx, _path));
+            sitr       = _sites.insert({ _hash, std::move(_site) }).first;
+        }
+        _cache.insert({ _hash, sitr->second.get() });
+        return *sitr->second;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    void add_message(uintmax_t idx, count_type _bytes)
+    {
+        value = static_cast<value_type>(_bytes);
+        get_call_site(idx).hist[get_bin(_bytes)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void add_peer(int _peer, count_type _bytes)
+    {
+        auto& _row = get_row();
+        if(_peer < 0 || _peer >= _row.size)
+            return;
+        _row.bytes[_peer].fetch_add(_bytes, std::memory_order_relaxed);
+        _row.messages[_peer].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void add_send(uintmax_t idx, int count, MPI_Datatype datatype, int dest,
+                  MPI_Comm comm)
+    {
+        if(idx >= data_size || dest == MPI_PROC_NULL)
+            return;
+        auto _bytes = get_bytes(count, datatype);
+        add_message(idx, _bytes);
+        add_peer(translate(get_comm_info(comm), dest), _bytes);
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  format (one line per entry):
+    //      # <label> <rank> <size>
+    //      bytes <rank> <bytes sent to rank 0> ... <bytes sent to rank N-1>
+    //      messages <rank> <messages sent to rank 0> ... <messages sent to rank N-1>
+    //      callsite <hash> <path of the call site>
+    //      histogram <function> <hash> <bin 0> ... <bin hist_size-1>
+    //
+    static void write_matrix()
+    {
+        if(!mpi::is_initialized())
+            return;
+
+        auto& _row  = get_row();
+        auto  _rank = mpi::rank();
+
+        auto fname = settings::compose_output_filename(label(), ".txt", true, &_rank);
+        std::ofstream ofs(fname.c_str());
+        if(!ofs)
+        {
+            fprintf(stderr, "[%s]> Error opening '%s'...\n", label().c_str(),
+                    fname.c_str());
+            return;
+        }
+
+        if(settings::verbose() > 0 || settings::debug())
+            printf("[%s]> Outputting '%s'...\n", label().c_str(), fname.c_str());
+
+        ofs << "# " << label() << " " << _rank << " " << _row.size << "\n";
+        ofs << "bytes " << _rank;
+        for(int32_t i = 0; i < _row.size; ++i)
+            ofs << " " << _row.bytes[i].load();
+        ofs << "\nmessages " << _rank;
+        for(int32_t i = 0; i < _row.size; ++i)
+            ofs << " " << _row.messages[i].load();
+        ofs << "\n";
+        std::unique_lock<std::mutex> _lk(get_call_site_mutex());
+        for(const auto& sitr : get_call_sites())
+        {
+            const auto& _site = *sitr.second;
+            ofs << "callsite " << sitr.first << " " << _site.path << "\n";
+            ofs << "histogram " << get_function_names()[_site.index] << " "
+                << sitr.first;
+            for(const auto& itr : _site.hist)
+                ofs << " " << itr.load();
+            ofs << "\n";
+        }
+    }
+
+private:
+    MPI_Status*  m_status   = nullptr;
+    MPI_Datatype m_datatype = MPI_DATATYPE_NULL;
+    uintmax_t    m_index    = 0;
+};
+
+}  // namespace component
+
+}  // namespace tim
+
+#endif
@@ -0,0 +1,376 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory/components/derived/numa_memory.hpp
+ * \headerfile timemory/components/derived/numa_memory.hpp
+ * "timemory/components/derived/numa_memory.hpp"
+ * Component which reports the NUMA placement of the process memory and of the
+ * calling thread. At start and stop, the resident bytes of the process on each NUMA
+ * node are summed from /proc/self/numa_maps (parsed in fixed-size chunks, without
+ * per-line allocations) and the node the thread runs on is queried with getcpu. A
+ * region records the change of the resident bytes per node, how often the thread was
+ * observed on each node and how often the thread ran on a different node than the
+ * one holding most of the memory. numa_maps requires a walk of the page tables by
+ * the kernel so this component is meant for coarse regions. On single-node machines
+ * numa_maps is not read and the component only records the node of the thread.
+ *
+ */
+
+#pragma once
+
+#include "timemory/bits/settings.hpp"
+#include "timemory/components/base.hpp"
+#include "timemory/components/types.hpp"
+#include "timemory/mpl/apply.hpp"
+#include "timemory/units.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(_LINUX)
+
+#    include <fcntl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+
+namespace tim
+{
+//
+// clang-format off
+namespace component { struct numa_memory; }
+// clang-format on
+//
+//======================================================================================//
+
+namespace trait
+{
+template <>
+struct is_memory_category<component::numa_memory> : std::true_type
+{};
+
+template <>
+struct uses_memory_units<component::numa_memory> : std::true_type
+{};
+
+template <>
+struct custom_unit_printing<component::numa_memory> : std::true_type
+{};
+
+}  // namespace trait
+
+namespace component
+{
+//--------------------------------------------------------------------------------------//
+/// \class numa_memory
+/// \brief NUMA placement: the value is { resident bytes per node..., observations of
+/// the thread per node..., observations on a node other than the memory majority }
+//
+struct numa_memory : public base<numa_memory, std::array<int64_t, 17>>
+{
+    /// max number of NUMA nodes which are distinguished
+    static constexpr size_t max_nodes = 8;
+
+    using value_type  = std::array<int64_t, 2 * max_nodes + 1>;
+    using base_type   = base<numa_memory, value_type>;
+    using this_type   = numa_memory;
+    using result_type = std::vector<double>;
+
+    /// index of the mismatch count in the value
+    static constexpr size_t mismatch_idx = 2 * max_nodes;
+
+    static std::string label() { return "numa_memory"; }
+    static std::string description() { return "NUMA memory placement"; }
+
+    static value_type record()
+    {
+        value_type _ret{};
+        if(get_num_nodes() > 1)
+            read_numa_maps(_ret);
+
+        // the observation is dropped when the node is not distinguished
+        auto _node = get_node();
+        if(_node >= max_nodes)
+            return _ret;
+        _ret[max_nodes + _node] = 1;
+        if(get_num_nodes() > 1 && _node != get_majority_node(_ret))
+            _ret[mismatch_idx] = 1;
+        return _ret;
+    }
+
+    /// number of online NUMA nodes (at least one)
+    static size_t get_num_nodes()
+    {
+        static size_t _instance = read_num_nodes();
+        return _instance;
+    }
+
+    /// node of the CPU the calling thread is running on (zero when it is unknown),
+    /// may be >= max_nodes
+    static size_t get_node()
+    {
+        unsigned _cpu  = 0;
+        unsigned _node = 0;
+        if(syscall(SYS_getcpu, &_cpu, &_node, nullptr) != 0)
+            _node = 0;
+        if(_node >= max_nodes)
+            warn_untracked_node(_node);
+        return _node;
+    }
+
+    /// node holding the most resident bytes in the value
+    static size_t get_majority_node(const value_type& _val)
+    {
+        size_t _ret = 0;
+        for(size_t i = 1; i < max_nodes; ++i)
+            if(_val[i] > _val[_ret])
+                _ret = i;
+        return _ret;
+    }
+
+    std::string get_display() const
+    {
+        std::stringstream ss;
+        auto              _prec  = base_type::get_precision();
+        auto              _width = base_type::get_width();
+        auto              _flags = base_type::get_format_flags();
+        auto              _disp  = base_type::get_display_unit();
+        auto&             val    = (is_transient) ? accum : value;
+        auto              _bytes = get();
+
+        ss.setf(_flags);
+        if(get_num_nodes() > 1)
+        {
+            for(size_t i = 0; i < _bytes.size(); ++i)
+            {
+                ss << "node " << i << " = " << std::setw(_width)
+                   << std::setprecision(_prec) << _bytes[i];
+                if(!_disp.empty())
+                    ss << " " << _disp;
+                ss << ", ";
+            }
+        }
+        ss << "ran on node " << get_run_node() << ", memory grew most on node "
+           << get_memory_node() << ", " << val[mismatch_idx] << " mismatch(es)";
+        return ss.str();
+    }
+
+    /// change of the resident memory on each node
+    result_type get() const
+    {
+        auto&       val    = (is_transient) ? accum : value;
+        auto        _nodes = (get_num_nodes() < max_nodes) ? get_num_nodes() : max_nodes;
+        result_type _ret((_nodes > 1) ? _nodes : 0);
+        for(size_t i = 0; i < _ret.size(); ++i)
+            _ret[i] = static_cast<double>(val[i]) / base_type::get_unit();
+        return _ret;
+    }
+
+    /// node the thread was observed on most often
+    size_t get_run_node() const
+    {
+        auto&  val  = (is_transient) ? accum : value;
+        size_t _ret = 0;
+        for(size_t i = 1; i < max_nodes; ++i)
+            if(val[max_nodes + i] > val[max_nodes + _ret])
+                _ret = i;
+        return _ret;
+    }
+
+    /// node with the largest change of the resident memory
+    size_t get_memory_node() const
+    {
+        return get_majority_node((is_transient) ? accum : value);
+    }
+
+    /// number of observations where the thread and the memory were on different nodes
+    int64_t get_mismatches() const
+    {
+        return ((is_transient) ? accum : value)[mismatch_idx];
+    }
+
+    void start()
+    {
+        set_started();
+        value = record();
+    }
+
+    void stop()
+    {
+        auto tmp = record();
+        for(size_t i = 0; i < max_nodes; ++i)
+            accum[i] += (tmp[i] - value[i]);
+        for(size_t i = max_nodes; i < tmp.size(); ++i)
+            accum[i] += (tmp[i] + value[i]);
+        value = std::move(tmp);
+        set_stopped();
+    }
+
+    //----------------------------------------------------------------------------------//
+    // serialization
+    //
+    template <typename Archive>
+    void serialize(Archive& ar, const unsigned int)
+    {
+        auto _data        = get();
+        auto _run_node    = get_run_node();
+        auto _memory_node = get_memory_node();
+        auto _mismatches  = get_mismatches();
+        ar(serializer::make_nvp("is_transient", is_transient),
+           serializer::make_nvp("laps", laps), serializer::make_nvp("repr_data", _data),
+           serializer::make_nvp("value", value), serializer::make_nvp("accum", accum),
+           serializer::make_nvp("run_node", _run_node),
+           serializer::make_nvp("memory_node", _memory_node),
+           serializer::make_nvp("mismatches", _mismatches));
+    }
+
+private:
+    //----------------------------------------------------------------------------------//
+    //  only the first max_nodes nodes are distinguished, the CPUs and pages of the other
+    //  nodes are not counted
+    //
+    static void warn_untracked_node(size_t _node)
+    {
+        static std::atomic<bool> _warned(false);
+        if(!_warned.exchange(true))
+            fprintf(stderr,
+                    "[%s]> Warning! NUMA node %lu is not distinguished (max: %lu nodes), "
+                    "its CPUs and pages are not counted\n",
+                    label().c_str(), (unsigned long) _node, (unsigned long) max_nodes);
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  /sys/devices/system/node/online is a list of ranges, e.g. "0-1" or "0,2-3"
+    //
+    static size_t read_num_nodes()
+    {
+        std::ifstream ifs("/sys/devices/system/node/online");
+        std::string   _line;
+        if(!ifs || !std::getline(ifs, _line))
+            return 1;
+
+        size_t      _ret = 0;
+        const char* _pos = _line.c_str();
+        while(*_pos != '\0')
+        {
+            char* _end   = nullptr;
+            long  _first = strtol(_pos, &_end, 10);
+            if(_end == _pos)
+                break;
+            long _last = _first;
+            if(*_end == '-')
+            {
+                _pos  = _end + 1;
+                _last = strtol(_pos, &_end, 10);
+            }
+            _ret += static_cast<size_t>(_last - _first + 1);
+            _pos = (*_end == ',') ? _end + 1 : _end;
+            if(*_end != ',')
+                break;
+        }
+        return (_ret > 0) ? _ret : 1;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  each mapping is a line with N<node>=<pages> and kernelpagesize_kB=<size> tokens.
+    //  The file is read in chunks and tokens split between chunks are carried over
+    //
+    static void read_numa_maps(value_type& _ret,
+                               const char* _fname = "/proc/self/numa_maps")
+    {
+        int _fd = ::open(_fname, O_RDONLY | O_CLOEXEC);
+        if(_fd < 0)
+            return;
+
+        std::array<int64_t, max_nodes> _pages{};
+        char                           _token[64];
+        size_t                         _len = 0;
+        char                           _buffer[16384];
+        int64_t                        _page_size = 4;
+
+        auto _process_token = [&]() {
+            _token[_len] = '\0';
+            if(_len > 1 && _token[0] == 'N' && _token[1] >= '0' && _token[1] <= '9')
+            {
+                char* _end  = nullptr;
+                auto  _node = strtoul(_token + 1, &_end, 10);
+                if(*_end == '=' && _node < max_nodes)
+                    _pages[_node] += strtoll(_end + 1, nullptr, 10);
+                else if(*_end == '=')
+                    warn_untracked_node(_node);
+            }
+            else if(_len > 18 && strncmp(_token, "kernelpagesize_kB=", 18) == 0)
+            {
+                _page_size = strtoll(_token + 18, nullptr, 10);
+            }
+            _len = 0;
+        };
+
+        auto _process_line = [&]() {
+            for(size_t i = 0; i < max_nodes; ++i)
+                _ret[i] += _pages[i] * _page_size * units::KiB;
+            _pages.fill(0);
+            _page_size = 4;
+        };
+
+        ssize_t _n = 0;
+        while((_n = ::read(_fd, _buffer, sizeof(_buffer))) > 0)
+        {
+            for(ssize_t i = 0; i < _n; ++i)
+            {
+                char _c = _buffer[i];
+                if(_c == ' ' || _c == '\n')
+                {
+                    if(_len > 0)
+                        _process_token();
+                    if(_c == '\n')
+                        _process_line();
+                }
+                else if(_len + 1 < sizeof(_token))
+                {
+                    _token[_len++] = _c;
+                }
+            }
+        }
+        if(_len > 0)
+            _process_token();
+        _process_line();
+        ::close(_fd);
+    }
+};
+
+}  // namespace component
+
+}  // namespace tim
+
+#endif
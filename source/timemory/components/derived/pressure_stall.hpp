@@ -0,0 +1,422 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory/components/derived/pressure_stall.hpp
+ * \headerfile timemory/components/derived/pressure_stall.hpp
+ * "timemory/components/derived/pressure_stall.hpp"
+ * Components which report the resource throttling a region was exposed to:
+ *
+ *  - pressure_stall: the "some" and "full" stall totals of the cpu, memory and io
+ *    pressure-stall information files (settings::pressure_root(), /proc/pressure)
+ *  - cgroup_throttle: the CPU bandwidth throttling from cpu.stat and the memory
+ *    events from memory.events of the cgroup v2 directory (settings::cgroup_root(),
+ *    by default the cgroup of the process under /sys/fs/cgroup)
+ *
+ * The files are opened once per process and re-read with pread. Missing files (older
+ * kernels, cgroup v1) report zero. After changing the settings, reset() re-opens the
+ * files from the new location.
+ *
+ */
+
+#pragma once
+
+#include "timemory/bits/settings.hpp"
+#include "timemory/components/base.hpp"
+#include "timemory/components/types.hpp"
+#include "timemory/mpl/apply.hpp"
+#include "timemory/units.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(_LINUX)
+
+#    include <fcntl.h>
+#    include <unistd.h>
+
+namespace tim
+{
+//
+// clang-format off
+namespace component { struct pressure_stall; struct cgroup_throttle; }
+// clang-format on
+//
+//======================================================================================//
+
+namespace trait
+{
+template <>
+struct is_timing_category<component::pressure_stall> : std::true_type
+{};
+
+template <>
+struct uses_timing_units<component::pressure_stall> : std::true_type
+{};
+
+template <>
+struct custom_unit_printing<component::pressure_stall> : std::true_type
+{};
+
+template <>
+struct is_timing_category<component::cgroup_throttle> : std::true_type
+{};
+
+template <>
+struct uses_timing_units<component::cgroup_throttle> : std::true_type
+{};
+
+template <>
+struct custom_unit_printing<component::cgroup_throttle> : std::true_type
+{};
+
+}  // namespace trait
+
+namespace details
+{
+//--------------------------------------------------------------------------------------//
+//  a set of files which are opened once and re-read with pread
+//
+template <size_t _N>
+struct stat_files
+{
+    using fd_array_t = std::array<int, _N>;
+
+    template <typename _Func>
+    const fd_array_t& get(_Func&& _get_paths)
+    {
+        if(!m_ready.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> _lk(m_mutex);
+            if(!m_ready.load(std::memory_order_relaxed))
+            {
+                auto _paths = _get_paths();
+                for(size_t i = 0; i < _N; ++i)
+                    m_fds[i] = ::open(_paths[i].c_str(), O_RDONLY | O_CLOEXEC);
+                m_ready.store(true, std::memory_order_release);
+            }
+        }
+        return m_fds;
+    }
+
+    // not thread-safe w.r.t. concurrent measurements
+    void reset()
+    {
+        std::lock_guard<std::mutex> _lk(m_mutex);
+        if(m_ready.load(std::memory_order_relaxed))
+        {
+            for(auto& itr : m_fds)
+            {
+                if(itr >= 0)
+                    ::close(itr);
+                itr = -1;
+            }
+        }
+        m_ready.store(false, std::memory_order_release);
+    }
+
+private:
+    std::atomic<bool> m_ready{ false };
+    std::mutex        m_mutex;
+    fd_array_t        m_fds;
+};
+
+//--------------------------------------------------------------------------------------//
+//  reads the entire (small) file into the buffer, returns false on failure
+//
+template <size_t _N>
+inline bool
+read_stat_file(int _fd, char (&_buffer)[_N])
+{
+    if(_fd < 0)
+        return false;
+    auto _n = pread(_fd, _buffer, _N - 1, 0);
+    if(_n <= 0)
+        return false;
+    _buffer[_n] = '\0';
+    return true;
+}
+
+//--------------------------------------------------------------------------------------//
+//  value of "<key> <value>" or "<key>=<value>" in the buffer (zero if missing)
+//
+inline int64_t
+read_stat_value(const char* _buffer, const char* _key)
+{
+    auto        _len = strlen(_key);
+    const char* _pos = _buffer;
+    while((_pos = strstr(_pos, _key)) != nullptr)
+    {
+        bool _start = (_pos == _buffer || _pos[-1] == ' ' || _pos[-1] == '\n');
+        char _delim = _pos[_len];
+        if(_start && (_delim == ' ' || _delim == '='))
+            return static_cast<int64_t>(strtoll(_pos + _len + 1, nullptr, 10));
+        _pos += _len;
+    }
+    return 0;
+}
+
+}  // namespace details
+
+namespace component
+{
+//--------------------------------------------------------------------------------------//
+/// \class pressure_stall
+/// \brief time (usec) in which some or all of the runnable tasks were stalled on the
+/// cpu, memory or io. The value is { cpu some, cpu full, memory some, memory full,
+/// io some, io full }
+//
+struct pressure_stall : public base<pressure_stall, std::array<int64_t, 6>>
+{
+    using ratio_t     = std::micro;
+    using value_type  = std::array<int64_t, 6>;
+    using base_type   = base<pressure_stall, value_type>;
+    using this_type   = pressure_stall;
+    using result_type = std::vector<double>;
+    using files_type  = details::stat_files<3>;
+
+    static std::string label() { return "pressure_stall"; }
+    static std::string description() { return "cpu, memory and io pressure stalls"; }
+
+    static value_type record()
+    {
+        value_type _ret{};
+        auto&      _fds = get_files().get(&get_paths);
+        char       _buffer[512];
+        for(size_t i = 0; i < _fds.size(); ++i)
+        {
+            if(!details::read_stat_file(_fds[i], _buffer))
+                continue;
+            // "some avg10=... total=<usec>\nfull avg10=... total=<usec>"
+            auto* _full     = strstr(_buffer, "full");
+            _ret[2 * i + 1] = (_full) ? details::read_stat_value(_full, "total") : 0;
+            if(_full)
+                *_full = '\0';
+            _ret[2 * i] = details::read_stat_value(_buffer, "total");
+        }
+        return _ret;
+    }
+
+    static std::array<std::string, 3> get_paths()
+    {
+        auto _root = settings::pressure_root();
+        return std::array<std::string, 3>{
+            { _root + "/cpu", _root + "/memory", _root + "/io" }
+        };
+    }
+
+    /// re-open the files, e.g. after changing settings::pressure_root()
+    static void reset() { get_files().reset(); }
+
+    std::string get_display() const
+    {
+        static const char* _labels[] = { "cpu",    "cpu (full)", "memory",
+                                         "memory (full)", "io", "io (full)" };
+
+        std::stringstream ss;
+        auto              _prec  = base_type::get_precision();
+        auto              _width = base_type::get_width();
+        auto              _flags = base_type::get_format_flags();
+        auto              _disp  = base_type::get_display_unit();
+        auto              _val   = get();
+
+        ss.setf(_flags);
+        for(size_t i = 0; i < _val.size(); ++i)
+        {
+            if(i > 0)
+                ss << ", ";
+            ss << std::setw(_width) << std::setprecision(_prec) << _val[i];
+            if(!_disp.empty())
+                ss << " " << _disp;
+            ss << " " << _labels[i];
+        }
+        return ss.str();
+    }
+
+    result_type get() const
+    {
+        auto&       val = (is_transient) ? accum : value;
+        result_type _ret(val.size(), 0.0);
+        for(size_t i = 0; i < val.size(); ++i)
+            _ret[i] = static_cast<double>(val[i]) / ratio_t::den * base_type::get_unit();
+        return _ret;
+    }
+
+    void start()
+    {
+        set_started();
+        value = record();
+    }
+
+    void stop()
+    {
+        auto tmp = record();
+        for(size_t i = 0; i < tmp.size(); ++i)
+            accum[i] += (tmp[i] - value[i]);
+        value = std::move(tmp);
+        set_stopped();
+    }
+
+private:
+    static files_type& get_files()
+    {
+        static files_type* _instance = new files_type();
+        return *_instance;
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+/// \class cgroup_throttle
+/// \brief CPU bandwidth throttling and memory events of the cgroup. The value is
+/// { throttled time (usec), periods, throttled periods, memory low, memory high,
+/// memory max, oom, oom_kill }
+//
+struct cgroup_throttle : public base<cgroup_throttle, std::array<int64_t, 8>>
+{
+    using ratio_t    = std::micro;
+    using value_type = std::array<int64_t, 8>;
+    using base_type  = base<cgroup_throttle, value_type>;
+    using this_type  = cgroup_throttle;
+    using files_type = details::stat_files<2>;
+
+    static std::string label() { return "cgroup_throttle"; }
+    static std::string description() { return "cgroup cpu throttling and memory events"; }
+
+    static value_type record()
+    {
+        value_type _ret{};
+        auto&      _fds = get_files().get(&get_paths);
+        char       _buffer[2048];
+        if(details::read_stat_file(_fds[0], _buffer))
+        {
+            _ret[0] = details::read_stat_value(_buffer, "throttled_usec");
+            _ret[1] = details::read_stat_value(_buffer, "nr_periods");
+            _ret[2] = details::read_stat_value(_buffer, "nr_throttled");
+        }
+        if(details::read_stat_file(_fds[1], _buffer))
+        {
+            _ret[3] = details::read_stat_value(_buffer, "low");
+            _ret[4] = details::read_stat_value(_buffer, "high");
+            _ret[5] = details::read_stat_value(_buffer, "max");
+            _ret[6] = details::read_stat_value(_buffer, "oom");
+            _ret[7] = details::read_stat_value(_buffer, "oom_kill");
+        }
+        return _ret;
+    }
+
+    /// settings::cgroup_root() or the cgroup v2 directory of the process
+    static std::string get_root()
+    {
+        if(!settings::cgroup_root().empty())
+            return settings::cgroup_root();
+
+        // the unified hierarchy entry is "0::<path>"
+        std::ifstream ifs("/proc/self/cgroup");
+        std::string   _line;
+        while(ifs && std::getline(ifs, _line))
+        {
+            if(_line.find("0::") == 0)
+                return "/sys/fs/cgroup" + _line.substr(3);
+        }
+        return "/sys/fs/cgroup";
+    }
+
+    static std::array<std::string, 2> get_paths()
+    {
+        auto _root = get_root();
+        return std::array<std::string, 2>{ { _root + "/cpu.stat",
+                                             _root + "/memory.events" } };
+    }
+
+    /// re-open the files, e.g. after changing settings::cgroup_root()
+    static void reset() { get_files().reset(); }
+
+    std::string get_display() const
+    {
+        std::stringstream ss;
+        auto              _prec  = base_type::get_precision();
+        auto              _width = base_type::get_width();
+        auto              _flags = base_type::get_format_flags();
+        auto              _disp  = base_type::get_display_unit();
+        auto&             val    = (is_transient) ? accum : value;
+
+        ss.setf(_flags);
+        ss << std::setw(_width) << std::setprecision(_prec) << get();
+        if(!_disp.empty())
+            ss << " " << _disp;
+        ss << " throttled (" << val[2] << "/" << val[1] << " periods), memory events: "
+           << "low = " << val[3] << ", high = " << val[4] << ", max = " << val[5]
+           << ", oom = " << val[6] << ", oom_kill = " << val[7];
+        return ss.str();
+    }
+
+    /// throttled time
+    double get() const
+    {
+        auto& val = (is_transient) ? accum : value;
+        return static_cast<double>(val[0]) / ratio_t::den * base_type::get_unit();
+    }
+
+    int64_t get_throttled_periods() const { return ((is_transient) ? accum : value)[2]; }
+    int64_t get_memory_high() const { return ((is_transient) ? accum : value)[4]; }
+    int64_t get_memory_max() const { return ((is_transient) ? accum : value)[5]; }
+    int64_t get_oom_kill() const { return ((is_transient) ? accum : value)[7]; }
+
+    void start()
+    {
+        set_started();
+        value = record();
+    }
+
+    void stop()
+    {
+        auto tmp = record();
+        for(size_t i = 0; i < tmp.size(); ++i)
+            accum[i] += (tmp[i] - value[i]);
+        value = std::move(tmp);
+        set_stopped();
+    }
+
+private:
+    static files_type& get_files()
+    {
+        static files_type* _instance = new files_type();
+        return *_instance;
+    }
+};
+
+}  // namespace component
+
+}  // namespace tim
+
+#endif
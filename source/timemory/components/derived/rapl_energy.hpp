@@ -0,0 +1,351 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory/components/derived/rapl_energy.hpp
+ * \headerfile timemory/components/derived/rapl_energy.hpp
+ * "timemory/components/derived/rapl_energy.hpp"
+ * Component which measures the energy consumed by the RAPL domains (package, core,
+ * uncore, dram, ...) through the powercap sysfs interface. The intel-rapl:* zones
+ * under settings::rapl_root() (/sys/class/powercap) are discovered once per process
+ * and energy_uj is re-read with pread. The counters wrap at max_energy_range_uj, a
+ * single wrap between start and stop is corrected. When no zone is readable (no RAPL
+ * or energy_uj is only readable by root) is_available() returns false and the
+ * energy is zero.
+ *
+ */
+
+#pragma once
+
+#include "timemory/bits/settings.hpp"
+#include "timemory/components/base.hpp"
+#include "timemory/components/timing.hpp"
+#include "timemory/components/types.hpp"
+#include "timemory/mpl/apply.hpp"
+#include "timemory/units.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#if defined(_LINUX)
+
+#    include <dirent.h>
+#    include <fcntl.h>
+#    include <unistd.h>
+
+namespace tim
+{
+//
+// clang-format off
+namespace component { struct rapl_energy; }
+// clang-format on
+//
+//======================================================================================//
+
+namespace trait
+{
+template <>
+struct custom_unit_printing<component::rapl_energy> : std::true_type
+{};
+
+}  // namespace trait
+
+namespace component
+{
+//--------------------------------------------------------------------------------------//
+/// \class rapl_energy
+/// \brief energy (uJ) of each RAPL domain and the elapsed time (nsec), i.e.
+/// { domain 0, ..., domain N-1, ..., time }
+//
+struct rapl_energy : public base<rapl_energy, std::array<int64_t, 17>>
+{
+    /// max number of RAPL domains which are measured
+    static constexpr size_t max_domains = 16;
+
+    using ratio_t     = std::nano;
+    using value_type  = std::array<int64_t, max_domains + 1>;
+    using base_type   = base<rapl_energy, value_type>;
+    using this_type   = rapl_energy;
+    using result_type = std::vector<double>;
+
+    /// a powercap zone, e.g. "package-0" or "package-0/dram"
+    struct domain
+    {
+        std::string label;
+        int         fd;
+        int64_t     max_range;
+    };
+
+    using domain_list_t = std::vector<domain>;
+
+    static std::string label() { return "rapl_energy"; }
+    static std::string description() { return "RAPL energy consumption"; }
+
+    static value_type record()
+    {
+        value_type  _ret{};
+        const auto& _domains = get_domains();
+        char        _buffer[32];
+        for(size_t i = 0; i < _domains.size(); ++i)
+        {
+            auto _n = pread(_domains[i].fd, _buffer, sizeof(_buffer) - 1, 0);
+            if(_n <= 0)
+                continue;
+            _buffer[_n] = '\0';
+            _ret[i]     = static_cast<int64_t>(strtoll(_buffer, nullptr, 10));
+        }
+        _ret[max_domains] = tim::get_clock_real_now<int64_t, ratio_t>();
+        return _ret;
+    }
+
+    /// whether any RAPL domain could be opened
+    static bool is_available() { return !get_domains().empty(); }
+
+    /// the discovered domains, in the order of the values
+    static const domain_list_t& get_domains()
+    {
+        auto& _table = get_domain_table();
+        if(!_table.ready.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> _lk(_table.mutex);
+            if(!_table.ready.load(std::memory_order_relaxed))
+            {
+                _table.domains = discover(settings::rapl_root());
+                _table.ready.store(true, std::memory_order_release);
+            }
+        }
+        return _table.domains;
+    }
+
+    /// re-discover the domains, e.g. after changing settings::rapl_root()
+    static void reset()
+    {
+        auto&                       _table = get_domain_table();
+        std::lock_guard<std::mutex> _lk(_table.mutex);
+        for(auto& itr : _table.domains)
+            ::close(itr.fd);
+        _table.domains.clear();
+        _table.ready.store(false, std::memory_order_release);
+    }
+
+    std::string get_display() const
+    {
+        std::stringstream ss;
+        auto              _prec    = base_type::get_precision();
+        auto              _width   = base_type::get_width();
+        auto              _flags   = base_type::get_format_flags();
+        const auto&       _domains = get_domains();
+        auto              _joules  = get();
+        auto              _watts   = get_watts();
+
+        if(_domains.empty())
+            return "n/a";
+
+        ss.setf(_flags);
+        for(size_t i = 0; i < _domains.size(); ++i)
+        {
+            if(i > 0)
+                ss << ", ";
+            ss << std::setw(_width) << std::setprecision(_prec) << _joules.at(i) << " J ("
+               << std::setprecision(_prec) << _watts.at(i) << " W) "
+               << _domains.at(i).label;
+        }
+        return ss.str();
+    }
+
+    /// energy in joules of each domain
+    result_type get() const
+    {
+        auto&       val = (is_transient) ? accum : value;
+        result_type _ret(get_domains().size(), 0.0);
+        for(size_t i = 0; i < _ret.size(); ++i)
+            _ret[i] = static_cast<double>(val[i]) / std::micro::den;
+        return _ret;
+    }
+
+    /// average power in watts of each domain
+    result_type get_watts() const
+    {
+        auto& val   = (is_transient) ? accum : value;
+        auto  _ret  = get();
+        auto  delta = static_cast<double>(val[max_domains]) / ratio_t::den;
+        for(auto& itr : _ret)
+        {
+            itr /= delta;
+            if(!std::isfinite(itr))
+                itr = 0.0;
+        }
+        return _ret;
+    }
+
+    void start()
+    {
+        set_started();
+        value = record();
+    }
+
+    void stop()
+    {
+        auto        tmp      = record();
+        const auto& _domains = get_domains();
+        for(size_t i = 0; i < _domains.size(); ++i)
+        {
+            auto _delta = tmp[i] - value[i];
+            if(_delta < 0)
+                _delta += _domains[i].max_range;
+            accum[i] += _delta;
+        }
+        accum[max_domains] += tmp[max_domains] - value[max_domains];
+        value = std::move(tmp);
+        set_stopped();
+    }
+
+    //----------------------------------------------------------------------------------//
+    // serialization
+    //
+    template <typename Archive>
+    void serialize(Archive& ar, const unsigned int)
+    {
+        auto                     _data  = get();
+        auto                     _watts = get_watts();
+        std::vector<std::string> _labels;
+        for(const auto& itr : get_domains())
+            _labels.push_back(itr.label);
+        ar(serializer::make_nvp("is_transient", is_transient),
+           serializer::make_nvp("laps", laps), serializer::make_nvp("repr_data", _data),
+           serializer::make_nvp("value", value), serializer::make_nvp("accum", accum),
+           serializer::make_nvp("watts", _watts),
+           serializer::make_nvp("domains", _labels));
+    }
+
+private:
+    struct domain_table
+    {
+        std::atomic<bool> ready{ false };
+        std::mutex        mutex;
+        domain_list_t     domains;
+    };
+
+    static domain_table& get_domain_table()
+    {
+        static domain_table* _instance = new domain_table();
+        return *_instance;
+    }
+
+    static std::string read_line(const std::string& _fname)
+    {
+        std::ifstream ifs(_fname);
+        std::string   _line;
+        if(ifs)
+            std::getline(ifs, _line);
+        return _line;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  zones are named intel-rapl:<package>[:<subzone>], the label of a subzone is
+    //  prefixed with the name of its package
+    //
+    static domain_list_t discover(const std::string& _root)
+    {
+        static const std::string _prefix = "intel-rapl:";
+
+        std::vector<std::string> _zones;
+        if(DIR* _dir = opendir(_root.c_str()))
+        {
+            while(struct dirent* _entry = readdir(_dir))
+            {
+                std::string _name = _entry->d_name;
+                if(_name.find(_prefix) == 0)
+                    _zones.push_back(_name);
+            }
+            closedir(_dir);
+        }
+        // order by package, then by subzone: a lexicographic order would put
+        // "intel-rapl:10" before "intel-rapl:2". A package precedes its subzones
+        using zone_index_t = std::tuple<long, long, const std::string&>;
+        auto _index        = [](const std::string& _zone) -> zone_index_t {
+            char* _end     = nullptr;
+            long  _package = strtol(_zone.c_str() + _prefix.length(), &_end, 10);
+            long  _subzone = (*_end == ':') ? strtol(_end + 1, nullptr, 10) : -1;
+            return zone_index_t(_package, _subzone, _zone);
+        };
+        std::sort(_zones.begin(), _zones.end(),
+                  [&_index](const std::string& lhs, const std::string& rhs) {
+                      return _index(lhs) < _index(rhs);
+                  });
+
+        domain_list_t _domains;
+        for(const auto& itr : _zones)
+        {
+            if(_domains.size() == max_domains)
+                break;
+
+            auto _path  = _root + "/" + itr;
+            auto _label = read_line(_path + "/name");
+            auto _range = read_line(_path + "/max_energy_range_uj");
+            if(_label.empty())
+                _label = itr;
+
+            auto _sub = itr.find(':', _prefix.length());
+            if(_sub != std::string::npos)
+            {
+                auto _parent = read_line(_root + "/" + itr.substr(0, _sub) + "/name");
+                if(!_parent.empty())
+                    _label = _parent + "/" + _label;
+            }
+
+            int _fd = ::open((_path + "/energy_uj").c_str(), O_RDONLY | O_CLOEXEC);
+            if(_fd < 0)
+                continue;
+
+            char _buffer[32];
+            if(pread(_fd, _buffer, sizeof(_buffer) - 1, 0) <= 0)
+            {
+                ::close(_fd);
+                continue;
+            }
+
+            auto _max_range = static_cast<int64_t>(strtoll(_range.c_str(), nullptr, 10));
+            _domains.push_back(domain{ _label, _fd, _max_range });
+        }
+        return _domains;
+    }
+};
+
+}  // namespace component
+
+}  // namespace tim
+
+#endif
@@ -0,0 +1,306 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory/components/derived/sched_delay.hpp
+ * \headerfile timemory/components/derived/sched_delay.hpp
+ * "timemory/components/derived/sched_delay.hpp"
+ * Components which measure the time a thread spent runnable but waiting for a core,
+ * i.e. the run-queue delay reported by the scheduler in
+ * /proc/self/task/<tid>/schedstat. Each thread keeps the file open and re-reads it
+ * with pread so a measurement is a single system call. The oversubscription component
+ * combines the run-queue delay with the voluntary and involuntary (priority) context
+ * switches. Requires a kernel with CONFIG_SCHED_INFO; otherwise the values are zero.
+ *
+ */
+
+#pragma once
+
+#include "timemory/bits/settings.hpp"
+#include "timemory/components/base.hpp"
+#include "timemory/components/rusage.hpp"
+#include "timemory/components/types.hpp"
+#include "timemory/mpl/apply.hpp"
+#include "timemory/units.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#if defined(_LINUX)
+
+#    include <fcntl.h>
+#    include <pthread.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+
+namespace tim
+{
+//
+// clang-format off
+namespace component { struct sched_delay; struct oversubscription; }
+// clang-format on
+//
+//======================================================================================//
+
+namespace trait
+{
+template <>
+struct is_timing_category<component::sched_delay> : std::true_type
+{};
+
+template <>
+struct uses_timing_units<component::sched_delay> : std::true_type
+{};
+
+template <>
+struct uses_percent_units<component::oversubscription> : std::true_type
+{};
+
+template <>
+struct custom_unit_printing<component::oversubscription> : std::true_type
+{};
+
+}  // namespace trait
+
+namespace component
+{
+//--------------------------------------------------------------------------------------//
+/// \class sched_delay
+/// \brief time the calling thread spent in the run-queue waiting to be scheduled. The
+/// value is { run time (nsec), run delay (nsec), timeslices }
+//
+struct sched_delay : public base<sched_delay, std::array<int64_t, 3>>
+{
+    using ratio_t    = std::nano;
+    using value_type = std::array<int64_t, 3>;
+    using base_type  = base<sched_delay, value_type>;
+    using this_type  = sched_delay;
+
+    static std::string label() { return "sched_delay"; }
+    static std::string description() { return "scheduler run-queue delay"; }
+
+    static value_type record()
+    {
+        value_type _ret{ { 0, 0, 0 } };
+
+        auto& _file = get_schedstat_file();
+        if(_file.generation != get_generation().load(std::memory_order_relaxed))
+            _file.open();
+        if(_file.fd < 0)
+            return _ret;
+
+        char _buffer[96];
+        auto _n = pread(_file.fd, _buffer, sizeof(_buffer) - 1, 0);
+        if(_n <= 0)
+            return _ret;
+        _buffer[_n] = '\0';
+
+        // "<run time> <run delay> <timeslices>"
+        char* _pos = _buffer;
+        for(auto& itr : _ret)
+        {
+            char* _end = nullptr;
+            itr        = static_cast<int64_t>(strtoll(_pos, &_end, 10));
+            if(_end == _pos)
+                break;
+            _pos = _end;
+        }
+        return _ret;
+    }
+
+    double get_display() const { return get(); }
+
+    /// run-queue delay
+    double get() const
+    {
+        auto& val = (is_transient) ? accum : value;
+        return static_cast<double>(val[1]) / ratio_t::den * base_type::get_unit();
+    }
+
+    int64_t get_run_time() const { return ((is_transient) ? accum : value)[0]; }
+    int64_t get_run_delay() const { return ((is_transient) ? accum : value)[1]; }
+    int64_t get_timeslices() const { return ((is_transient) ? accum : value)[2]; }
+
+    void start()
+    {
+        set_started();
+        value = record();
+    }
+
+    void stop()
+    {
+        auto tmp = record();
+        for(size_t i = 0; i < tmp.size(); ++i)
+            accum[i] += (tmp[i] - value[i]);
+        value = std::move(tmp);
+        set_stopped();
+    }
+
+    //----------------------------------------------------------------------------------//
+    // serialization
+    //
+    template <typename Archive>
+    void serialize(Archive& ar, const unsigned int)
+    {
+        auto _data       = get();
+        auto _run_time   = get_run_time();
+        auto _timeslices = get_timeslices();
+        ar(serializer::make_nvp("is_transient", is_transient),
+           serializer::make_nvp("laps", laps), serializer::make_nvp("repr_data", _data),
+           serializer::make_nvp("value", value), serializer::make_nvp("accum", accum),
+           serializer::make_nvp("run_time", _run_time),
+           serializer::make_nvp("timeslices", _timeslices));
+    }
+
+private:
+    //----------------------------------------------------------------------------------//
+    //  the per-thread schedstat file is opened once and closed when the thread exits.
+    //  A fork increments the generation so the child re-opens the file of its own
+    //  thread instead of reading the parent's
+    //
+    struct schedstat_file
+    {
+        int     fd         = -1;
+        int64_t generation = -1;
+
+        ~schedstat_file() { close_fd(); }
+
+        void open()
+        {
+            close_fd();
+            generation = get_generation().load(std::memory_order_relaxed);
+            std::stringstream ss;
+            ss << "/proc/self/task/" << static_cast<long>(syscall(SYS_gettid))
+               << "/schedstat";
+            fd = ::open(ss.str().c_str(), O_RDONLY | O_CLOEXEC);
+        }
+
+        void close_fd()
+        {
+            if(fd >= 0)
+                ::close(fd);
+            fd = -1;
+        }
+    };
+
+    static std::atomic<int64_t>& get_generation()
+    {
+        static std::atomic<int64_t>* _instance = []() {
+            auto* _generation = new std::atomic<int64_t>(0);
+            pthread_atfork(nullptr, nullptr, []() { get_generation()++; });
+            return _generation;
+        }();
+        return *_instance;
+    }
+
+    static schedstat_file& get_schedstat_file()
+    {
+        static thread_local schedstat_file _instance;
+        return _instance;
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+/// \class oversubscription
+/// \brief percentage of the runnable time spent waiting for a core together with the
+/// context switches: many involuntary (priority) switches and a high run-queue delay
+/// indicate more runnable threads than cores. The value is
+/// { run time (nsec), run delay (nsec), timeslices, voluntary, involuntary }
+//
+struct oversubscription : public base<oversubscription, std::array<int64_t, 5>>
+{
+    using ratio_t    = std::nano;
+    using value_type = std::array<int64_t, 5>;
+    using base_type  = base<oversubscription, value_type>;
+    using this_type  = oversubscription;
+
+    static std::string label() { return "oversubscription"; }
+    static std::string description()
+    {
+        return "run-queue delay relative to runnable time and context switches";
+    }
+
+    static value_type record()
+    {
+        auto _sched = sched_delay::record();
+        return value_type{ { _sched[0], _sched[1], _sched[2],
+                             voluntary_context_switch::record(),
+                             priority_context_switch::record() } };
+    }
+
+    std::string get_display() const
+    {
+        std::stringstream ss;
+        auto              _prec  = base_type::get_precision();
+        auto              _width = base_type::get_width();
+        auto              _flags = base_type::get_format_flags();
+        auto&             val    = (is_transient) ? accum : value;
+
+        ss.setf(_flags);
+        ss << std::setw(_width) << std::setprecision(_prec) << get() << " % waiting, "
+           << std::setprecision(3)
+           << (static_cast<double>(val[1]) / ratio_t::den * units::sec) << " "
+           << units::time_repr(units::sec) << " delay, " << val[4] << " involuntary / "
+           << val[3] << " voluntary switches";
+        return ss.str();
+    }
+
+    /// percentage of the runnable time (running + waiting) spent in the run-queue
+    double get() const
+    {
+        auto& val   = (is_transient) ? accum : value;
+        auto  denom = val[0] + val[1];
+        return (denom > 0) ? (100.0 * static_cast<double>(val[1]) / denom) : 0.0;
+    }
+
+    int64_t get_run_delay() const { return ((is_transient) ? accum : value)[1]; }
+    int64_t get_voluntary() const { return ((is_transient) ? accum : value)[3]; }
+    int64_t get_involuntary() const { return ((is_transient) ? accum : value)[4]; }
+
+    void start()
+    {
+        set_started();
+        value = record();
+    }
+
+    void stop()
+    {
+        auto tmp = record();
+        for(size_t i = 0; i < tmp.size(); ++i)
+            accum[i] += (tmp[i] - value[i]);
+        value = std::move(tmp);
+        set_stopped();
+    }
+};
+
+}  // namespace component
+
+}  // namespace tim
+
+#endif
@@ -33,6 +33,7 @@
 #include "timemory/utility/mangler.hpp"
 
 #include <cassert>
+#include <chrono>
 
 //======================================================================================//
 
@@ -82,6 +83,139 @@ class gotcha_suppression
     };
 };
 
+//======================================================================================//
+//
+//  Sampling policy for a GOTCHA wrapper. Intercepting very hot functions (malloc,
+//  memcpy, MPI_Test, etc.) with a full component_type on every call can slow the
+//  application by integer factors. When a sampler is set, unsampled calls only
+//  increment a thread-local counter and call the original function directly and
+//  sampled calls are weighted by the number of calls they represent, i.e. the
+//  reported values are scaled estimates. With every_nth and first_n, a sample stands
+//  for itself and the unsampled calls after it, so the laps are exact whenever the
+//  total number of calls ends on a period boundary and over-estimate by less than one
+//  period otherwise. With token_bucket, a sample stands for the calls since the
+//  previous sample and the unsampled calls after the final sample are only reflected
+//  in get_call_count().
+//
+//      always          ==  every call is measured (default)
+//      every_nth       ==  measure one out of every "period" calls
+//      token_bucket    ==  measure at most "rate" calls per second (with "burst")
+//      first_n         ==  measure the first "count" calls, then every "period" call
+//
+struct gotcha_sampler
+{
+    enum mode_t : short
+    {
+        always = 0,
+        every_nth,
+        token_bucket,
+        first_n
+    };
+
+    mode_t  mode   = always;
+    int64_t period = 1;
+    int64_t count  = 0;
+    double  rate   = 0.0;
+    double  burst  = 1.0;
+
+    static gotcha_sampler every(int64_t _period)
+    {
+        gotcha_sampler _obj;
+        _obj.mode   = every_nth;
+        _obj.period = std::max<int64_t>(_period, 1);
+        return _obj;
+    }
+
+    static gotcha_sampler per_second(double _rate, double _burst = 1.0)
+    {
+        gotcha_sampler _obj;
+        _obj.mode  = token_bucket;
+        _obj.rate  = std::max<double>(_rate, 0.0);
+        _obj.burst = std::max<double>(_burst, 1.0);
+        return _obj;
+    }
+
+    static gotcha_sampler first(int64_t _count, int64_t _period)
+    {
+        gotcha_sampler _obj;
+        _obj.mode   = first_n;
+        _obj.count  = std::max<int64_t>(_count, 0);
+        _obj.period = std::max<int64_t>(_period, 1);
+        return _obj;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  per-thread state of a sampled wrapper
+    //
+    struct state
+    {
+        int64_t calls   = 0;  // total number of calls (exact)
+        int64_t sampled = 0;  // number of calls that were measured
+        int64_t pending = 0;  // number of calls since the last measured call
+        double  tokens  = 0.0;
+        int64_t refill  = 0;  // time-stamp (nsec) of last token refill
+    };
+
+    //----------------------------------------------------------------------------------//
+    //  returns zero if the call should not be measured, otherwise returns the number
+    //  of calls the measurement represents
+    //
+    int64_t operator()(state& _state) const
+    {
+        ++_state.calls;
+        ++_state.pending;
+
+        bool _sample = true;
+        switch(mode)
+        {
+            case always: break;
+            case every_nth: _sample = ((_state.calls - 1) % period == 0); break;
+            case first_n:
+                _sample = (_state.calls <= count) ||
+                          ((_state.calls - count - 1) % period == 0);
+                break;
+            case token_bucket:
+            {
+                using clock_type    = std::chrono::steady_clock;
+                using duration_type = std::chrono::nanoseconds;
+                int64_t _now        = std::chrono::duration_cast<duration_type>(
+                                   clock_type::now().time_since_epoch())
+                                   .count();
+                double _refill = 1.0e-9 * rate * (_now - _state.refill);
+                _state.tokens  = (_state.refill == 0)
+                                    ? burst
+                                    : std::min<double>(burst, _state.tokens + _refill);
+                _state.refill = _now;
+                _sample       = (_state.tokens >= 1.0);
+                if(_sample)
+                    _state.tokens -= 1.0;
+                break;
+            }
+        }
+
+        if(!_sample)
+            return 0;
+
+        ++_state.sampled;
+
+        // the deterministic policies charge each sample for the calls which follow it
+        // up to the next sample so the calls after the final sample are not lost. The
+        // token bucket cannot know when the next sample occurs so it charges the calls
+        // which preceded it
+        int64_t _weight = 1;
+        switch(mode)
+        {
+            case always: break;
+            case every_nth: _weight = period; break;
+            case first_n: _weight = (_state.calls <= count) ? 1 : period; break;
+            case token_bucket: _weight = _state.pending; break;
+        }
+        _state.pending = 0;
+        return _weight;
+    }
+};
+
+//======================================================================================//
 //
 // template params:
 //      _Nt             ==  max number of GOTCHA wrappers
@@ -157,6 +291,43 @@ struct gotcha
         return _instance;
     }
 
+    //----------------------------------------------------------------------------------//
+    //  sampling policy assigned to wrappers when they are constructed
+    //
+    static gotcha_sampler& get_default_sampler()
+    {
+        static gotcha_sampler _instance{};
+        return _instance;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  assign a sampling policy to the wrapper at index "_idx"
+    //
+    static void set_sampler(size_type _idx, const gotcha_sampler& _sampler)
+    {
+        get_data().at(_idx).sampler = _sampler;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  total number of calls (sampled and unsampled) intercepted by the wrapper at
+    //  index "_idx" on exited threads and the calling thread
+    //
+    static int64_t get_call_count(size_type _idx)
+    {
+        return get_sample_totals().at(_idx).calls.load() +
+               get_sample_state().data.at(_idx).calls;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  number of calls that were measured by the wrapper at index "_idx" on exited
+    //  threads and the calling thread
+    //
+    static int64_t get_sampled_count(size_type _idx)
+    {
+        return get_sample_totals().at(_idx).sampled.load() +
+               get_sample_state().data.at(_idx).sampled;
+    }
+
     //----------------------------------------------------------------------------------//
 
     template <size_t _N, typename _Ret, typename... _Args>
@@ -228,6 +399,7 @@ struct gotcha
             _data.filled  = true;
             _data.wrap_id = _func;
             _data.ready   = get_default_ready();
+            _data.sampler = get_default_sampler();
 
             error_t ret_prio = ::tim::gotcha::set_priority(_label, _priority);
             check_error<_N>(ret_prio, "set priority");
@@ -332,6 +504,24 @@ struct gotcha
 
     static void invoke_global_finalize(storage_type*)
     {
+        if(settings::verbose() > 0 || settings::debug())
+        {
+            auto& _data = get_data();
+            for(size_type i = 0; i < _Nt; ++i)
+            {
+                if(_data[i].sampler.mode == gotcha_sampler::always)
+                    continue;
+                auto _calls   = get_call_count(i);
+                auto _sampled = get_sampled_count(i);
+                if(_calls == 0)
+                    continue;
+                printf("[gotcha]> %s : %lli calls, %lli sampled (%.2f%%)\n",
+                       _data[i].tool_id.c_str(), static_cast<long long>(_calls),
+                       static_cast<long long>(_sampled),
+                       (100.0 * _sampled) / static_cast<double>(_calls));
+            }
+        }
+
         while(get_started() > 0)
             --get_started();
         while(get_thread_started() > 0)
@@ -422,14 +612,42 @@ private:
     {
         gotcha_data() = default;
 
-        bool          ready       = get_default_ready();
-        bool          filled      = false;
-        binding_t     binding     = binding_t{};
-        wrappee_t     wrappee     = 0x0;
-        wrappid_t     wrap_id     = "";
-        wrappid_t     tool_id     = "";
-        constructor_t constructor = []() {};
-        destructor_t  destructor  = []() {};
+        bool           ready       = get_default_ready();
+        bool           filled      = false;
+        binding_t      binding     = binding_t{};
+        wrappee_t      wrappee     = 0x0;
+        wrappid_t      wrap_id     = "";
+        wrappid_t      tool_id     = "";
+        constructor_t  constructor = []() {};
+        destructor_t   destructor  = []() {};
+        gotcha_sampler sampler     = get_default_sampler();
+    };
+
+    //----------------------------------------------------------------------------------//
+    //  accumulated counts from threads which have exited
+    //
+    struct sample_totals
+    {
+        std::atomic<int64_t> calls;
+        std::atomic<int64_t> sampled;
+    };
+
+    //----------------------------------------------------------------------------------//
+    //  thread-local sampling state, counts are flushed to the totals on thread exit
+    //
+    struct sample_state
+    {
+        array_t<gotcha_sampler::state> data;
+
+        ~sample_state()
+        {
+            auto& _totals = get_sample_totals();
+            for(size_type i = 0; i < _Nt; ++i)
+            {
+                _totals[i].calls += data[i].calls;
+                _totals[i].sampled += data[i].sampled;
+            }
+        }
     };
 
     //----------------------------------------------------------------------------------//
@@ -446,6 +664,22 @@ private:
 
     //----------------------------------------------------------------------------------//
 
+    static array_t<sample_totals>& get_sample_totals()
+    {
+        static array_t<sample_totals> _instance;
+        return _instance;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static sample_state& get_sample_state()
+    {
+        static thread_local sample_state _instance;
+        return _instance;
+    }
+
+    //----------------------------------------------------------------------------------//
+
     static std::atomic<int64_t>& get_started()
     {
         static std::atomic<int64_t> _instance;
@@ -588,6 +822,30 @@ private:
 
     //----------------------------------------------------------------------------------//
 
+    //  when the differentiator provides
+    //
+    //      template <size_t _N, typename _Ret, typename... _Args>
+    //      static bool gotcha_fast_path(_Ret&, _Args...)
+    //
+    //  it is invoked before anything is measured and returning true completes the
+    //  call with the assigned return value
+    //
+    template <size_t _N, typename _Ret, typename... _Args,
+              typename _Diff = _Differentiator>
+    static auto fast_path(int, _Ret& _ret, _Args... _args)
+        -> decltype(_Diff::template gotcha_fast_path<_N>(_ret, _args...))
+    {
+        return _Diff::template gotcha_fast_path<_N>(_ret, _args...);
+    }
+
+    template <size_t _N, typename _Ret, typename... _Args>
+    static bool fast_path(long, _Ret&, _Args...)
+    {
+        return false;
+    }
+
+    //----------------------------------------------------------------------------------//
+
     template <size_t _N, typename _Ret, typename... _Args>
     static _Ret wrap(_Args... _args)
     {
@@ -615,6 +873,17 @@ private:
             return (_orig) ? (*_orig)(_args...) : _Ret{};
         }
 
+        // the differentiator can complete the call without a measurement (e.g. an
+        // uncontended lock) before the component_type is constructed
+        _Ret _fast{};
+        if(_orig && fast_path<_N>(0, _fast, _args...))
+            return _fast;
+
+        // unsampled calls only increment the thread-local counters
+        auto _weight = _data.sampler(get_sample_state().data[_N]);
+        if(_weight == 0)
+            return (_orig) ? (*_orig)(_args...) : _Ret{};
+
         // make sure the function is not recursively entered (important for
         // allocation-based wrappers)
         _data.ready      = false;
@@ -654,7 +923,7 @@ private:
             _data.ready      = false;
 
             _obj.customize(_data.tool_id, _ret);
-            _obj.stop();
+            _obj.scaled_stop(_weight);
 
 #    if defined(DEBUG)
             /*
@@ -721,6 +990,15 @@ private:
             return;
         }
 
+        // unsampled calls only increment the thread-local counters
+        auto _weight = _data.sampler(get_sample_state().data[_N]);
+        if(_weight == 0)
+        {
+            if(_orig)
+                (*_orig)(_args...);
+            return;
+        }
+
         // make sure the function is not recursively entered (important for
         // allocation-based wrappers)
         _data.ready      = false;
@@ -739,7 +1017,7 @@ private:
             _data.ready      = false;
 
             _obj.customize(_data.tool_id);
-            _obj.stop();
+            _obj.scaled_stop(_weight);
         }
         else if(settings::debug())
         {
@@ -0,0 +1,175 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "timemory/ert/data.hpp"
+#include "timemory/units.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tim
+{
+namespace ert
+{
+//--------------------------------------------------------------------------------------//
+//  a roof of the roofline: GFLOP/s for the compute roof, GB/s for a memory level
+//
+struct ceiling
+{
+    std::string label;
+    double      value;
+};
+
+//--------------------------------------------------------------------------------------//
+//  the roofs extracted from the ERT data (see timemory/roofline/roofline.py)
+//
+struct ceilings
+{
+    ceiling              flops     = { "GFLOP/s", 0.0 };
+    std::vector<ceiling> bandwidth = {};  // L1 (highest) first, DRAM last
+
+    bool empty() const { return flops.value <= 0.0 && bandwidth.empty(); }
+
+    double peak_flops() const { return flops.value; }
+
+    double peak_bandwidth() const
+    {
+        return (bandwidth.empty()) ? 0.0 : bandwidth.front().value;
+    }
+
+    /// attainable GFLOP/s at the given arithmetic intensity (FLOPs / byte). Without
+    /// an intensity (or without bandwidth data), this is the compute roof
+    double roof(double _intensity) const
+    {
+        if(_intensity <= 0.0 || bandwidth.empty())
+            return flops.value;
+        auto _memory = peak_bandwidth() * _intensity;
+        return (flops.value > 0.0) ? std::min(flops.value, _memory) : _memory;
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+//  peak GFLOP/s is the maximum ops-per-sec of any run. The memory levels are found
+//  as in ERT (https://bitbucket.org/berkeleylab/cs-roofline-toolkit): the bandwidths
+//  of the runs with the first ops-per-set (ordered by the working-set size) are
+//  binned into samples and each plateau which is > 20% below the previous one is a
+//  level
+//
+inline ceilings
+get_ceilings(const exec_data& _data)
+{
+    static constexpr double fraction = 1.05;
+    static constexpr size_t samples  = 10000;
+    const double            giga     = static_cast<double>(units::gigabyte);
+
+    ceilings            _ret;
+    std::vector<double> _bandwidth;
+    bool                _first = true;
+    double              _ref   = 0.0;
+    for(const auto& itr : _data)
+    {
+        _ret.flops.value = std::max(_ret.flops.value, std::get<7>(itr) / giga);
+        if(_first)
+            _ref = std::get<8>(itr);
+        _first = false;
+        if(std::get<8>(itr) == _ref)
+            _bandwidth.push_back(std::get<6>(itr) / giga);
+    }
+
+    if(_bandwidth.empty())
+        return _ret;
+
+    auto _max = std::max_element(_bandwidth.begin(), _bandwidth.end());
+    auto _top = *_max;
+    if(!(_top > 0.0))
+        return _ret;
+    _bandwidth.erase(_bandwidth.begin(), _max);
+
+    // a bandwidth b is counted in sample i when b / fraction <= i * delta <= b *
+    // fraction, i.e. only the samples in that range are visited
+    double              _delta = _top / static_cast<double>(samples - 1);
+    std::vector<size_t> _counts(samples, 0);
+    std::vector<double> _totals(samples, 0.0);
+    for(const auto& itr : _bandwidth)
+    {
+        auto _beg = static_cast<size_t>(std::ceil(itr / fraction / _delta));
+        auto _end = static_cast<size_t>(std::floor(itr * fraction / _delta));
+        for(size_t i = _beg; i <= _end && i < samples; ++i)
+        {
+            _totals[i] += itr;
+            _counts[i] += 1;
+        }
+    }
+
+    // (sum of the bandwidths, number of bandwidths) of each level
+    std::vector<std::pair<double, double>> _levels = { { 1000.0 * _top, 1000.0 } };
+    int64_t                                _maxc   = -1;
+    int64_t                                _maxi   = -1;
+    for(int64_t i = samples - 3; i > 1; --i)
+    {
+        auto _count = static_cast<int64_t>(_counts[i]);
+        if(_count > 10)
+        {
+            if(_count > _maxc)
+            {
+                _maxc = _count;
+                _maxi = i;
+            }
+            continue;
+        }
+        if(_maxc > 1)
+        {
+            auto  _value = _totals[_maxi] / std::max<double>(1.0, _counts[_maxi]);
+            auto& _last  = _levels.back();
+            if(1.2 * _value < _last.first / _last.second)
+                _levels.push_back({ _totals[_maxi], static_cast<double>(_counts[_maxi]) });
+            else
+            {
+                _last.first += _totals[_maxi];
+                _last.second += _counts[_maxi];
+            }
+        }
+        _maxc = -1;
+        _maxi = -1;
+    }
+
+    for(size_t i = 0; i < _levels.size(); ++i)
+    {
+        auto _label = (i + 1 == _levels.size()) ? std::string("DRAM")
+                                                : (std::string("L") + std::to_string(i + 1));
+        _ret.bandwidth.push_back({ _label + " GB/s", _levels[i].first / _levels[i].second });
+    }
+    return _ret;
+}
+
+//--------------------------------------------------------------------------------------//
+
+}  // namespace ert
+}  // namespace tim
@@ -40,8 +40,10 @@
 #include "timemory/mpl/filters.hpp"
 #include "timemory/utility/macros.hpp"
 #include "timemory/utility/serializer.hpp"
+#include "timemory/utility/shared_profile.hpp"
 #include "timemory/utility/singleton.hpp"
 #include "timemory/utility/storage.hpp"
+#include "timemory/utility/trace.hpp"
 #include "timemory/utility/utility.hpp"
 
 //--------------------------------------------------------------------------------------//
@@ -95,6 +97,13 @@ public:
 
     void finalize();
 
+    // storage-types add functors to merge the data of a worker thread into the master
+    template <typename _Func>
+    void add_merger(_Func&&);
+
+    // merge the data of the calling worker thread into the master (see thread_exit)
+    void merge();
+
 public:
     // Public static functions
     static pointer_t instance();
@@ -165,7 +174,7 @@ private:
             using storage_type = typename _Tp::storage_type;
             auto ret           = storage_type::noninit_instance();
             if(ret)
-                ret->data().reset();
+                ret->reset();
         }
     }
 
@@ -177,6 +186,53 @@ private:
         _clear<_Tail...>();
     }
 
+    //----------------------------------------------------------------------------------//
+    //
+    template <typename _Tp, typename... _Tail,
+              enable_if_t<(sizeof...(_Tail) == 0), int> = 0>
+    void _pack(std::string& _buffer)
+    {
+        if(component::properties<_Tp>::has_storage())
+        {
+            using storage_type = typename _Tp::storage_type;
+            auto ret           = storage_type::noninit_instance();
+            if(ret && !ret->empty())
+                ret->pack(_buffer);
+        }
+    }
+
+    template <typename _Tp, typename... _Tail,
+              enable_if_t<(sizeof...(_Tail) > 0), int> = 0>
+    void _pack(std::string& _buffer)
+    {
+        _pack<_Tp>(_buffer);
+        _pack<_Tail...>(_buffer);
+    }
+
+    //----------------------------------------------------------------------------------//
+    //
+    template <typename _Tp, typename... _Tail,
+              enable_if_t<(sizeof...(_Tail) == 0), int> = 0>
+    void _unpack(const std::string& _label, const char* _data, size_t _size)
+    {
+        if(component::properties<_Tp>::has_storage() && _label == _Tp::label())
+        {
+            using storage_type = typename _Tp::storage_type;
+            auto ret           = storage_type::instance();
+            if(ret && !ret->unpack(_data, _size) && settings::verbose() > 0)
+                fprintf(stderr, "[%s]> packed data could not be merged\n",
+                        _label.c_str());
+        }
+    }
+
+    template <typename _Tp, typename... _Tail,
+              enable_if_t<(sizeof...(_Tail) > 0), int> = 0>
+    void _unpack(const std::string& _label, const char* _data, size_t _size)
+    {
+        _unpack<_Tp>(_label, _data, _size);
+        _unpack<_Tail...>(_label, _data, _size);
+    }
+
     //----------------------------------------------------------------------------------//
     //
     template <typename _Archive, typename _Tp, typename... _Tail,
@@ -289,6 +345,43 @@ private:
                 _manager->_size<_Types...>(_sz);
             return _sz;
         }
+
+        // the call-graphs in a compact binary form, e.g. to send them to the parent
+        // of a worker process. See storage::pack
+        static std::string pack(pointer_t _manager = pointer_t(nullptr))
+        {
+            std::string _buffer;
+            if(_manager.get() == nullptr)
+                _manager = manager::instance();
+            if(_manager)
+                _manager->_pack<_Types...>(_buffer);
+            return _buffer;
+        }
+
+        // merge the output of pack() into the storage of the calling thread. Sections
+        // of components which are not in _Types are skipped
+        static void unpack(const std::string& _buffer,
+                           pointer_t          _manager = pointer_t(nullptr))
+        {
+            if(_manager.get() == nullptr)
+                _manager = manager::instance();
+            if(!_manager)
+                return;
+
+            size_t _pos = 0;
+            while(_pos + sizeof(details::packed_section) <= _buffer.size())
+            {
+                details::packed_section _section;
+                memcpy(&_section, _buffer.data() + _pos, sizeof(_section));
+                auto _size = sizeof(_section) + _section.label_size + _section.nbytes;
+                if(_pos + _size > _buffer.size())
+                    break;
+                std::string _label(_buffer.data() + _pos + sizeof(_section),
+                                   _section.label_size);
+                _manager->_unpack<_Types...>(_label, _buffer.data() + _pos, _size);
+                _pos += _size;
+            }
+        }
     };
 
     //----------------------------------------------------------------------------------//
@@ -300,9 +393,11 @@ private:
         using base_type = filtered_get_storage<_Types...>;
         using base_type::clear;
         using base_type::initialize;
+        using base_type::pack;
         using base_type::print;
         using base_type::serialize;
         using base_type::size;
+        using base_type::unpack;
     };
 
 public:
@@ -314,9 +409,11 @@ public:
         using base_type = filtered_get_storage<implemented<_Types...>>;
         using base_type::clear;
         using base_type::initialize;
+        using base_type::pack;
         using base_type::print;
         using base_type::serialize;
         using base_type::size;
+        using base_type::unpack;
     };
 
     //----------------------------------------------------------------------------------//
@@ -328,9 +425,11 @@ public:
         using base_type = filtered_get_storage<implemented<_Types...>>;
         using base_type::clear;
         using base_type::initialize;
+        using base_type::pack;
         using base_type::print;
         using base_type::serialize;
         using base_type::size;
+        using base_type::unpack;
     };
 
 private:
@@ -363,6 +462,7 @@ private:
     graph_hash_alias_ptr_t m_hash_aliases = get_hash_aliases();
     finalizer_list_t       m_master_finalizers;
     finalizer_list_t       m_worker_finalizers;
+    finalizer_list_t       m_worker_mergers;
     mutex_t                m_mutex;
 
 private:
@@ -40,9 +40,11 @@
 #include "timemory/utility/serializer.hpp"
 
 #include <iostream>
+#include <mutex>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 //======================================================================================//
 
@@ -218,6 +220,18 @@ struct pop_node
 
 //--------------------------------------------------------------------------------------//
 
+template <typename _Tp>
+struct erase_node
+{
+    using Type       = _Tp;
+    using value_type = typename Type::value_type;
+    using base_type  = typename Type::base_type;
+
+    explicit erase_node(base_type& obj) { obj.erase_node(); }
+};
+
+//--------------------------------------------------------------------------------------//
+
 template <typename _Tp>
 struct record
 {
@@ -649,6 +663,213 @@ struct divide
     divide(base_type& obj, const base_type& rhs) { obj /= rhs; }
 };
 
+//--------------------------------------------------------------------------------------//
+///
+/// \class operation::scale
+///
+/// \brief Weight a single measurement so that it represents "rhs" invocations. This is
+/// used by sampled GOTCHA wrappers: the measured value is multiplied by the number of
+/// calls the sample stands for and the laps are incremented to keep the call count
+/// exact. Components with non-arithmetic values or which record a maximum only have
+/// their lap count updated.
+///
+template <typename _Tp>
+struct scale
+{
+    using Type       = _Tp;
+    using value_type = typename Type::value_type;
+    using base_type  = typename Type::base_type;
+
+    scale(base_type& obj, const int64_t& rhs)
+    {
+        if(rhs > 1)
+            sfinae(obj, rhs, 0);
+    }
+
+private:
+    template <typename _Up = _Tp, typename _Vp = value_type,
+              enable_if_t<(std::is_arithmetic<_Vp>::value &&
+                           !trait::record_max<_Up>::value),
+                          int> = 0>
+    void sfinae(base_type& obj, const int64_t& rhs, int)
+    {
+        obj *= static_cast<value_type>(rhs);
+        obj.laps += rhs - 1;
+    }
+
+    template <typename _Up = _Tp, typename _Vp = value_type,
+              enable_if_t<!(std::is_same<_Vp, void>::value), int> = 0>
+    void sfinae(base_type& obj, const int64_t& rhs, long)
+    {
+        obj.laps += rhs - 1;
+    }
+
+    template <typename _Up = _Tp, typename _Vp = value_type,
+              enable_if_t<(std::is_same<_Vp, void>::value), int> = 0>
+    void sfinae(base_type&, const int64_t&, long)
+    {}
+};
+
+//--------------------------------------------------------------------------------------//
+///
+/// \class operation::calibrate
+///
+/// \brief Given the measurement of a scratch bundle which enclosed "nitr" nested,
+/// stored start/stop of the bundle identified by "bundle", record the per-marker
+/// overhead of that bundle as seen by the component. The two-argument form attributes
+/// the call-graph node of the component to the estimate of the bundle which inserted
+/// it (when several bundles insert the same node, the smallest estimate is kept so
+/// that the node is not over-corrected). Only arithmetic, non-peak value types are
+/// calibrated.
+///
+template <typename _Tp>
+struct calibrate
+{
+    using Type           = _Tp;
+    using value_type     = typename Type::value_type;
+    using base_type      = typename Type::base_type;
+    using estimate_map_t = std::unordered_map<uint64_t, double>;
+    using node_map_t     = std::unordered_map<int64_t, double>;
+
+    calibrate(const Type& obj, const int64_t& nitr, const uint64_t& bundle)
+    {
+        if(nitr > 0)
+            sfinae(obj, nitr, bundle, 0);
+    }
+
+    calibrate(const Type& obj, const uint64_t& bundle) { attribute(obj, bundle, 0); }
+
+    static bool is_calibrated()
+    {
+        std::lock_guard<std::mutex> _lk(get_mutex());
+        return !get_estimates().empty();
+    }
+
+    static bool is_calibrated(uint64_t bundle)
+    {
+        std::lock_guard<std::mutex> _lk(get_mutex());
+        return get_estimates().count(bundle) > 0;
+    }
+
+    // per-marker overhead of the bundle in the raw units of value_type
+    static double estimate(uint64_t bundle)
+    {
+        std::lock_guard<std::mutex> _lk(get_mutex());
+        auto itr = get_estimates().find(bundle);
+        return (itr == get_estimates().end()) ? 0.0 : itr->second;
+    }
+
+    // per-marker overhead of the bundle(s) which inserted the node
+    static double node_estimate(int64_t node_id)
+    {
+        std::lock_guard<std::mutex> _lk(get_mutex());
+        auto itr = get_nodes().find(node_id);
+        return (itr == get_nodes().end()) ? 0.0 : itr->second;
+    }
+
+private:
+    static std::mutex& get_mutex()
+    {
+        static std::mutex _instance;
+        return _instance;
+    }
+
+    static estimate_map_t& get_estimates()
+    {
+        static estimate_map_t _instance;
+        return _instance;
+    }
+
+    static node_map_t& get_nodes()
+    {
+        static node_map_t _instance;
+        return _instance;
+    }
+
+    template <typename _Up = _Tp, typename _Vp = value_type,
+              enable_if_t<(std::is_arithmetic<_Vp>::value &&
+                           !trait::record_max<_Up>::value),
+                          int> = 0>
+    void sfinae(const Type& obj, const int64_t& nitr, const uint64_t& bundle, int)
+    {
+        double _value = static_cast<double>(obj.get_accum()) / nitr;
+        if(_value < 0.0)
+            _value = 0.0;
+        std::lock_guard<std::mutex> _lk(get_mutex());
+        get_estimates()[bundle] = _value;
+    }
+
+    template <typename _Up = _Tp>
+    void sfinae(const Type&, const int64_t&, const uint64_t&, long)
+    {}
+
+    template <typename _Up = _Tp, typename _Vp = value_type,
+              enable_if_t<(std::is_arithmetic<_Vp>::value &&
+                           !trait::record_max<_Up>::value && _Up::implements_storage_v),
+                          int> = 0>
+    void attribute(const Type& obj, const uint64_t& bundle, int)
+    {
+        if(!obj.graph_itr)
+            return;
+
+        // only take the lock the first time a bundle is seen at a node
+        static thread_local std::unordered_map<int64_t, uint64_t> _seen;
+        auto _id   = obj.graph_itr->id();
+        auto _sitr = _seen.find(_id);
+        if(_sitr != _seen.end() && _sitr->second == bundle)
+            return;
+        _seen[_id] = bundle;
+
+        std::lock_guard<std::mutex> _lk(get_mutex());
+        auto _eitr = get_estimates().find(bundle);
+        if(_eitr == get_estimates().end())
+            return;
+        auto _nitr = get_nodes().find(_id);
+        if(_nitr == get_nodes().end() || _eitr->second < _nitr->second)
+            get_nodes()[_id] = _eitr->second;
+    }
+
+    template <typename _Up = _Tp>
+    void attribute(const Type&, const uint64_t&, long)
+    {}
+};
+
+//--------------------------------------------------------------------------------------//
+///
+/// \class operation::compensate
+///
+/// \brief Subtract the calibrated overhead of the descendant markers (in the raw
+/// units of value_type) from an inclusive measurement (never below zero)
+///
+template <typename _Tp>
+struct compensate
+{
+    using Type       = _Tp;
+    using value_type = typename Type::value_type;
+    using base_type  = typename Type::base_type;
+
+    compensate(Type& obj, const double& overhead)
+    {
+        if(overhead > 0.0)
+            sfinae(obj, overhead, 0);
+    }
+
+private:
+    template <typename _Up = _Tp, typename _Vp = value_type,
+              enable_if_t<(std::is_arithmetic<_Vp>::value &&
+                           !trait::record_max<_Up>::value),
+                          int> = 0>
+    void sfinae(Type& obj, const double& overhead, int)
+    {
+        double _accum = static_cast<double>(obj.get_accum());
+        obj -= static_cast<value_type>(std::min<double>(overhead, _accum));
+    }
+
+    template <typename _Up = _Tp>
+    void sfinae(Type&, const double&, long)
+    {}
+};
+
 //--------------------------------------------------------------------------------------//
 ///
 /// \class operation::get_data
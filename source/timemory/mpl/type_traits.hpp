@@ -199,6 +199,18 @@ template <typename _Tp>
 struct secondary_data : std::false_type
 {};
 
+//--------------------------------------------------------------------------------------//
+/// trait that signifies that the call-graph nodes only need to store the accumulated
+/// data (i.e. the result of get() and the number of laps) instead of an entire copy of
+/// the component. Storage only applies this to components which do not add data
+/// members to their base class and do not override its operator+= so specialize this
+/// to false when the accumulated state of a component is not fully described by the
+/// base class
+///
+template <typename _Tp>
+struct compact_graph_node : std::true_type
+{};
+
 //--------------------------------------------------------------------------------------//
 
 template <typename _Trait>
@@ -267,6 +279,7 @@ template <>
 struct array_serialization<component::cupti_counters> : std::true_type
 {};
 #endif
+
 //--------------------------------------------------------------------------------------//
 //
 //                              START PRIORITY
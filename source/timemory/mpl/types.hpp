@@ -63,6 +63,9 @@ struct insert_node;
 template <typename _Tp>
 struct pop_node;
 
+template <typename _Tp>
+struct erase_node;
+
 template <typename _Tp>
 struct record;
 
@@ -114,6 +117,15 @@ struct multiply;
 template <typename _Tp>
 struct divide;
 
+template <typename _Tp>
+struct scale;
+
+template <typename _Tp>
+struct calibrate;
+
+template <typename _Tp>
+struct compensate;
+
 template <typename _Tp>
 struct get_data;
 
@@ -59,6 +59,7 @@ parse();
 #include "timemory/components.hpp"
 #include "timemory/mpl/operations.hpp"
 #include "timemory/units.hpp"
+#include "timemory/utility/shared_profile.hpp"
 #include "timemory/utility/signals.hpp"
 #include "timemory/utility/utility.hpp"
 
@@ -87,6 +88,10 @@ timemory_init(int* argc, char*** argv, const std::string& _prefix = "timemory-",
 /// finalization of the specified types
 void
 timemory_finalize();
+/// merge the data of the calling thread into the master thread before it exits (or
+/// is returned to a thread-pool), no components may be running on the thread
+void
+thread_exit();
 
 }  // namespace tim
 
@@ -180,6 +185,9 @@ tim::timemory_init(int argc, char** argv, const std::string& _prefix,
         auto enabled_signals = tim::signal_settings::get_enabled();
         tim::enable_signal_detection(enabled_signals);
     }
+
+    // when enabled, the segment must exist before the application forks
+    tim::shared_profile::create();
 }
 
 //--------------------------------------------------------------------------------------//
@@ -219,6 +227,15 @@ tim::timemory_finalize()
 
 //--------------------------------------------------------------------------------------//
 
+inline void
+tim::thread_exit()
+{
+    // only the storage instances of worker threads add mergers
+    tim::manager::instance()->merge();
+}
+
+//--------------------------------------------------------------------------------------//
+
 #include "timemory/utility/bits/storage.hpp"
 
 //--------------------------------------------------------------------------------------//
@@ -293,6 +293,31 @@ print_percentage(std::ostream& os, const _Tp& obj)
     os << ss.str();
 }
 
+//--------------------------------------------------------------------------------------//
+//
+//      Scalar value for the cross-thread statistics
+//
+//--------------------------------------------------------------------------------------//
+
+template <typename _Tp,
+          typename std::enable_if<(std::is_arithmetic<_Tp>::value), int>::type = 0>
+bool
+thread_stat_value(const _Tp& obj, double& _value)
+{
+    _value = static_cast<double>(obj);
+    return true;
+}
+
+//--------------------------------------------------------------------------------------//
+
+template <typename _Tp,
+          typename std::enable_if<!(std::is_arithmetic<_Tp>::value), int>::type = 0>
+bool
+thread_stat_value(const _Tp&, double&)
+{
+    return false;
+}
+
 //--------------------------------------------------------------------------------------//
 
 }  // namespace details
@@ -317,8 +342,15 @@ storage<ObjectType, true>::merge(this_type* itr)
     if(itr == this)
         return;
 
-    // if merge was not initialized return
-    if(itr && !itr->is_initialized())
+    // keep the call-graph of each thread separate
+    if(settings::thread_output())
+    {
+        collect(itr);
+        return;
+    }
+
+    // if merge was not initialized or its graph was already merged and released
+    if(itr && (!itr->is_initialized() || itr->m_graph_data_instance == nullptr))
         return;
 
     // create lock but don't immediately lock
@@ -361,6 +393,21 @@ storage<ObjectType, true>::merge(this_type* itr)
     if(itr->size() == 0 || !itr->data().has_head())
         return;
 
+    // combine the nodes with the existing nodes of the master so that the size of the
+    // master call-graph does not grow with the number of threads
+    if(settings::collapse_threads())
+    {
+        for(auto _titr = graph().begin(); _titr != graph().end(); ++_titr)
+        {
+            if(_titr && *_titr == *itr->data().head())
+            {
+                fold(_titr, itr->data().head());
+                itr->data().clear();
+                return;
+            }
+        }
+    }
+
     bool _merged = false;
     for(auto _titr = graph().begin(); _titr != graph().end(); ++_titr)
     {
@@ -401,6 +448,296 @@ storage<ObjectType, true>::merge(this_type* itr)
     itr->data().clear();
 }
 
+//======================================================================================//
+//  recursively adds the children of _src to the children of _dst with the same hash
+//  and depth, the children without an equivalent are copied
+//
+template <typename ObjectType>
+void
+storage<ObjectType, true>::fold(iterator _dst, iterator _src)
+{
+    using sibling_iterator = typename graph_t::sibling_iterator;
+
+    for(sibling_iterator _sitr = _src.begin(); _sitr != _src.end(); ++_sitr)
+    {
+        if(!_sitr)
+            continue;
+
+        sibling_iterator _ditr = _dst.begin();
+        for(; _ditr != _dst.end(); ++_ditr)
+        {
+            if(_ditr && *_ditr == *_sitr)
+                break;
+        }
+
+        if(_ditr == _dst.end())
+        {
+            graph().append_child(_dst, iterator(_sitr));
+        }
+        else
+        {
+            *_ditr += *_sitr;
+            fold(iterator(_ditr), iterator(_sitr));
+        }
+    }
+}
+
+//======================================================================================//
+
+template <typename ObjectType>
+void
+storage<ObjectType, true>::pack(std::string& _buffer, std::true_type)
+{
+    using value_type = typename ObjectType::value_type;
+
+    if(!m_initialized && !m_finalized)
+        return;
+
+    merge();
+
+    if(!m_graph_data_instance)
+        return;
+
+    auto _write = [](std::string& _dst, const void* _src, size_t _len) {
+        _dst.append(static_cast<const char*>(_src), _len);
+    };
+
+    // the records are in pre-order and the level is the depth in the graph so the
+    // receiver can rebuild the parent of each node. The top-level nodes are heads
+    auto_lock_t l(singleton_t::get_mutex(), std::defer_lock);
+    if(!l.owns_lock())
+        l.lock();
+
+    std::string _records;
+    uint64_t    _nrecords = 0;
+    for(auto itr = graph().begin(); itr != graph().end(); ++itr)
+    {
+        auto _level = graph_t::depth(itr);
+        if(_level < 1)
+            continue;
+
+        auto                   _obj    = itr->obj();
+        auto                   _prefix = get_prefix(*itr);
+        details::packed_record _rec;
+        memset(&_rec, 0, sizeof(_rec));
+        _rec.id          = itr->id();
+        _rec.depth       = itr->depth();
+        _rec.level       = _level;
+        _rec.laps        = _obj.laps;
+        _rec.prefix_size = static_cast<uint32_t>(_prefix.length());
+        _rec.transient   = (_obj.is_transient) ? 1 : 0;
+        _write(_records, &_rec, sizeof(_rec));
+        _write(_records, &_obj.value, sizeof(value_type));
+        _write(_records, &_obj.accum, sizeof(value_type));
+        _write(_records, _prefix.c_str(), _prefix.length());
+        ++_nrecords;
+    }
+
+    if(_nrecords == 0)
+        return;
+
+    auto                    _label = ObjectType::label();
+    details::packed_section _section;
+    memset(&_section, 0, sizeof(_section));
+    _section.label_size = static_cast<uint32_t>(_label.length());
+    _section.value_size = static_cast<uint32_t>(sizeof(value_type));
+    _section.nrecords   = _nrecords;
+    _section.nbytes     = _records.size();
+    _buffer.reserve(_buffer.size() + sizeof(_section) + _label.length() + _records.size());
+    _write(_buffer, &_section, sizeof(_section));
+    _write(_buffer, _label.c_str(), _label.length());
+    _buffer.append(_records);
+}
+
+//======================================================================================//
+
+template <typename ObjectType>
+bool
+storage<ObjectType, true>::unpack(const char* _buffer, size_t _size, std::true_type)
+{
+    using value_type       = typename ObjectType::value_type;
+    using sibling_iterator = typename graph_t::sibling_iterator;
+
+    details::packed_section _section;
+    if(_size < sizeof(_section))
+        return false;
+    memcpy(&_section, _buffer, sizeof(_section));
+    if(_section.value_size != sizeof(value_type) ||
+       _size < sizeof(_section) + _section.label_size + _section.nbytes)
+        return false;
+
+    const char* _ptr = _buffer + sizeof(_section) + _section.label_size;
+    const char* _end = _ptr + _section.nbytes;
+
+    // ensure the graph exists and the data is reported
+    initialize();
+    _data();
+
+    auto_lock_t l(singleton_t::get_mutex(), std::defer_lock);
+    if(!l.owns_lock())
+        l.lock();
+
+    // _parents[i] is the most recent node at level i + 1 (i.e. the head at level 1)
+    std::vector<iterator> _parents = { _data().head() };
+    for(uint64_t i = 0; i < _section.nrecords; ++i)
+    {
+        details::packed_record _rec;
+        if(_ptr + sizeof(_rec) > _end)
+            return false;
+        memcpy(&_rec, _ptr, sizeof(_rec));
+        _ptr += sizeof(_rec);
+        if(_ptr + 2 * sizeof(value_type) + _rec.prefix_size > _end || _rec.level < 1 ||
+           static_cast<size_t>(_rec.level) > _parents.size())
+            return false;
+
+        ObjectType _obj{};
+        memcpy(&_obj.value, _ptr, sizeof(value_type));
+        memcpy(&_obj.accum, _ptr + sizeof(value_type), sizeof(value_type));
+        _obj.laps         = _rec.laps;
+        _obj.is_transient = (_rec.transient != 0);
+        _ptr += 2 * sizeof(value_type);
+
+        std::string _prefix(_ptr, _rec.prefix_size);
+        _ptr += _rec.prefix_size;
+        auto _hash = add_hash_id(m_hash_ids, _prefix);
+        if(_hash != _rec.id)
+            add_hash_id(m_hash_ids, m_hash_aliases, _hash, _rec.id);
+
+        _parents.resize(_rec.level);
+        iterator     _parent = _parents.back();
+        graph_node_t _node(_rec.id, _obj, _rec.depth);
+
+        sibling_iterator _ditr = _parent.begin();
+        for(; _ditr != _parent.end(); ++_ditr)
+        {
+            if(_ditr && *_ditr == _node)
+                break;
+        }
+
+        if(_ditr == _parent.end())
+        {
+            _parents.push_back(graph().append_child(_parent, _node));
+        }
+        else
+        {
+            *_ditr += _node;
+            _parents.push_back(iterator(_ditr));
+        }
+    }
+    return true;
+}
+
+//======================================================================================//
+
+template <typename ObjectType>
+void
+storage<ObjectType, true>::collect(this_type* itr)
+{
+    if(!itr || itr == this || !itr->is_initialized() || !itr->m_graph_data_instance)
+        return;
+
+    // the strings are built by the calling (i.e. exiting) thread, outside of the lock
+    auto _results = itr->get();
+    itr->data().clear();
+    if(_results.empty())
+        return;
+
+    auto_lock_t l(singleton_t::get_mutex(), std::defer_lock);
+    if(!l.owns_lock())
+        l.lock();
+
+    auto _index = itr->thread_index();
+    m_thread_results.push_back(thread_result_type(_index, std::move(_results)));
+}
+
+//======================================================================================//
+
+template <typename ObjectType>
+typename storage<ObjectType, true>::thread_summary_array_type
+storage<ObjectType, true>::get_thread_summary(const thread_result_array_type& _threads)
+{
+    using key_t = std::tuple<uint64_t, int64_t, uint64_t>;
+
+    thread_summary_array_type _summary;
+    std::map<key_t, size_t>   _index;
+    for(const auto& titr : _threads)
+    {
+        for(const auto& itr : titr.second)
+        {
+            double _value = 0.0;
+            if(!details::thread_stat_value(std::get<1>(itr).get(), _value))
+                return thread_summary_array_type{};
+
+            auto _key  = key_t(std::get<0>(itr), std::get<3>(itr), std::get<4>(itr));
+            auto _iitr = _index.find(_key);
+            if(_iitr == _index.end())
+            {
+                thread_summary_type _entry;
+                _entry.hash   = std::get<0>(itr);
+                _entry.prefix = std::get<2>(itr);
+                _entry.depth  = std::get<3>(itr);
+                _iitr         = _index.insert({ _key, _summary.size() }).first;
+                _summary.push_back(_entry);
+            }
+
+            auto& _entry = _summary.at(_iitr->second);
+            _entry.nthreads += 1;
+            _entry.min = std::min(_entry.min, _value);
+            _entry.max = std::max(_entry.max, _value);
+            _entry.sum += _value;
+            _entry.sumsq += _value * _value;
+        }
+    }
+    return _summary;
+}
+
+//======================================================================================//
+
+template <typename ObjectType>
+void
+storage<ObjectType, true>::shared_profile_publish(void* _ptr,
+                                                  shared_profile::writer& _writer)
+{
+    auto _storage = static_cast<this_type*>(_ptr);
+    if(!_storage->m_initialized && !_storage->m_finalized)
+        return;
+
+    // workers are folded into the master (shared_profile_merge) before the process
+    // publishes at exit, publishing them as well would count the process twice
+    if(!singleton_t::is_master(_storage) || _storage->m_graph_data_instance == nullptr)
+        return;
+
+    // only the (unindented) label of each node is published
+    auto _entries = _storage->get_entries();
+    if(_entries.empty())
+        return;
+
+    _writer.begin_section(ObjectType::label(), ObjectType::get_display_unit(),
+                          ObjectType::get_precision());
+    for(const auto& itr : _entries)
+    {
+        double _value = std::numeric_limits<double>::quiet_NaN();
+        details::thread_stat_value(itr.obj.get(), _value);
+        _writer.record(itr.itr->id(), itr.depth, itr.rolling, itr.obj.nlaps(), _value,
+                       _storage->get_prefix(*itr.itr));
+    }
+    _writer.end_section();
+}
+
+//======================================================================================//
+
+template <typename ObjectType>
+void
+storage<ObjectType, true>::shared_profile_merge(void* _ptr)
+{
+    auto _storage = static_cast<this_type*>(_ptr);
+    if(singleton_t::is_master(_storage) || _storage->m_graph_data_instance == nullptr)
+        return;
+
+    singleton_t::master_instance()->merge(_storage);
+    _storage->clear_graph();
+}
+
 //======================================================================================//
 
 template <typename ObjectType>
@@ -436,15 +773,24 @@ void storage<ObjectType, true>::external_print(std::false_type)
         bool _json_output = settings::json_output() || _json_forced;
         bool _text_output = settings::text_output();
 
+        // call-graphs handed over by the worker threads in per-thread output mode
+        bool _has_thread_results = false;
+        {
+            auto_lock_t l(singleton_t::get_mutex(), std::defer_lock);
+            if(!l.owns_lock())
+                l.lock();
+            _has_thread_results = !m_thread_results.empty();
+        }
+
         // if the graph wasn't ever initialized, exit
-        if(!m_graph_data_instance)
+        if(!m_graph_data_instance && !_has_thread_results)
         {
             instance_count().store(0);
             return;
         }
 
         // no entries
-        if(_data().graph().size() <= 1)
+        if(_data().graph().size() <= 1 && !_has_thread_results)
         {
             instance_count().store(0);
             return;
@@ -470,7 +816,36 @@ void storage<ObjectType, true>::external_print(std::false_type)
             return;
         }
 
-        auto _results = this->get();
+        // collected worker call-graphs are reported even if settings::thread_output()
+        // was turned off after they were collected
+        bool _thread_output = settings::thread_output() || _has_thread_results;
+
+        // in per-thread output mode the call-graph of each thread is printed in
+        // sequence and each entry is tagged with the index of the thread
+        thread_result_array_type _thread_results;
+        entry_array_type         _entries;
+        result_array_type        _results;
+        if(_thread_output)
+        {
+            _thread_results = get_thread_results();
+            for(const auto& titr : _thread_results)
+            {
+                std::stringstream _tag;
+                _tag << "|T" << std::setw(3) << std::setfill('0') << titr.first << "|";
+                for(auto itr : titr.second)
+                {
+                    std::get<2>(itr) = _tag.str() + std::get<2>(itr);
+                    _results.push_back(std::move(itr));
+                }
+            }
+        }
+        else
+        {
+            // the prefixes are only built for the entries which are printed and the
+            // hierarchies only for the entries which are echoed for dart
+            _entries = get_entries();
+            _results = get(_entries, settings::max_depth(), false);
+        }
 
 #if defined(DEBUG)
         if(tim::settings::debug() && tim::settings::verbose() > 3)
@@ -588,6 +963,13 @@ void storage<ObjectType, true>::external_print(std::false_type)
             printf("\n");
         }
 
+        // subtract the calibrated overhead of the descendant markers
+        bool _overhead_correction = settings::overhead_correction() &&
+                                    operation::calibrate<ObjectType>::is_calibrated();
+        std::vector<double> _descendant_overhead;
+        if(_overhead_correction)
+            _descendant_overhead = get_descendant_overhead(_results);
+
         // std::stringstream _mss;
         for(auto itr = _results.begin(); itr != _results.end(); ++itr)
         {
@@ -609,12 +991,13 @@ void storage<ObjectType, true>::external_print(std::false_type)
                 int64_t nexclusive = 0;
                 // the sum of the exclusive values
                 get_return_type exclusive_values;
-                // continue while not at end of graph until first sibling is
+                // continue while not at end of graph until the end of the subtree
+                // (i.e. first sibling, ancestor, or graph of the next thread) is
                 // encountered
                 if(eitr == _results.end())
                     continue;
                 auto eitr_depth = std::get<3>(*eitr);
-                while(eitr_depth != itr_depth)
+                while(eitr_depth > itr_depth)
                 {
                     auto& eitr_obj = std::get<1>(*eitr);
 
@@ -646,6 +1029,17 @@ void storage<ObjectType, true>::external_print(std::false_type)
 
             auto _laps = itr_obj.nlaps();
 
+            if(_overhead_correction)
+            {
+                auto _corrected = itr_obj;
+                auto _idx       = std::distance(_results.begin(), itr);
+                operation::compensate<ObjectType>(_corrected,
+                                                  _descendant_overhead.at(_idx));
+                if(_pss.str().length() > 0)
+                    _pss << " ";
+                _pss << "[overhead-corrected: " << _corrected << "]";
+            }
+
             std::stringstream _oss;
             operation::print<ObjectType>(itr_obj, _oss, itr_prefix, _laps, itr_depth,
                                          _widths, true, _pss.str());
@@ -656,6 +1050,39 @@ void storage<ObjectType, true>::external_print(std::false_type)
                 *fout << _oss.str() << std::flush;
         }
 
+        // cross-thread statistics of each entry (for diagnosing load-imbalance)
+        if(_thread_output)
+        {
+            auto _summary = get_thread_summary(_thread_results);
+            if(!_summary.empty())
+            {
+                auto              _prec = ObjectType::get_precision();
+                auto              _unit = ObjectType::get_display_unit();
+                std::stringstream _oss;
+                _oss << "\n" << std::setw(_width) << std::left
+                     << "> [thread summary]" << std::right << " : " << std::setw(8)
+                     << "threads" << std::setw(_prec + 10) << "min" << std::setw(_prec + 10)
+                     << "max" << std::setw(_prec + 10) << "mean"
+                     << std::setw(_prec + 10) << "stddev"
+                     << "  [" << _unit << "]\n";
+                _oss << std::fixed << std::setprecision(_prec);
+                for(const auto& itr : _summary)
+                {
+                    if(itr.depth < 0 || itr.depth > settings::max_depth())
+                        continue;
+                    _oss << std::setw(_width) << std::left << itr.prefix << std::right
+                         << " : " << std::setw(8) << itr.nthreads << std::setw(_prec + 10)
+                         << itr.min << std::setw(_prec + 10) << itr.max
+                         << std::setw(_prec + 10) << itr.mean() << std::setw(_prec + 10)
+                         << itr.stddev() << "\n";
+                }
+                if(cout != nullptr)
+                    *cout << _oss.str() << std::flush;
+                if(fout != nullptr)
+                    *fout << _oss.str() << std::flush;
+            }
+        }
+
         if(fout)
         {
             fout->close();
@@ -681,8 +1108,9 @@ void storage<ObjectType, true>::external_print(std::false_type)
         {
             printf("\n");
             uint64_t _nitr = 0;
-            for(auto& itr : _results)
+            for(size_t i = 0; i < _results.size(); ++i)
             {
+                auto& itr       = _results.at(i);
                 auto& itr_depth = std::get<3>(itr);
 
                 if(itr_depth < 0 || itr_depth > settings::max_depth())
@@ -692,6 +1120,9 @@ void storage<ObjectType, true>::external_print(std::false_type)
                 if(settings::dart_count() > 0 && _nitr >= settings::dart_count())
                     continue;
 
+                if(!_entries.empty())
+                    std::get<5>(itr) = get_entry_hierarchy(_entries.at(i));
+
                 auto& itr_obj       = std::get<1>(itr);
                 auto& itr_hierarchy = std::get<5>(itr);
                 operation::echo_measurement<ObjectType>(itr_obj, itr_hierarchy);
@@ -742,7 +1173,14 @@ void
 storage<ObjectType, true>::serialize_me(std::false_type, Archive& ar,
                                         const unsigned int version)
 {
-    auto&& graph_list = get();
+    bool _thread_output  = settings::thread_output() || has_thread_results();
+    auto _thread_results = (_thread_output && singleton_t::is_master(this))
+                               ? get_thread_results()
+                               : thread_result_array_type{};
+    // the hierarchy of each entry is not serialized so it is not built
+    auto   _max_depth = std::numeric_limits<int64_t>::max();
+    auto&& graph_list = (_thread_results.empty()) ? get(get_entries(), _max_depth, false)
+                                                  : _thread_results.front().second;
     if(graph_list.size() == 0)
         return;
 
@@ -751,19 +1189,10 @@ storage<ObjectType, true>::serialize_me(std::false_type, Archive& ar,
        serializer::make_nvp("unit_value", ObjectType::unit()),
        serializer::make_nvp("unit_repr", ObjectType::display_unit()));
     ObjectType::serialization_policy(ar, version);
-    ar.setNextName("graph");
-    ar.startNode();
-    ar.makeArray();
-    for(auto& itr : graph_list)
-    {
-        ar.startNode();
-        ar(serializer::make_nvp("hash", std::get<0>(itr)),
-           serializer::make_nvp("prefix", std::get<2>(itr)),
-           serializer::make_nvp("depth", std::get<3>(itr)),
-           serializer::make_nvp("entry", std::get<1>(itr)));
-        ar.finishNode();
-    }
-    ar.finishNode();
+    if(_thread_results.empty())
+        serialize_graph(ar, graph_list);
+    else
+        serialize_threads(ar, _thread_results);
 }
 
 //======================================================================================//
@@ -774,7 +1203,14 @@ void
 storage<ObjectType, true>::serialize_me(std::true_type, Archive& ar,
                                         const unsigned int version)
 {
-    auto&& graph_list = get();
+    bool _thread_output  = settings::thread_output() || has_thread_results();
+    auto _thread_results = (_thread_output && singleton_t::is_master(this))
+                               ? get_thread_results()
+                               : thread_result_array_type{};
+    // the hierarchy of each entry is not serialized so it is not built
+    auto   _max_depth = std::numeric_limits<int64_t>::max();
+    auto&& graph_list = (_thread_results.empty()) ? get(get_entries(), _max_depth, false)
+                                                  : _thread_results.front().second;
     if(graph_list.size() == 0)
         return;
 
@@ -788,16 +1224,90 @@ storage<ObjectType, true>::serialize_me(std::true_type, Archive& ar,
        serializer::make_nvp("unit_value", units),
        serializer::make_nvp("unit_repr", display_units));
     ObjectType::serialization_policy(ar, version);
+    if(_thread_results.empty())
+        serialize_graph(ar, graph_list);
+    else
+        serialize_threads(ar, _thread_results);
+}
+
+//======================================================================================//
+
+template <typename ObjectType>
+template <typename Archive>
+void
+storage<ObjectType, true>::serialize_graph(Archive&                 ar,
+                                              const result_array_type& graph_list)
+{
+    using calibrate_t = operation::calibrate<ObjectType>;
+
+    bool _overhead_correction =
+        settings::overhead_correction() && calibrate_t::is_calibrated();
+    std::vector<double> _descendant_overhead;
+    if(_overhead_correction)
+        _descendant_overhead = get_descendant_overhead(graph_list);
+
     ar.setNextName("graph");
     ar.startNode();
     ar.makeArray();
-    for(auto& itr : graph_list)
+    for(size_t i = 0; i < graph_list.size(); ++i)
     {
+        const auto& itr = graph_list.at(i);
         ar.startNode();
         ar(serializer::make_nvp("hash", std::get<0>(itr)),
            serializer::make_nvp("prefix", std::get<2>(itr)),
            serializer::make_nvp("depth", std::get<3>(itr)),
            serializer::make_nvp("entry", std::get<1>(itr)));
+        if(_overhead_correction)
+        {
+            auto _corrected = std::get<1>(itr);
+            auto _estimate  = calibrate_t::node_estimate(std::get<0>(itr));
+            operation::compensate<ObjectType>(_corrected, _descendant_overhead.at(i));
+            ar(serializer::make_nvp("overhead_estimate", _estimate),
+               serializer::make_nvp("descendant_overhead", _descendant_overhead.at(i)),
+               serializer::make_nvp("overhead_corrected", _corrected));
+        }
+        ar.finishNode();
+    }
+    ar.finishNode();
+}
+
+//======================================================================================//
+
+template <typename ObjectType>
+template <typename Archive>
+void
+storage<ObjectType, true>::serialize_threads(Archive&                        ar,
+                                                const thread_result_array_type& _threads)
+{
+    ar.setNextName("threads");
+    ar.startNode();
+    ar.makeArray();
+    for(const auto& itr : _threads)
+    {
+        ar.startNode();
+        ar(serializer::make_nvp("thread_id", itr.first));
+        serialize_graph(ar, itr.second);
+        ar.finishNode();
+    }
+    ar.finishNode();
+
+    auto _summary = get_thread_summary(_threads);
+    if(_summary.empty())
+        return;
+
+    ar.setNextName("thread_summary");
+    ar.startNode();
+    ar.makeArray();
+    for(const auto& itr : _summary)
+    {
+        ar.startNode();
+        ar(serializer::make_nvp("hash", itr.hash),
+           serializer::make_nvp("prefix", itr.prefix),
+           serializer::make_nvp("depth", itr.depth),
+           serializer::make_nvp("nthreads", itr.nthreads),
+           serializer::make_nvp("min", itr.min), serializer::make_nvp("max", itr.max),
+           serializer::make_nvp("mean", itr.mean()),
+           serializer::make_nvp("stddev", itr.stddev()));
         ar.finishNode();
     }
     ar.finishNode();
@@ -858,6 +1368,27 @@ storage<ObjectType, true>::get_shared_manager()
     bool   _is_master = singleton_t::is_master(this);
     func_t _finalize  = [&]() { this_type::get_singleton().reset(this); };
     m_manager->add_finalizer(std::move(_finalize), _is_master);
+
+    // tim::thread_exit(). The master instance is still being constructed when it gets
+    // here so is_master(this) is not reliable
+    if(!singleton_t::is_master_thread())
+    {
+        func_t _merge = [&]() {
+            this_type::master_instance()->merge(this);
+            clear_graph();
+        };
+        m_manager->add_merger(std::move(_merge));
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+//  the index of the thread-local manager of the thread which owns this instance
+//
+template <typename ObjectType>
+int64_t
+storage<ObjectType, true>::thread_index() const
+{
+    return (m_manager) ? m_manager->instance_count() : m_instance_id;
 }
 
 //--------------------------------------------------------------------------------------//
@@ -0,0 +1,411 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory/utility/crash_dump.hpp
+ * \headerfile crash_dump.hpp "timemory/utility/crash_dump.hpp"
+ * Async-signal-safe emergency dump of the in-flight call-graphs. Every storage
+ * instance registers a plain function pointer into a fixed-size registry when its
+ * graph is created. When a termination signal is caught, the registry is walked and
+ * each graph node is written as a fixed-width binary record into a preallocated
+ * buffer that is flushed with write(2) only. The hash-to-label mapping is written
+ * separately (text, one "hash<TAB>label" per line) as new graph nodes are created so
+ * that nothing string-related has to happen inside the signal handler.
+ *
+ * Binary layout (native endianness):
+ *
+ *      header_t                                (once)
+ *      { section_t, record_t..., end-record }  (once per registered storage)
+ *
+ * The end-record of each section has a depth of -1 so that a graph which is being
+ * modified on another thread while the dump happens still produces a parseable file.
+ *
+ */
+
+#pragma once
+
+#include "timemory/bits/settings.hpp"
+#include "timemory/utility/macros.hpp"
+#include "timemory/utility/utility.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#if defined(_UNIX)
+#    include <cerrno>
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
+namespace tim
+{
+//--------------------------------------------------------------------------------------//
+//
+//          crash_dump
+//
+//--------------------------------------------------------------------------------------//
+
+class crash_dump
+{
+public:
+    static constexpr size_t max_storage = 4096;
+    static constexpr size_t buffer_size = 64 * 1024;
+    static constexpr size_t label_size  = 64;
+    static constexpr size_t path_size   = 1024;
+
+    struct header_t
+    {
+        char     magic[8];  // "TIMCRASH"
+        uint32_t version;
+        int32_t  signal;
+        int64_t  pid;
+        uint64_t nstorage;
+    };
+
+    struct section_t
+    {
+        char     label[label_size];
+        int64_t  instance_id;
+    };
+
+    struct record_t
+    {
+        uint64_t hash;
+        int64_t  depth;
+        int64_t  laps;
+        double   accum;  // NaN when the value type is not arithmetic
+    };
+
+    //----------------------------------------------------------------------------------//
+    //  buffered writer which only uses write(2)
+    //
+    class writer
+    {
+    public:
+        explicit writer(int _fd)
+        : m_fd(_fd)
+        {}
+
+        ~writer() { flush(); }
+
+        writer(const writer&) = delete;
+        writer& operator=(const writer&) = delete;
+
+        void append(const void* _data, size_t _len)
+        {
+            auto _src = static_cast<const char*>(_data);
+            while(_len > 0)
+            {
+                if(m_size == buffer_size)
+                    flush();
+                size_t _n = buffer_size - m_size;
+                if(_n > _len)
+                    _n = _len;
+                memcpy(buffer() + m_size, _src, _n);
+                m_size += _n;
+                _src += _n;
+                _len -= _n;
+            }
+        }
+
+        void record(uint64_t _hash, int64_t _depth, int64_t _laps, double _accum)
+        {
+            record_t _rec;
+            _rec.hash  = _hash;
+            _rec.depth = _depth;
+            _rec.laps  = _laps;
+            _rec.accum = _accum;
+            append(&_rec, sizeof(record_t));
+        }
+
+        void end_section() { record(0, -1, 0, 0.0); }
+
+        void flush()
+        {
+            crash_dump::write_all(m_fd, buffer(), m_size);
+            m_size = 0;
+        }
+
+    private:
+        // preallocated per-process emergency buffer
+        static char* buffer()
+        {
+            static char _instance[buffer_size];
+            return _instance;
+        }
+
+        int    m_fd   = -1;
+        size_t m_size = 0;
+    };
+
+    using dump_func_t = void (*)(const void*, writer&);
+
+public:
+    //----------------------------------------------------------------------------------//
+    //  called (outside of signal context) when a storage instance creates its graph
+    //
+    static void insert(const void* _obj, const std::string& _label, int64_t _id,
+                       dump_func_t _dump)
+    {
+        if(!enabled())
+            return;
+
+        for(auto& itr : registry())
+        {
+            int32_t _free = state_free;
+            if(!itr.state.compare_exchange_strong(_free, state_claimed))
+                continue;
+            itr.object      = _obj;
+            itr.instance_id = _id;
+            itr.dump        = _dump;
+            strncpy(itr.label, _label.c_str(), label_size - 1);
+            itr.label[label_size - 1] = '\0';
+            itr.state.store(state_active, std::memory_order_release);
+            return;
+        }
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  called before a storage instance releases its graph
+    //
+    static void erase(const void* _obj)
+    {
+        for(auto& itr : registry())
+        {
+            if(itr.state.load(std::memory_order_acquire) == state_active &&
+               itr.object == _obj)
+            {
+                itr.object = nullptr;
+                itr.state.store(state_free, std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  lazily append to the hash-to-label file (never called from a signal handler)
+    //
+    static void add_label(uint64_t _hash, const std::string& _label)
+    {
+        if(!enabled())
+            return;
+
+        std::lock_guard<std::mutex> _lk(label_mutex());
+        auto&                       _state = label_state();
+        if(!_state.written.insert(_hash).second)
+            return;
+
+#if defined(_UNIX)
+        if(_state.fd < 0)
+            _state.fd =
+                ::open(label_path(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        if(_state.fd < 0)
+            return;
+        std::string _line = std::to_string(_hash) + "\t" + _label + "\n";
+        write_all(_state.fd, _line.c_str(), _line.length());
+#else
+        consume_parameters(_label);
+#endif
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  async-signal-safe: open(2), write(2), close(2) and plain memory access only
+    //
+    static void dump(int _signal)
+    {
+#if defined(_UNIX)
+        // paths are only non-empty after a successful configure()
+        if(dump_path()[0] == '\0')
+            return;
+
+        // do not recurse if we crash while dumping
+        static std::atomic<bool> _dumping(false);
+        if(_dumping.exchange(true))
+            return;
+
+        int _fd = ::open(dump_path(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(_fd < 0)
+            return;
+
+        header_t _header;
+        memset(&_header, 0, sizeof(header_t));
+        memcpy(_header.magic, "TIMCRASH", 8);
+        _header.version = 1;
+        _header.signal  = _signal;
+        _header.pid     = static_cast<int64_t>(::getpid());
+        for(auto& itr : registry())
+            if(itr.state.load(std::memory_order_acquire) == state_active)
+                ++_header.nstorage;
+
+        {
+            writer _writer(_fd);
+            _writer.append(&_header, sizeof(header_t));
+            for(auto& itr : registry())
+            {
+                if(itr.state.load(std::memory_order_acquire) != state_active)
+                    continue;
+                section_t _section;
+                memset(&_section, 0, sizeof(section_t));
+                memcpy(_section.label, itr.label, label_size);
+                _section.instance_id = itr.instance_id;
+                _writer.append(&_section, sizeof(section_t));
+                (*itr.dump)(itr.object, _writer);
+                _writer.end_section();
+            }
+        }
+        ::close(_fd);
+#else
+        consume_parameters(_signal);
+#endif
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  the output paths are composed once, outside of the signal handler
+    //
+    static bool enabled() { return enabled_flag(); }
+
+    //----------------------------------------------------------------------------------//
+    //  re-read settings::crash_dump(), e.g. after it was changed at runtime or in a
+    //  forked child which needs a dump file of its own. Only the storage graphs which
+    //  are created after this call are registered
+    //
+    static bool reconfigure() { return (enabled_flag() = configure()); }
+
+    static const char* dump_path() { return paths().first.data(); }
+    static const char* label_path() { return paths().second.data(); }
+
+private:
+    enum : int32_t
+    {
+        state_free    = 0,
+        state_claimed = 1,
+        state_active  = 2
+    };
+
+    struct entry_t
+    {
+        std::atomic<int32_t> state;
+        const void*          object;
+        int64_t              instance_id;
+        dump_func_t          dump;
+        char                 label[label_size];
+    };
+
+    using registry_t = std::array<entry_t, max_storage>;
+    using path_t     = std::array<char, path_size>;
+
+    static registry_t& registry()
+    {
+        // zero-initialized static storage: no allocation, safe to read in a handler
+        static registry_t _instance;
+        return _instance;
+    }
+
+    static std::pair<path_t, path_t>& paths()
+    {
+        static std::pair<path_t, path_t> _instance;
+        return _instance;
+    }
+
+    static bool& enabled_flag()
+    {
+        static bool _instance = configure();
+        return _instance;
+    }
+
+    static std::mutex& label_mutex()
+    {
+        static std::mutex _instance;
+        return _instance;
+    }
+
+    // the labels written to the file at the current label path
+    struct label_state_t
+    {
+        int                          fd = -1;
+        std::unordered_set<uint64_t> written;
+    };
+
+    static label_state_t& label_state()
+    {
+        static label_state_t _instance;
+        return _instance;
+    }
+
+    static bool configure()
+    {
+#if defined(_UNIX)
+        // the label file of the previous configuration (e.g. inherited from the parent
+        // of a forked child) is not reused: it is reopened for the new path
+        {
+            std::lock_guard<std::mutex> _lk(label_mutex());
+            auto&                       _state = label_state();
+            if(_state.fd >= 0)
+                ::close(_state.fd);
+            _state.fd = -1;
+            _state.written.clear();
+        }
+        paths().first[0]  = '\0';
+        paths().second[0] = '\0';
+        if(!settings::crash_dump())
+            return false;
+        auto _tag  = std::string("crash_dump_") + std::to_string(::getpid());
+        auto _dump = settings::compose_output_filename(_tag, ".bin");
+        auto _lbls = settings::compose_output_filename(_tag + "_labels", ".txt");
+        if(_dump.length() >= path_size || _lbls.length() >= path_size)
+            return false;
+        strncpy(paths().first.data(), _dump.c_str(), path_size - 1);
+        strncpy(paths().second.data(), _lbls.c_str(), path_size - 1);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static void write_all(int _fd, const char* _data, size_t _len)
+    {
+#if defined(_UNIX)
+        while(_fd >= 0 && _len > 0)
+        {
+            auto _ret = ::write(_fd, _data, _len);
+            if(_ret < 0 && errno == EINTR)
+                continue;
+            if(_ret <= 0)
+                return;
+            _data += _ret;
+            _len -= static_cast<size_t>(_ret);
+        }
+#else
+        consume_parameters(_fd, _data, _len);
+#endif
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+
+}  // namespace tim
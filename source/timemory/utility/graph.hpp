@@ -967,10 +967,10 @@ graph<T, AllocatorT>::erase_children(const iterator_base& it)
 
     while(cur != 0)
     {
-        graph_node* prev = 0;
+        graph_node* prev = cur;
         cur              = cur->next_sibling;
         erase_children(pre_order_iterator(prev));
-        // m_alloc.destroy(prev);
+        m_alloc.destroy(prev);
         m_alloc.deallocate(prev, 1);
     }
     it.node->first_child = 0;
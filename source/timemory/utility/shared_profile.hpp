@@ -0,0 +1,782 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory/utility/shared_profile.hpp
+ * \headerfile shared_profile.hpp "timemory/utility/shared_profile.hpp"
+ * Aggregation of the call-graphs of pre-forked worker processes (e.g. a server which
+ * forks its workers once at startup) without MPI. The parent process creates a
+ * shared-memory segment (shm_open + mmap) before forking. Each process which
+ * inherits the mapping claims its own slot with an atomic counter and publishes its
+ * flattened call-graph (hash, depth, laps, accumulated value, label) into that slot
+ * at exit or on demand via shared_profile::publish(). At exit, the parent reduces
+ * all of the published slots into one profile.
+ *
+ * Segment layout (native endianness):
+ *
+ *      header_t                                                    (once)
+ *      { slot_header_t, { section_t, { record_t, label }... }... } (once per slot)
+ *
+ * Publishing uses a sequence counter per slot (odd while the slot is being written)
+ * so the parent never reduces a partially written slot.
+ *
+ * Notes:
+ *  - the segment must be created before forking: either call timemory_init(...) or
+ *    shared_profile::create() with settings::shared_profile() enabled
+ *  - only the call-graphs created while settings::shared_profile() is enabled are
+ *    published, i.e. enable it before the first measurement
+ *  - data recorded by the parent before the fork is inherited (and published) by
+ *    every child
+ *  - the parent should wait for its children before exiting
+ *  - children which exit with _exit(...) must call shared_profile::publish() first
+ *
+ */
+
+#pragma once
+
+#include "timemory/bits/settings.hpp"
+#include "timemory/utility/macros.hpp"
+#include "timemory/utility/utility.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#if defined(_UNIX)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace tim
+{
+//--------------------------------------------------------------------------------------//
+//
+//          shared_profile
+//
+//--------------------------------------------------------------------------------------//
+
+class shared_profile
+{
+public:
+    static constexpr size_t type_size = 64;
+    static constexpr size_t unit_size = 16;
+
+    struct header_t
+    {
+        char                  magic[8];  // "TIMSHMPF"
+        uint32_t              version;
+        uint32_t              max_slots;
+        uint64_t              slot_size;
+        int64_t               parent_pid;
+        std::atomic<uint32_t> next_slot;
+        std::atomic<uint32_t> overflow;
+    };
+
+    struct slot_header_t
+    {
+        std::atomic<uint64_t> sequence;  // odd while being written
+        int64_t               pid;
+        uint64_t              used;
+        uint32_t              truncated;
+        uint32_t              reserved;
+    };
+
+    struct section_t
+    {
+        char     type[type_size];
+        char     unit[unit_size];
+        int32_t  precision;
+        uint32_t nrecords;
+    };
+
+    struct record_t
+    {
+        uint64_t hash;
+        int64_t  depth;
+        uint64_t rolling;
+        int64_t  laps;
+        double   value;  // NaN when the value type is not arithmetic
+        uint32_t label_len;
+        uint32_t reserved;
+    };
+
+    // one entry of the reduced profile
+    struct result_type
+    {
+        std::string type      = "";
+        std::string unit      = "";
+        int32_t     precision = 3;
+        uint64_t    hash      = 0;
+        int64_t     depth     = 0;
+        uint64_t    rolling   = 0;
+        std::string label     = "";
+        int64_t     nprocs    = 0;
+        int64_t     laps      = 0;
+        double      sum       = 0.0;
+        double      min       = std::numeric_limits<double>::max();
+        double      max       = std::numeric_limits<double>::lowest();
+
+        double mean() const { return (nprocs > 0) ? (sum / nprocs) : 0.0; }
+    };
+    using result_array_type = std::vector<result_type>;
+
+    //----------------------------------------------------------------------------------//
+    //  bounds-checked writer into the slot of this process
+    //
+    class writer
+    {
+    public:
+        writer(char* _data, size_t _capacity)
+        : m_data(_data)
+        , m_capacity(_capacity)
+        {}
+
+        writer(const writer&) = delete;
+        writer& operator=(const writer&) = delete;
+
+        void begin_section(const std::string& _type, const std::string& _unit,
+                           int32_t _precision)
+        {
+            section_t _section;
+            memset(&_section, 0, sizeof(section_t));
+            strncpy(_section.type, _type.c_str(), type_size - 1);
+            strncpy(_section.unit, _unit.c_str(), unit_size - 1);
+            _section.precision = _precision;
+            m_section          = m_size;
+            m_nrecords         = 0;
+            if(!append(&_section, sizeof(section_t)))
+                m_section = npos;
+        }
+
+        void record(uint64_t _hash, int64_t _depth, uint64_t _rolling, int64_t _laps,
+                    double _value, const std::string& _label)
+        {
+            if(m_section == npos)
+                return;
+            record_t _rec;
+            memset(&_rec, 0, sizeof(record_t));
+            _rec.hash      = _hash;
+            _rec.depth     = _depth;
+            _rec.rolling   = _rolling;
+            _rec.laps      = _laps;
+            _rec.value     = _value;
+            _rec.label_len = static_cast<uint32_t>(_label.length());
+            if(m_size + sizeof(record_t) + padded(_label.length()) > m_capacity)
+            {
+                m_truncated = true;
+                return;
+            }
+            append(&_rec, sizeof(record_t));
+            append(_label.c_str(), _label.length());
+            m_size = padded(m_size);
+            ++m_nrecords;
+        }
+
+        void end_section()
+        {
+            if(m_section == npos)
+                return;
+            auto _section = reinterpret_cast<section_t*>(m_data + m_section);
+            _section->nrecords = m_nrecords;
+            m_section          = npos;
+        }
+
+        size_t size() const { return m_size; }
+        bool   truncated() const { return m_truncated; }
+
+        static size_t padded(size_t _n) { return (_n + 7) & ~static_cast<size_t>(7); }
+
+    private:
+        static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+        bool append(const void* _src, size_t _len)
+        {
+            if(m_size + _len > m_capacity)
+            {
+                m_truncated = true;
+                return false;
+            }
+            memcpy(m_data + m_size, _src, _len);
+            m_size += _len;
+            return true;
+        }
+
+        char*    m_data      = nullptr;
+        size_t   m_capacity  = 0;
+        size_t   m_size      = 0;
+        size_t   m_section   = npos;
+        uint32_t m_nrecords  = 0;
+        bool     m_truncated = false;
+    };
+
+    using publish_func_t = void (*)(void*, writer&);
+    using merge_func_t   = void (*)(void*);
+    using lock_t         = std::lock_guard<std::recursive_mutex>;
+
+public:
+    //----------------------------------------------------------------------------------//
+    //  called by a storage instance when its graph is created. A recycled instance
+    //  creates a new graph without being destroyed so it may already be registered
+    //
+    static void insert(void* _obj, publish_func_t _func, merge_func_t _merge = nullptr)
+    {
+        if(!settings::shared_profile())
+            return;
+
+        lock_t _lk(registry_mutex());
+        auto&  _reg = registry();
+        for(const auto& itr : _reg)
+        {
+            if(itr.object == _obj)
+                return;
+        }
+        _reg.push_back(entry_t{ _obj, _func, _merge });
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  called before a storage instance releases its graph
+    //
+    static void erase(void* _obj)
+    {
+        lock_t _lk(registry_mutex());
+        auto&  _reg = registry();
+        _reg.erase(std::remove_if(_reg.begin(), _reg.end(),
+                                  [_obj](const entry_t& itr) { return itr.object == _obj; }),
+                   _reg.end());
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  create and map the segment. Must be called in the parent before forking
+    //
+    static bool create()
+    {
+#if defined(_UNIX)
+        if(!settings::shared_profile() || header() != nullptr)
+            return (header() != nullptr);
+
+        auto _nslots    = std::max<uint64_t>(settings::shared_profile_slots(), 1);
+        auto _slot_size = writer::padded(
+            std::max<uint64_t>(settings::shared_profile_slot_size(), 4096));
+        auto _size = header_size() + _nslots * _slot_size;
+        auto _name = std::string("/timemory-shared-profile-") + std::to_string(::getpid());
+
+        int _fd = ::shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if(_fd < 0)
+        {
+            fprintf(stderr, "[timemory]> shared_profile: shm_open('%s') failed: %s\n",
+                    _name.c_str(), strerror(errno));
+            return false;
+        }
+
+        void* _ptr = MAP_FAILED;
+        if(::ftruncate(_fd, static_cast<off_t>(_size)) == 0)
+            _ptr = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+        ::close(_fd);
+        // the mapping is inherited across fork(): the name is no longer needed and
+        // unlinking now means the segment cannot leak if the parent crashes
+        ::shm_unlink(_name.c_str());
+
+        if(_ptr == MAP_FAILED)
+        {
+            fprintf(stderr, "[timemory]> shared_profile: mapping %llu bytes failed: %s\n",
+                    static_cast<unsigned long long>(_size), strerror(errno));
+            return false;
+        }
+
+        // ftruncate zero-fills so every slot starts with an even (empty) sequence
+        auto _header = new(_ptr) header_t;
+        memcpy(_header->magic, "TIMSHMPF", 8);
+        _header->version    = 1;
+        _header->max_slots  = static_cast<uint32_t>(_nslots);
+        _header->slot_size  = _slot_size;
+        _header->parent_pid = static_cast<int64_t>(::getpid());
+        _header->next_slot.store(0, std::memory_order_relaxed);
+        _header->overflow.store(0, std::memory_order_relaxed);
+        for(uint32_t i = 0; i < _header->max_slots; ++i)
+            new(slot_base(_header, i)) slot_header_t;
+
+        mapping() = { _ptr, _size };
+        // normally invoked earlier by the exit hook of the manager: this covers a
+        // parent which never records anything itself
+        std::atexit(&shared_profile::finalize);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  write the current call-graphs of this process into its slot. May be called
+    //  more than once: each call overwrites the previous contents of the slot
+    //
+    static bool publish()
+    {
+#if defined(_UNIX)
+        auto _header = header();
+        if(_header == nullptr)
+            return false;
+
+        // a forked child inherits the slot index of its parent, so the claim is
+        // keyed on the process id
+        auto  _pid   = static_cast<int64_t>(::getpid());
+        auto& _claim = claimed();
+        if(_claim.first != _pid)
+        {
+            auto _idx = _header->next_slot.fetch_add(1, std::memory_order_acq_rel);
+            if(_idx >= _header->max_slots)
+            {
+                _header->overflow.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            _claim = { _pid, _idx };
+        }
+
+        auto _slot = reinterpret_cast<slot_header_t*>(slot_base(_header, _claim.second));
+        // seqlock write: the odd sequence must be visible before any byte of the
+        // payload and the payload before the even sequence
+        auto _seq  = _slot->sequence.load(std::memory_order_relaxed);
+        _slot->sequence.store(_seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acq_rel);
+
+        writer _writer(slot_data(_header, _claim.second),
+                       _header->slot_size - slot_header_size());
+        {
+            lock_t _lk(registry_mutex());
+            for(auto& itr : registry())
+                (*itr.publish)(itr.object, _writer);
+        }
+
+        _slot->pid       = _pid;
+        _slot->used      = _writer.size();
+        _slot->truncated = (_writer.truncated()) ? 1 : 0;
+        _slot->sequence.store(_seq + 2, std::memory_order_release);
+
+        if(_writer.truncated())
+            fprintf(stderr,
+                    "[timemory]> shared_profile: output of process %lli was truncated. "
+                    "Increase TIMEMORY_SHARED_PROFILE_SLOT_SIZE (currently %llu)\n",
+                    static_cast<long long>(_pid),
+                    static_cast<unsigned long long>(_header->slot_size));
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  combine the published slots: entries with the same type, hash, depth, and
+    //  rolling hash are merged. Ordering is by first appearance. The number of slots
+    //  which were reduced is stored in _nprocs (when provided)
+    //
+    static result_array_type reduce(uint32_t* _nprocs = nullptr)
+    {
+        result_array_type _results;
+        auto              _header = header();
+        if(_header == nullptr)
+            return _results;
+
+        using key_t = std::tuple<std::string, uint64_t, int64_t, uint64_t>;
+        std::map<key_t, size_t> _index;
+        std::vector<char>       _buffer;
+        uint32_t                _nreduced = 0;
+
+        auto _nslots = std::min<uint32_t>(
+            _header->next_slot.load(std::memory_order_acquire), _header->max_slots);
+        for(uint32_t i = 0; i < _nslots; ++i)
+        {
+            if(!copy_slot(_header, i, _buffer))
+                continue;
+            ++_nreduced;
+
+            const char* _ptr = _buffer.data();
+            const char* _end = _buffer.data() + _buffer.size();
+            while(_ptr + sizeof(section_t) <= _end)
+            {
+                section_t _section;
+                memcpy(&_section, _ptr, sizeof(section_t));
+                _ptr += sizeof(section_t);
+                _section.type[type_size - 1] = '\0';
+                _section.unit[unit_size - 1] = '\0';
+                std::string _type            = _section.type;
+
+                for(uint32_t j = 0; j < _section.nrecords; ++j)
+                {
+                    if(_ptr + sizeof(record_t) > _end)
+                        break;
+                    record_t _rec;
+                    memcpy(&_rec, _ptr, sizeof(record_t));
+                    _ptr += sizeof(record_t);
+                    if(_ptr + _rec.label_len > _end)
+                        break;
+                    std::string _label(_ptr, _rec.label_len);
+                    _ptr += writer::padded(_rec.label_len);
+
+                    auto _key  = key_t(_type, _rec.hash, _rec.depth, _rec.rolling);
+                    auto _iitr = _index.find(_key);
+                    if(_iitr == _index.end())
+                    {
+                        result_type _entry;
+                        _entry.type      = _type;
+                        _entry.unit      = _section.unit;
+                        _entry.precision = _section.precision;
+                        _entry.hash      = _rec.hash;
+                        _entry.depth     = _rec.depth;
+                        _entry.rolling   = _rec.rolling;
+                        _entry.label     = _label;
+                        _iitr            = _index.insert({ _key, _results.size() }).first;
+                        _results.push_back(_entry);
+                    }
+
+                    auto& _entry = _results.at(_iitr->second);
+                    _entry.nprocs += 1;
+                    _entry.laps += _rec.laps;
+                    _entry.sum += _rec.value;
+                    _entry.min = std::min(_entry.min, _rec.value);
+                    _entry.max = std::max(_entry.max, _rec.value);
+                }
+            }
+        }
+        if(_nprocs)
+            *_nprocs = _nreduced;
+        return _results;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  invoked from the exit hook of the manager. A child publishes and suppresses its
+    //  own per-process output, the parent reduces and writes the combined profile
+    //
+    static void finalize()
+    {
+#if defined(_UNIX)
+        auto _header = header();
+        auto _pid    = static_cast<int64_t>(::getpid());
+        if(_header == nullptr || finalized() == _pid)
+            return;
+        finalized() = _pid;
+
+        // the call-graphs of the threads which are still alive have not been merged
+        // into their master instance yet
+        merge_workers();
+
+        if(_pid != _header->parent_pid)
+        {
+            publish();
+            settings::file_output() = false;
+            settings::cout_output() = false;
+            return;
+        }
+
+        publish();
+        uint32_t _nprocs  = 0;
+        auto     _results = reduce(&_nprocs);
+        if(_header->overflow.load() > 0)
+            fprintf(stderr,
+                    "[timemory]> shared_profile: %u processes were not recorded. "
+                    "Increase TIMEMORY_SHARED_PROFILE_SLOTS (currently %u)\n",
+                    _header->overflow.load(), _header->max_slots);
+
+        if(!_results.empty())
+        {
+            std::stringstream _oss;
+            print(_oss, _results, _nprocs);
+
+            if(settings::cout_output())
+                std::cout << _oss.str() << std::flush;
+
+            if(settings::file_output())
+            {
+                auto          _fname = settings::compose_output_filename("shared_profile",
+                                                                ".txt");
+                std::ofstream _ofs(_fname.c_str());
+                if(_ofs)
+                {
+                    printf("[shared_profile]> Outputting '%s'...\n", _fname.c_str());
+                    _ofs << _oss.str();
+                }
+            }
+
+            if(settings::json_output())
+            {
+                auto          _fname = settings::compose_output_filename("shared_profile",
+                                                                ".json");
+                std::ofstream _ofs(_fname.c_str());
+                if(_ofs)
+                {
+                    printf("[shared_profile]> Outputting '%s'...\n", _fname.c_str());
+                    write_json(_ofs, _results, _nprocs);
+                }
+            }
+        }
+
+        release();
+#endif
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  unmap the segment in this process without publishing or reducing
+    //
+    static void release()
+    {
+#if defined(_UNIX)
+        if(header() == nullptr)
+            return;
+        ::munmap(mapping().first, mapping().second);
+        mapping() = { nullptr, 0 };
+#endif
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static void print(std::ostream& os, const result_array_type& _results,
+                      uint32_t _nprocs)
+    {
+        size_t _width = 0;
+        for(const auto& itr : _results)
+            _width = std::max(_width, indented(itr).length());
+
+        std::string _type = "";
+        for(const auto& itr : _results)
+        {
+            if(itr.depth < 0 || itr.depth > settings::max_depth())
+                continue;
+            auto _prec = std::max<int32_t>(itr.precision, 0);
+            if(itr.type != _type)
+            {
+                _type = itr.type;
+                os << "\n[" << _type << "]|0> Combined profile of " << _nprocs
+                   << " processes:\n\n"
+                   << std::setw(_width) << std::left << "> [label]" << std::right
+                   << " : " << std::setw(8) << "procs" << std::setw(10) << "laps"
+                   << std::setw(_prec + 12) << "sum" << std::setw(_prec + 10) << "mean"
+                   << std::setw(_prec + 10) << "min" << std::setw(_prec + 10) << "max"
+                   << "  [" << itr.unit << "]\n";
+            }
+            std::stringstream _ss;
+            _ss << std::fixed << std::setprecision(_prec);
+            _ss << std::setw(_width) << std::left << indented(itr) << std::right << " : "
+                << std::setw(8) << itr.nprocs << std::setw(10) << itr.laps
+                << std::setw(_prec + 12) << itr.sum << std::setw(_prec + 10)
+                << itr.mean() << std::setw(_prec + 10) << itr.min
+                << std::setw(_prec + 10) << itr.max << "\n";
+            os << _ss.str();
+        }
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static void write_json(std::ostream& os, const result_array_type& _results,
+                           uint32_t _nprocs)
+    {
+        auto _value = [](double _v) {
+            std::stringstream _ss;
+            _ss << std::setprecision(std::numeric_limits<double>::digits10 + 1);
+            if(std::isfinite(_v))
+                _ss << _v;
+            else
+                _ss << "null";
+            return _ss.str();
+        };
+
+        os << "{\n    \"timemory\": {\n        \"shared_profile\": {\n"
+           << "            \"nprocs\": " << _nprocs << ",\n"
+           << "            \"graph\": [";
+        for(size_t i = 0; i < _results.size(); ++i)
+        {
+            const auto& itr = _results.at(i);
+            os << ((i == 0) ? "\n" : ",\n") << "                { \"type\": \""
+               << escape(itr.type) << "\", \"unit\": \"" << escape(itr.unit)
+               << "\", \"hash\": " << itr.hash << ", \"depth\": " << itr.depth
+               << ", \"rolling\": " << itr.rolling << ", \"prefix\": \""
+               << escape(itr.label) << "\", \"nprocs\": " << itr.nprocs
+               << ", \"laps\": " << itr.laps << ", \"sum\": " << _value(itr.sum)
+               << ", \"mean\": " << _value(itr.mean()) << ", \"min\": "
+               << _value(itr.min) << ", \"max\": " << _value(itr.max) << " }";
+        }
+        os << "\n            ]\n        }\n    }\n}\n";
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static bool is_created() { return header() != nullptr; }
+
+private:
+    //----------------------------------------------------------------------------------//
+    //  the registry is indexed because a merge may append the master instance
+    //
+    static void merge_workers()
+    {
+        lock_t _lk(registry_mutex());
+        for(size_t i = 0; i < registry().size();)
+        {
+            auto _entry = registry().at(i);
+            if(_entry.merge)
+                (*_entry.merge)(_entry.object);
+            // a merged worker releases its graph, which removes it from the registry
+            if(i < registry().size() && registry().at(i).object == _entry.object)
+                ++i;
+        }
+    }
+
+    struct entry_t
+    {
+        void*          object;
+        publish_func_t publish;
+        merge_func_t   merge;
+    };
+
+    using registry_t = std::vector<entry_t>;
+    using mapping_t  = std::pair<void*, size_t>;
+
+    // intentionally leaked: finalize() runs from atexit after the static destructors
+    // of objects which were constructed after its registration
+    static registry_t& registry()
+    {
+        static auto _instance = new registry_t{};
+        return *_instance;
+    }
+
+    // recursive: merging a worker may create the graph of the master, which registers
+    // the master while the registry is locked
+    static std::recursive_mutex& registry_mutex()
+    {
+        static auto _instance = new std::recursive_mutex{};
+        return *_instance;
+    }
+
+    static mapping_t& mapping()
+    {
+        static mapping_t _instance = { nullptr, 0 };
+        return _instance;
+    }
+
+    // (process id, slot index) of the slot claimed by this process
+    static std::pair<int64_t, uint32_t>& claimed()
+    {
+        static std::pair<int64_t, uint32_t> _instance = { -1, 0 };
+        return _instance;
+    }
+
+    // process id of the last process which called finalize()
+    static int64_t& finalized()
+    {
+        static int64_t _instance = -1;
+        return _instance;
+    }
+
+    static header_t* header() { return static_cast<header_t*>(mapping().first); }
+
+    static size_t header_size() { return writer::padded(sizeof(header_t)); }
+    static size_t slot_header_size() { return writer::padded(sizeof(slot_header_t)); }
+
+    static char* slot_base(header_t* _header, uint32_t _idx)
+    {
+        return reinterpret_cast<char*>(_header) + header_size() +
+               static_cast<size_t>(_idx) * _header->slot_size;
+    }
+
+    static char* slot_data(header_t* _header, uint32_t _idx)
+    {
+        return slot_base(_header, _idx) + slot_header_size();
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  copy out a consistent snapshot of a slot. Returns false if the slot was never
+    //  published or was being re-published during every attempt
+    //
+    static bool copy_slot(header_t* _header, uint32_t _idx, std::vector<char>& _buffer)
+    {
+        auto _slot = reinterpret_cast<slot_header_t*>(slot_base(_header, _idx));
+        auto _cap  = _header->slot_size - slot_header_size();
+        for(int _attempt = 0; _attempt < 8; ++_attempt)
+        {
+            auto _beg = _slot->sequence.load(std::memory_order_acquire);
+            if(_beg == 0)
+                return false;
+            if(_beg % 2 != 0)
+                continue;
+            auto _used = std::min<uint64_t>(_slot->used, _cap);
+            _buffer.resize(_used);
+            memcpy(_buffer.data(), slot_data(_header, _idx), _used);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(_slot->sequence.load(std::memory_order_relaxed) == _beg)
+                return true;
+        }
+        return false;
+    }
+
+    static std::string indented(const result_type& itr)
+    {
+        std::string _indent = "";
+        if(itr.depth > 0)
+        {
+            for(int64_t i = 0; i < itr.depth - 1; ++i)
+                _indent += "  ";
+            _indent += "|_";
+        }
+        return _indent + itr.label;
+    }
+
+    static std::string escape(const std::string& _str)
+    {
+        std::stringstream _ss;
+        for(auto c : _str)
+        {
+            switch(c)
+            {
+                case '"': _ss << "\\\""; break;
+                case '\\': _ss << "\\\\"; break;
+                case '\n': _ss << "\\n"; break;
+                case '\t': _ss << "\\t"; break;
+                default:
+                    if(static_cast<unsigned char>(c) < 0x20)
+                        _ss << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                            << static_cast<int>(c) << std::dec << std::setfill(' ');
+                    else
+                        _ss << c;
+            }
+        }
+        return _ss.str();
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+
+}  // namespace tim
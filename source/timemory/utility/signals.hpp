@@ -40,6 +40,7 @@
 #include "timemory/backends/mpi.hpp"
 #include "timemory/backends/signals.hpp"
 #include "timemory/bits/settings.hpp"
+#include "timemory/utility/crash_dump.hpp"
 #include "timemory/utility/macros.hpp"
 #include "timemory/utility/utility.hpp"
 
@@ -295,6 +296,10 @@ timemory_termination_signal_handler(int sig, siginfo_t* sinfo, void* /* context
         ss << "signal " << sig << " not caught";
         throw std::runtime_error(ss.str());
     }
+
+    // write the in-flight graphs before anything that is not async-signal-safe
+    tim::crash_dump::dump(sig);
+
     std::stringstream message;
     tim::termination_signal_message(sig, sinfo, message);
 
@@ -27,8 +27,10 @@
  * \headerfile storage.hpp "timemory/utility/storage.hpp"
  * Storage of the call-graph for each component. Each component has a thread-local
  * singleton that hold the call-graph. When a worker thread is deleted, it merges
- * itself back into the master thread storage. When the master thread is deleted,
- * it handles I/O (i.e. text file output, JSON output, stdout output).
+ * itself back into the master thread storage (or, when settings::thread_output() is
+ * enabled, hands its call-graph to the master thread storage without merging). When
+ * the master thread is deleted, it handles I/O (i.e. text file output, JSON output,
+ * stdout output).
  *
  */
 
@@ -42,6 +44,8 @@
 #include "timemory/data/accumulators.hpp"
 #include "timemory/mpl/apply.hpp"
 #include "timemory/mpl/type_traits.hpp"
+#include "timemory/utility/crash_dump.hpp"
+#include "timemory/utility/shared_profile.hpp"
 #include "timemory/utility/graph.hpp"
 #include "timemory/utility/graph_data.hpp"
 #include "timemory/utility/macros.hpp"
@@ -54,10 +58,15 @@
 
 //--------------------------------------------------------------------------------------//
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -74,6 +83,10 @@ template <typename _Tp>
 using storage_smart_pointer = std::unique_ptr<_Tp, details::storage_deleter<_Tp>>;
 template <typename _Tp>
 using storage_singleton_t = singleton<_Tp, storage_smart_pointer<_Tp>>;
+// packed form of the call-graph of one component (native endianness):
+//      { packed_section, label, { packed_record, value, accum, prefix }... }
+struct packed_section { uint32_t label_size, value_size; uint64_t nrecords, nbytes; };
+struct packed_record  { uint64_t id; int64_t depth, level, laps; uint32_t prefix_size, transient; };
 }  // namespace details
 namespace cupti { struct result; }
 namespace impl  { template <typename ObjectType, bool IsAvailable> class storage {}; }
@@ -135,32 +148,131 @@ public:
                                    std::vector<std::string>>;
     using result_array_type = std::vector<result_type>;
 
-    using graph_node_tuple = std::tuple<uint64_t, ObjectType, int64_t>;
+    // (thread index, call-graph of that thread) when settings::thread_output() is set
+    using thread_result_type       = std::pair<int64_t, result_array_type>;
+    using thread_result_array_type = std::vector<thread_result_type>;
+
+    // cross-thread statistics of equivalent entries (same hash, depth, and rolling hash)
+    struct thread_summary_type
+    {
+        uint64_t hash     = 0;
+        string_t prefix   = "";
+        int64_t  depth    = 0;
+        int64_t  nthreads = 0;
+        double   min      = std::numeric_limits<double>::max();
+        double   max      = std::numeric_limits<double>::lowest();
+        double   sum      = 0.0;
+        double   sumsq    = 0.0;
+
+        double mean() const { return (nthreads > 0) ? (sum / nthreads) : 0.0; }
+        double stddev() const
+        {
+            if(nthreads < 2)
+                return 0.0;
+            auto _mean = mean();
+            return std::sqrt(std::max(sumsq / nthreads - _mean * _mean, 0.0));
+        }
+    };
+    using thread_summary_array_type = std::vector<thread_summary_type>;
+
+    //----------------------------------------------------------------------------------//
+    //  graph nodes of components which do not add data members to their base and which
+    //  accumulate through the operator+= of their base only store the accumulated data,
+    //  so that a pop updates the fields of the node in place. The live measurement
+    //  state (is_running, the graph iterator, etc.) stays in the object on the stack.
+    //  These are templates so that they are evaluated when graph_node is instantiated:
+    //  the storage class is instantiated by the base class of ObjectType, i.e. while
+    //  ObjectType is incomplete
+    //
+    template <typename _Tp>
+    using base_accumulate_t = _Tp& (_Tp::base_type::*)(const _Tp&);
+
+    template <typename _Tp>
+    static std::true_type check_base_accumulate(base_accumulate_t<_Tp>);
+
+    template <typename _Tp, typename = void>
+    struct base_accumulate : std::false_type
+    {};
+
+    // a member of the component itself does not implicitly convert to a pointer to a
+    // member of the base so this only matches when operator+= is not overridden
+    template <typename _Tp>
+    struct base_accumulate<
+        _Tp, decltype(void(check_base_accumulate<_Tp>(&_Tp::operator+=)))>
+    : std::true_type
+    {};
+
+    template <typename _Tp = ObjectType>
+    struct compact_node
+    : std::integral_constant<bool, (trait::compact_graph_node<_Tp>::value &&
+                                    sizeof(_Tp) == sizeof(typename _Tp::base_type) &&
+                                    base_accumulate<_Tp>::value)>
+    {};
+
+    struct compact_payload
+    {
+        using value_type = typename ObjectType::value_type;
+
+        value_type value     = value_type();
+        value_type accum     = value_type();
+        int64_t    laps      = 0;
+        bool       transient = false;
+
+        compact_payload() = default;
+        explicit compact_payload(const ObjectType& _obj) { pack(_obj); }
+
+        void pack(const ObjectType& _obj)
+        {
+            value     = _obj.value;
+            accum     = _obj.accum;
+            laps      = _obj.laps;
+            transient = _obj.is_transient;
+        }
+
+        ObjectType unpack() const
+        {
+            ObjectType _obj{};
+            _obj.value        = value;
+            _obj.accum        = accum;
+            _obj.laps         = laps;
+            _obj.is_transient = transient;
+            return _obj;
+        }
+    };
+
+    template <typename _Tp = ObjectType>
+    using payload_t =
+        typename std::conditional<(compact_node<_Tp>::value), compact_payload, _Tp>::type;
+
+    template <typename _Tp = ObjectType>
+    using graph_node_tuple_t = std::tuple<uint64_t, payload_t<_Tp>, int64_t>;
 
     class graph_node;
     friend class graph_node;
 
-    class graph_node : public graph_node_tuple
+    class graph_node : public graph_node_tuple_t<>
     {
     public:
         using this_type       = graph_node;
-        using base_type       = graph_node_tuple;
+        using base_type       = graph_node_tuple_t<>;
+        using payload_type    = payload_t<>;
         using data_value_type = typename ObjectType::value_type;
         using data_base_type  = typename ObjectType::base_type;
         using string_t        = std::string;
+        using obj_type = typename std::conditional<(compact_node<>::value), ObjectType,
+                                                   const ObjectType&>::type;
 
-        uint64_t&   id() { return std::get<0>(*this); }
-        ObjectType& obj() { return std::get<1>(*this); }
-        int64_t&    depth() { return std::get<2>(*this); }
+        uint64_t& id() { return std::get<0>(*this); }
+        int64_t&  depth() { return std::get<2>(*this); }
 
-        const uint64_t&   id() const { return std::get<0>(*this); }
-        const ObjectType& obj() const { return std::get<1>(*this); }
-        const int64_t&    depth() const { return std::get<2>(*this); }
+        const uint64_t& id() const { return std::get<0>(*this); }
+        obj_type        obj() const { return get_obj(std::get<1>(*this)); }
+        const int64_t&  depth() const { return std::get<2>(*this); }
 
         string_t get_prefix() const { return master_instance()->get_prefix(*this); }
 
         graph_node()
-        : base_type(0, ObjectType(), 0)
+        : base_type(0, payload_type(), 0)
         {}
 
         explicit graph_node(base_type&& _base)
@@ -168,7 +280,7 @@ public:
         {}
 
         graph_node(const uint64_t& _id, const ObjectType& _obj, int64_t _depth)
-        : base_type(_id, _obj, _depth)
+        : base_type(_id, payload_type(_obj), _depth)
         {}
 
         ~graph_node() {}
@@ -186,14 +298,79 @@ public:
 
         graph_node& operator+=(const graph_node& rhs)
         {
-            auto&       _obj = obj();
-            const auto& _rhs = rhs.obj();
-            _obj += _rhs;
-            _obj.plus(_rhs);
+            add(std::get<1>(*this), std::get<1>(rhs));
+            return *this;
+        }
+
+        /// combine the data of a component (e.g. when it is popped off the stack) with
+        /// the data stored in the node
+        graph_node& accumulate(const ObjectType& rhs)
+        {
+            add(std::get<1>(*this), rhs);
+            return *this;
+        }
+
+        /// the number of laps and the accumulated data of the node, read without
+        /// constructing a component (e.g. from within a signal handler)
+        const int64_t&         get_laps() const { return std::get<1>(*this).laps; }
+        const data_value_type& get_accum() const { return std::get<1>(*this).accum; }
+
+        /// update the node data with a raw measurement (e.g. secondary data)
+        template <typename _Func>
+        graph_node& modify(_Func&& _func)
+        {
+            update(std::get<1>(*this), std::forward<_Func>(_func));
             return *this;
         }
 
-        size_t data_size() const { return sizeof(ObjectType) + 2 * sizeof(int64_t); }
+        size_t data_size() const { return sizeof(payload_type) + 2 * sizeof(int64_t); }
+
+    private:
+        static ObjectType get_obj(const compact_payload& _data)
+        {
+            return _data.unpack();
+        }
+
+        static const ObjectType& get_obj(const ObjectType& _data) { return _data; }
+
+        static void add(compact_payload& _data, const compact_payload& _rhs)
+        {
+            _data.value += _rhs.value;
+            _data.accum += _rhs.accum;
+            _data.laps += _rhs.laps;
+            _data.transient = (_data.transient || _rhs.transient);
+        }
+
+        static void add(compact_payload& _data, const ObjectType& _rhs)
+        {
+            _data.value += _rhs.value;
+            _data.accum += _rhs.accum;
+            _data.laps += _rhs.laps;
+            _data.transient = (_data.transient || _rhs.is_transient);
+        }
+
+        static void add(ObjectType& _data, const ObjectType& _rhs)
+        {
+            _data += _rhs;
+            _data.plus(_rhs);
+            _data.is_running = false;
+        }
+
+        template <typename _Func>
+        static void update(compact_payload& _data, _Func&& _func)
+        {
+            auto _obj = _data.unpack();
+            std::forward<_Func>(_func)(_obj);
+            _data.pack(_obj);
+        }
+
+        template <typename _Func>
+        static void update(ObjectType& _data, _Func&& _func)
+        {
+            std::forward<_Func>(_func)(_data);
+        }
+
+    public:
 
         friend std::ostream& operator<<(std::ostream& os, const graph_node& obj)
         {
@@ -216,9 +393,9 @@ public:
     using iterator       = typename graph_t::iterator;
     using const_iterator = typename graph_t::const_iterator;
 
-    static pointer instance() { return get_singleton().instance(); }
+    static pointer instance() { return acquire(get_singleton()); }
     static pointer master_instance() { return get_singleton().master_instance(); }
-    static pointer noninit_instance() { return get_noninit_singleton().instance(); }
+    static pointer noninit_instance() { return acquire(get_noninit_singleton()); }
     static pointer noninit_master_instance()
     {
         return get_noninit_singleton().master_instance();
@@ -240,21 +417,7 @@ public:
         // check_consistency();
         static std::atomic<int32_t> _skip_once;
         if(_skip_once++ > 0)
-        {
-            auto               _master       = singleton_t::master_instance();
-            graph_hash_map_t   _hash_ids     = *_master->get_hash_ids();
-            graph_hash_alias_t _hash_aliases = *_master->get_hash_aliases();
-            for(const auto& itr : _hash_ids)
-            {
-                if(m_hash_ids->find(itr.first) == m_hash_ids->end())
-                    m_hash_ids->insert({ itr.first, itr.second });
-            }
-            for(const auto& itr : _hash_aliases)
-            {
-                if(m_hash_aliases->find(itr.first) == m_hash_aliases->end())
-                    m_hash_aliases->insert({ itr.first, itr.second });
-            }
-        }
+            copy_master_hash_ids();
     }
 
     //----------------------------------------------------------------------------------//
@@ -264,6 +427,9 @@ public:
         if(settings::debug())
             printf("[%s]> destructing @ %i...\n", ObjectType::label().c_str(), __LINE__);
 
+        crash_dump::erase(this);
+        shared_profile::erase(this);
+
         if(!singleton_t::is_master(this))
             singleton_t::master_instance()->merge(this);
 
@@ -332,6 +498,19 @@ public:
 
     bool    is_initialized() const { return m_initialized; }
     int64_t instance_id() const { return m_instance_id; }
+    int64_t thread_index() const;
+
+    //----------------------------------------------------------------------------------//
+    //  true when worker call-graphs were collected (settings::thread_output() was on
+    //  when the workers exited) instead of merged. These are reported per-thread
+    //
+    bool has_thread_results() const
+    {
+        auto_lock_t l(singleton_t::get_mutex(), std::defer_lock);
+        if(!l.owns_lock())
+            l.lock();
+        return !m_thread_results.empty();
+    }
 
     //----------------------------------------------------------------------------------//
     //
@@ -418,6 +597,45 @@ public:
     //
     iterator pop() { return _data().pop_graph(); }
 
+    //----------------------------------------------------------------------------------//
+    //  remove a node and its subtree from the call-graph, e.g. the scratch node of
+    //  the overhead calibration. The node must not be on the call-stack.
+    //
+    void erase(iterator itr)
+    {
+        if(!itr || m_graph_data_instance == nullptr || graph_t::is_head(itr))
+            return;
+
+        // the first node after the subtree
+        iterator _end = itr;
+        _end.skip_children();
+        ++_end;
+
+        std::vector<decltype(itr.node)> _nodes;
+        for(iterator _sub = itr; _sub && _sub != _end; ++_sub)
+            _nodes.push_back(_sub.node);
+        std::sort(_nodes.begin(), _nodes.end());
+
+        // forget the lookups into the subtree so that they are not re-used
+        for(auto& ditr : m_node_ids)
+        {
+            for(auto hitr = ditr.second.begin(); hitr != ditr.second.end();)
+            {
+                if(std::binary_search(_nodes.begin(), _nodes.end(), hitr->second.node))
+                    hitr = ditr.second.erase(hitr);
+                else
+                    ++hitr;
+            }
+        }
+
+        if(std::binary_search(_nodes.begin(), _nodes.end(), _data().current().node))
+        {
+            _data().current() = graph_t::parent(itr);
+            _data().depth()   = _data().current()->depth();
+        }
+        _data().graph().erase(itr);
+    }
+
     //----------------------------------------------------------------------------------//
     //
     template <typename _Scope  = scope::process,
@@ -606,8 +824,11 @@ public:
         consume_parameters(_global_init, _thread_init, _data_init);
 
         auto hash_depth = ((_data().depth() >= 0) ? (_data().depth() + 1) : 1);
+        auto nnodes     = m_node_ids[hash_depth].size();
         auto itr        = insert<_Scope>(hash_id * hash_depth, obj, hash_depth);
         add_hash_id(m_hash_ids, m_hash_aliases, hash_id, hash_id * hash_depth);
+        if(nnodes != m_node_ids[hash_depth].size() && crash_dump::enabled())
+            crash_dump::add_label(itr->id(), get_prefix(*itr));
         return itr;
     }
 
@@ -622,8 +843,11 @@ public:
         static bool _data_init   = data_init();
         consume_parameters(_global_init, _thread_init, _data_init);
 
-        auto itr = insert<_Scope>(hash_id, obj, 1);
+        auto nnodes = m_node_ids[1].size();
+        auto itr    = insert<_Scope>(hash_id, obj, 1);
         add_hash_id(m_hash_ids, m_hash_aliases, hash_id, hash_id);
+        if(nnodes != m_node_ids[1].size() && crash_dump::enabled())
+            crash_dump::add_label(itr->id(), get_prefix(*itr));
         return itr;
     }
 
@@ -657,8 +881,10 @@ public:
         if(_nitr != m_node_ids[_depth].end())
         {
             // if so, then update
-            _nitr->second->obj() += std::get<2>(_secondary);
-            _nitr->second->obj().laps += 1;
+            _nitr->second->modify([&](ObjectType& _obj) {
+                _obj += std::get<2>(_secondary);
+                _obj.laps += 1;
+            });
         }
         else
         {
@@ -668,6 +894,8 @@ public:
             _tmp.laps = 1;
             graph_node_t _node(_hash, _tmp, _depth);
             m_node_ids[_depth][_hash] = _data().emplace_child(_itr, _node);
+            if(crash_dump::enabled())
+                crash_dump::add_label(_hash, get_prefix(_node));
         }
     }
 
@@ -680,6 +908,31 @@ public:
     }
 
 private:
+    // the depth of the head of the call-graph
+    int64_t get_min_depth()
+    {
+        int64_t _min = std::numeric_limits<int64_t>::max();
+        for(const auto& itr : graph())
+            _min = std::min<int64_t>(_min, itr.depth());
+        return _min;
+    }
+
+    // prefix which identifies the rank (when initialized) of the output
+    string_t get_node_prefix() const
+    {
+        if(!m_node_init)
+            return std::string(">>> ");
+
+        // prefix spacing
+        static uint16_t width = 1;
+        if(m_node_size > 9)
+            width = std::max(width, (uint16_t)(log10(m_node_size) + 1));
+        std::stringstream ss;
+        ss.fill('0');
+        ss << "|" << std::setw(width) << m_node_rank << ">>> ";
+        return ss.str();
+    }
+
     string_t get_prefix(const graph_node& node)
     {
         auto _ret = get_hash_identifier(m_hash_ids, m_hash_aliases, node.id());
@@ -713,131 +966,253 @@ public:
     graph_t&      graph() { return _data().graph(); }
 
     //----------------------------------------------------------------------------------//
+    //  an entry of the flattened call-graph before any strings are built: the node,
+    //  the (possibly collapsed) data, the depth relative to the head, and the rolling
+    //  hash of the node and its ancestors
     //
-    result_array_type get()
+    struct graph_entry
     {
-        //------------------------------------------------------------------------------//
-        //
-        //  Compute the node prefix
-        //
-        //------------------------------------------------------------------------------//
-        auto _get_node_prefix = [&]() {
-            if(!m_node_init)
-                return std::string(">>> ");
-
-            // prefix spacing
-            static uint16_t width = 1;
-            if(m_node_size > 9)
-                width = std::max(width, (uint16_t)(log10(m_node_size) + 1));
-            std::stringstream ss;
-            ss.fill('0');
-            ss << "|" << std::setw(width) << m_node_rank << ">>> ";
-            return ss.str();
-        };
+        iterator   itr;
+        ObjectType obj;
+        int64_t    depth;
+        uint64_t   rolling;
+    };
+
+    using entry_array_type = std::vector<graph_entry>;
+
+    //----------------------------------------------------------------------------------//
+    //  flatten the call-graph in pre-order and (optionally) combine the equivalent
+    //  entries from different threads. O(N) w.r.t. the number of nodes and no strings
+    //  are built: see get_entry_prefix() and get_entry_hierarchy()
+    //
+    entry_array_type get_entries()
+    {
+        // hash key for collapsing threads: (hash, depth, rolling hash)
+        using collapse_key_t = std::tuple<uint64_t, int64_t, uint64_t>;
 
-        //------------------------------------------------------------------------------//
-        //
-        //  Compute the indentation
-        //
-        //------------------------------------------------------------------------------//
-        // fix up the prefix based on the actual depth
-        auto _compute_modified_prefix = [&](const graph_node& itr) {
-            std::string _prefix      = get_prefix(itr);
-            std::string _indent      = "";
-            std::string _node_prefix = _get_node_prefix();
-
-            int64_t _depth = itr.depth() - 1;
-            if(_depth > 0)
+        struct collapse_hash
+        {
+            size_t operator()(const collapse_key_t& _key) const
             {
-                for(int64_t ii = 0; ii < _depth - 1; ++ii)
-                    _indent += "  ";
-                _indent += "|_";
+                size_t _seed = std::hash<uint64_t>()(std::get<0>(_key));
+                _seed ^= std::hash<int64_t>()(std::get<1>(_key)) + 0x9e3779b9 +
+                         (_seed << 6) + (_seed >> 2);
+                _seed ^= std::hash<uint64_t>()(std::get<2>(_key)) + 0x9e3779b9 +
+                         (_seed << 6) + (_seed >> 2);
+                return _seed;
             }
-
-            return _node_prefix + _indent + _prefix;
         };
 
-        // convert graph to a vector
-        auto convert_graph = [&]() {
-            result_array_type _list;
+        // the head node should always be ignored
+        int64_t _min = get_min_depth();
+
+        bool _collapse = settings::collapse_threads();
+        entry_array_type                                          _entries;
+        std::unordered_map<collapse_key_t, size_t, collapse_hash> _index;
+        if(_collapse)
+            _index.reserve(graph().size());
+
+        for(auto itr = graph().begin(); itr != graph().end(); ++itr)
+        {
+            if(!(itr->depth() > _min))
+                continue;
+
+            auto _depth   = itr->depth() - (_min + 1);
+            auto _rolling = itr->id();
+            auto _parent  = graph_t::parent(itr);
+            while(_parent && _parent->depth() > _min)
             {
-                // the head node should always be ignored
-                int64_t _min = std::numeric_limits<int64_t>::max();
-                for(const auto& itr : graph())
-                    _min = std::min<int64_t>(_min, itr.depth());
+                _rolling += _parent->id();
+                _parent = graph_t::parent(_parent);
+            }
 
-                for(auto itr = graph().begin(); itr != graph().end(); ++itr)
+            if(_collapse)
+            {
+                auto _key  = collapse_key_t(itr->id(), _depth, _rolling);
+                auto _iitr = _index.find(_key);
+                if(_iitr != _index.end())
                 {
-                    if(itr->depth() > _min)
-                    {
-                        auto                     _depth  = itr->depth() - (_min + 1);
-                        auto                     _prefix = _compute_modified_prefix(*itr);
-                        auto                     _rolling = itr->id();
-                        auto                     _parent  = graph_t::parent(itr);
-                        std::vector<std::string> _hierarchy;
-                        if(_parent && _parent->depth() > _min)
-                        {
-                            while(_parent)
-                            {
-                                _hierarchy.push_back(get_prefix(*_parent));
-                                _rolling += _parent->id();
-                                _parent = graph_t::parent(_parent);
-                                if(!_parent || !(_parent->depth() > _min))
-                                    break;
-                            }
-                        }
-                        if(_hierarchy.size() > 1)
-                            std::reverse(_hierarchy.begin(), _hierarchy.end());
-                        _hierarchy.push_back(get_prefix(*itr));
-                        result_type _entry(itr->id(), itr->obj(), _prefix, _depth,
-                                           _rolling, _hierarchy);
-                        _list.push_back(_entry);
-                    }
+                    auto& _obj = _entries[_iitr->second].obj;
+                    _obj += itr->obj();
+                    _obj.laps += itr->obj().laps;
+                    continue;
                 }
+                _index.insert({ _key, _entries.size() });
             }
+            _entries.push_back(graph_entry{ itr, itr->obj(), _depth, _rolling });
+        }
+        return _entries;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  the indented label of an entry, e.g. "|0>>> |_foo"
+    //
+    string_t get_entry_prefix(const graph_entry& _entry)
+    {
+        std::string _indent = "";
+        int64_t     _depth  = _entry.itr->depth() - 1;
+        if(_depth > 0)
+        {
+            for(int64_t ii = 0; ii < _depth - 1; ++ii)
+                _indent += "  ";
+            _indent += "|_";
+        }
+        return get_node_prefix() + _indent + get_prefix(*_entry.itr);
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  the labels of the ancestors of an entry followed by the label of the entry
+    //
+    std::vector<string_t> get_entry_hierarchy(const graph_entry& _entry)
+    {
+        // depth of the head of the call-graph (see get_entries)
+        int64_t                  _min    = _entry.itr->depth() - (_entry.depth + 1);
+        auto                     _parent = graph_t::parent(_entry.itr);
+        std::vector<std::string> _hierarchy;
+        while(_parent && _parent->depth() > _min)
+        {
+            _hierarchy.push_back(get_prefix(*_parent));
+            _parent = graph_t::parent(_parent);
+        }
+        if(_hierarchy.size() > 1)
+            std::reverse(_hierarchy.begin(), _hierarchy.end());
+        _hierarchy.push_back(get_prefix(*_entry.itr));
+        return _hierarchy;
+    }
 
-            if(!settings::collapse_threads())
-                return _list;
+    //----------------------------------------------------------------------------------//
+    //  convert the entries to results. The prefix is only built for the entries with a
+    //  depth <= "_max_depth" and the hierarchy only when "_hierarchy" is true, the
+    //  other strings are left empty
+    //
+    result_array_type get(const entry_array_type& _entries, int64_t _max_depth,
+                          bool _hierarchy)
+    {
+        result_array_type _list;
+        _list.reserve(_entries.size());
+        for(const auto& itr : _entries)
+        {
+            auto _prefix = (itr.depth <= _max_depth) ? get_entry_prefix(itr) : string_t{};
+            _list.push_back(result_type(
+                itr.itr->id(), itr.obj, std::move(_prefix), itr.depth, itr.rolling,
+                (_hierarchy) ? get_entry_hierarchy(itr) : std::vector<string_t>{}));
+        }
+        return _list;
+    }
 
-            result_array_type _combined;
+    //----------------------------------------------------------------------------------//
+    //  the flattened call-graph with every string built
+    //
+    result_array_type get()
+    {
+        return get(get_entries(), std::numeric_limits<int64_t>::max(), true);
+    }
 
-            auto _equiv = [&](const result_type& _lhs, const result_type& _rhs) {
-                return (std::get<0>(_lhs) == std::get<0>(_rhs) &&
-                        std::get<2>(_lhs) == std::get<2>(_rhs) &&
-                        std::get<3>(_lhs) == std::get<3>(_rhs) &&
-                        std::get<4>(_lhs) == std::get<4>(_rhs));
-            };
+    //----------------------------------------------------------------------------------//
+    //  calibrated overhead of the descendant markers of each entry returned by get(),
+    //  i.e. the sum of the laps of each descendant times the per-marker estimate of
+    //  the bundle which inserted it (the entries are in pre-order so a single reverse
+    //  pass is sufficient)
+    //
+    static std::vector<double> get_descendant_overhead(const result_array_type& _list)
+    {
+        using calibrate_t = operation::calibrate<ObjectType>;
+        std::vector<double> _desc(_list.size(), 0.0);
+        std::vector<double> _accum;
+        for(size_t i = _list.size(); i > 0; --i)
+        {
+            const auto& itr    = _list.at(i - 1);
+            auto        _depth = std::max<int64_t>(std::get<3>(itr), 0);
+            if(_accum.size() < static_cast<size_t>(_depth + 2))
+                _accum.resize(_depth + 2, 0.0);
+            _desc.at(i - 1) = _accum.at(_depth + 1);
+            for(size_t j = _depth + 1; j < _accum.size(); ++j)
+                _accum.at(j) = 0.0;
+            auto _overhead = std::get<1>(itr).nlaps() *
+                             calibrate_t::node_estimate(std::get<0>(itr));
+            _accum.at(_depth) += _overhead + _desc.at(i - 1);
+        }
+        return _desc;
+    }
 
-            auto _exists = [&](const result_type& _lhs) {
-                for(auto itr = _combined.begin(); itr != _combined.end(); ++itr)
-                {
-                    if(_equiv(_lhs, *itr))
-                        return itr;
-                }
-                return _combined.end();
-            };
+    //----------------------------------------------------------------------------------//
+    //  the call-graphs collected from the worker threads (instead of merging them)
+    //  plus the call-graph of this instance, ordered by thread index
+    //
+    thread_result_array_type get_thread_results()
+    {
+        thread_result_array_type _ret;
+        {
+            auto_lock_t l(singleton_t::get_mutex(), std::defer_lock);
+            if(!l.owns_lock())
+                l.lock();
+            _ret = m_thread_results;
+        }
+        auto _self = get();
+        if(!_self.empty())
+            _ret.push_back(thread_result_type(thread_index(), std::move(_self)));
+        std::sort(_ret.begin(), _ret.end(),
+                  [](const thread_result_type& lhs, const thread_result_type& rhs) {
+                      return lhs.first < rhs.first;
+                  });
+        return _ret;
+    }
 
-            for(const auto& itr : _list)
-            {
-                auto citr = _exists(itr);
-                if(citr == _combined.end())
-                {
-                    _combined.push_back(itr);
-                }
-                else
-                {
-                    std::get<1>(*citr) += std::get<1>(itr);
-                    std::get<1>(*citr).laps += std::get<1>(itr).laps;
-                }
-            }
-            return _combined;
-        };
-        return convert_graph();
+    //----------------------------------------------------------------------------------//
+    //  min/max/mean/stddev of each entry across the threads. Empty when the value
+    //  returned by ObjectType::get() is not arithmetic
+    //
+    static thread_summary_array_type get_thread_summary(const thread_result_array_type&);
+
+    //----------------------------------------------------------------------------------//
+    //  append the call-graph (after merging the worker threads) in a compact binary
+    //  form to the buffer, e.g. to send it to another process. Nothing is appended when
+    //  the value type of the component is not trivially copyable
+    //
+    void pack(std::string& _buffer)
+    {
+        using value_type = typename ObjectType::value_type;
+        pack(_buffer,
+             std::integral_constant<bool, std::is_trivially_copyable<value_type>::value>{});
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  combine a section created by pack() (in this or another process running the
+    //  same executable) with the call-graph of this instance. Returns false if the
+    //  section is malformed or was created for a different value type
+    //
+    bool unpack(const char* _data, size_t _size)
+    {
+        using value_type = typename ObjectType::value_type;
+        return unpack(
+            _data, _size,
+            std::integral_constant<bool, std::is_trivially_copyable<value_type>::value>{});
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  remove all of the entries but keep the head of the call-graph
+    //
+    void reset()
+    {
+        if(!m_graph_data_instance)
+            return;
+        auto_lock_t l(singleton_t::get_mutex(), std::defer_lock);
+        if(!l.owns_lock())
+            l.lock();
+        _data().reset();
+        m_node_ids.clear();
+        m_node_ids[0][0] = _data().head();
+        m_thread_results.clear();
     }
 
 protected:
     friend struct details::storage_deleter<this_type>;
 
+    void pack(std::string&, std::false_type) {}
+    void pack(std::string&, std::true_type);
+    bool unpack(const char*, size_t, std::false_type) { return false; }
+    bool unpack(const char*, size_t, std::true_type);
+
     void merge()
     {
         if(!singleton_t::is_master(this) || !m_initialized)
@@ -863,8 +1238,113 @@ protected:
     }
 
     void merge(this_type* itr);
+    void collect(this_type* itr);
+    void fold(iterator _dst, iterator _src);
     void mpi_reduce();
 
+    //----------------------------------------------------------------------------------//
+    //  instances released by exited worker threads are kept (up to
+    //  settings::storage_pool_size()) and handed to the next thread which needs one.
+    //  The pool is never deleted because it is accessed from thread-local destructors.
+    //  Live instances are not bounded: the graph of a running thread cannot be folded
+    //  into the master while that thread may still be inserting into it
+    //
+    static std::vector<pointer>& get_pool()
+    {
+        static auto* _instance = new std::vector<pointer>();
+        return *_instance;
+    }
+
+    static pointer acquire(singleton_t& _singleton)
+    {
+        if(!singleton_t::instance_ptr() && !singleton_t::is_master_thread())
+        {
+            pointer _ptr = nullptr;
+            {
+                auto_lock_t l(singleton_t::get_mutex());
+                auto&       _pool = get_pool();
+                if(!_pool.empty())
+                {
+                    _ptr = _pool.back();
+                    _pool.pop_back();
+                }
+            }
+            if(_ptr)
+            {
+                _ptr->rebind();
+                singleton_t::smart_instance().reset(_ptr);
+                singleton_t::insert(_ptr);
+            }
+        }
+        return _singleton.instance();
+    }
+
+    // invoked by the deleter after the data of a worker instance was merged
+    static void release(pointer _ptr)
+    {
+        auto_lock_t l(singleton_t::get_mutex());
+        auto&       _pool = get_pool();
+        if(_pool.size() < settings::storage_pool_size())
+        {
+            _ptr->recycle();
+            _pool.push_back(_ptr);
+            return;
+        }
+        l.unlock();
+        delete _ptr;
+    }
+
+    // start a new call-graph on the next insert. No components may be running
+    void clear_graph()
+    {
+        crash_dump::erase(this);
+        shared_profile::erase(this);
+        delete m_graph_data_instance;
+        m_graph_data_instance = nullptr;
+        m_node_ids.clear();
+        m_thread_results.clear();
+    }
+
+    // drop everything which belongs to the thread releasing this instance
+    void recycle()
+    {
+        clear_graph();
+        m_initialized = false;
+        m_finalized   = false;
+        m_thread_init = false;
+        m_data_init   = false;
+        m_hash_ids.reset();
+        m_hash_aliases.reset();
+        m_manager.reset();
+    }
+
+    // bind a recycled instance to the calling thread
+    void rebind()
+    {
+        m_instance_id  = instance_count()++;
+        m_hash_ids     = ::tim::get_hash_ids();
+        m_hash_aliases = ::tim::get_hash_aliases();
+        copy_master_hash_ids();
+        get_shared_manager();
+    }
+
+    void copy_master_hash_ids()
+    {
+        auto               _master       = singleton_t::master_instance();
+        graph_hash_map_t   _hash_ids     = *_master->get_hash_ids();
+        graph_hash_alias_t _hash_aliases = *_master->get_hash_aliases();
+        for(const auto& itr : _hash_ids)
+        {
+            if(m_hash_ids->find(itr.first) == m_hash_ids->end())
+                m_hash_ids->insert({ itr.first, itr.second });
+        }
+        for(const auto& itr : _hash_aliases)
+        {
+            if(m_hash_aliases->find(itr.first) == m_hash_aliases->end())
+                m_hash_aliases->insert({ itr.first, itr.second });
+        }
+    }
+
 protected:
     //----------------------------------------------------------------------------------//
     //
@@ -943,6 +1423,14 @@ private:
     template <typename Archive>
     void serialize_me(std::false_type, Archive&, const unsigned int);
 
+    // graph entries (and the overhead-corrected values, if enabled)
+    template <typename Archive>
+    void serialize_graph(Archive&, const result_array_type&);
+
+    // per-thread graph entries and the cross-thread summary
+    template <typename Archive>
+    void serialize_threads(Archive&, const thread_result_array_type&);
+
     // tim::trait::external_output_handling<ObjectType>::type == TRUE
     void external_print(std::true_type);
 
@@ -966,6 +1454,10 @@ private:
             m_graph_data_instance->depth() = m.depth();
             if(m_node_ids.size() == 0)
                 m_node_ids[0][0] = m_graph_data_instance->current();
+            crash_dump::insert(this, ObjectType::label(), m_instance_id,
+                               &this_type::crash_dump_graph);
+            shared_profile::insert(this, &this_type::shared_profile_publish,
+                                   &this_type::shared_profile_merge);
         }
         else if(m_graph_data_instance == nullptr)
         {
@@ -980,12 +1472,54 @@ private:
             m_graph_data_instance->depth() = 0;
             if(m_node_ids.size() == 0)
                 m_node_ids[0][0] = m_graph_data_instance->current();
+            crash_dump::insert(this, ObjectType::label(), m_instance_id,
+                               &this_type::crash_dump_graph);
+            shared_profile::insert(this, &this_type::shared_profile_publish,
+                                   &this_type::shared_profile_merge);
         }
         return *m_graph_data_instance;
     }
 
     const graph_data_t& _data() const { return const_cast<this_type*>(this)->_data(); }
 
+    //----------------------------------------------------------------------------------//
+    //  invoked from the termination signal handler: must remain async-signal-safe
+    //  (no allocation, no locks, no strings) so it only reads the graph in-place
+    //
+    static void crash_dump_graph(const void* _ptr, crash_dump::writer& _writer)
+    {
+        auto _graph_data = static_cast<const this_type*>(_ptr)->m_graph_data_instance;
+        if(_graph_data == nullptr)
+            return;
+        for(auto itr = _graph_data->begin(); itr != _graph_data->end(); ++itr)
+            _writer.record(itr->id(), itr->depth(), itr->get_laps(),
+                           crash_dump_value(itr->get_accum()));
+    }
+
+    template <typename _Vp, enable_if_t<(std::is_arithmetic<_Vp>::value), int> = 0>
+    static double crash_dump_value(const _Vp& _accum)
+    {
+        return static_cast<double>(_accum);
+    }
+
+    template <typename _Vp, enable_if_t<!(std::is_arithmetic<_Vp>::value), int> = 0>
+    static double crash_dump_value(const _Vp&)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  writes the flattened call-graph of the master instance into the shared-memory
+    //  slot of this process (see timemory/utility/shared_profile.hpp)
+    //
+    static void shared_profile_publish(void* _ptr, shared_profile::writer& _writer);
+
+    //----------------------------------------------------------------------------------//
+    //  folds the call-graph of a worker into the master instance before the process
+    //  publishes its profile
+    //
+    static void shared_profile_merge(void* _ptr);
+
     template <typename _Key_t, typename _Mapped_t>
     using uomap_t             = std::unordered_map<_Key_t, _Mapped_t>;
     using iterator_hash_map_t = uomap_t<int64_t, uomap_t<int64_t, iterator>>;
@@ -1003,6 +1537,7 @@ private:
     graph_hash_alias_ptr_t   m_hash_aliases        = ::tim::get_hash_aliases();
     mutable graph_data_t*    m_graph_data_instance = nullptr;
     iterator_hash_map_t      m_node_ids;
+    thread_result_array_type m_thread_results;
     std::shared_ptr<manager> m_manager;
 
 public:
@@ -1168,6 +1703,10 @@ public:
         ::tim::add_hash_id(m_hash_ids, _prefix);
     }
 
+    void pack(std::string&) {}
+    bool unpack(const char*, size_t) { return false; }
+    void reset() {}
+
 protected:
     friend struct details::storage_deleter<this_type>;
 
@@ -1181,6 +1720,9 @@ protected:
             merge(itr);
     }
 
+    // invoked by the deleter, there is no data to keep
+    static void release(pointer _ptr) { delete _ptr; }
+
     void merge(this_type* itr)
     {
         // create lock but don't immediately lock
@@ -1338,8 +1880,13 @@ struct tim::details::storage_deleter : public std::default_delete<StorageType>
             if(master && ptr != master)
             {
                 singleton_t::remove(ptr);
+                // kept for reuse by the next thread (or deleted)
+                StorageType::release(ptr);
+            }
+            else
+            {
+                delete ptr;
             }
-            delete ptr;
         }
         if(_printed_master && !_deleted_master)
         {
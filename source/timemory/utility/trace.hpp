@@ -0,0 +1,512 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory/utility/trace.hpp
+ * \headerfile trace.hpp "timemory/utility/trace.hpp"
+ * Event-trace (timeline) mode. When TIMEMORY_TRACE is enabled, component_tuple
+ * start/stop append fixed-size begin/end records to a per-thread ring of chunks.
+ * Each ring has a single producer (the owning thread) and a single consumer (a
+ * background thread) and is lock-free: full chunks are drained to a temporary binary
+ * file and converted to Chrome trace-event JSON (loadable in chrome://tracing and
+ * the Perfetto UI) at finalization.
+ *
+ * Memory is bounded by TIMEMORY_TRACE_CHUNK_SIZE * TIMEMORY_TRACE_MAX_CHUNKS records
+ * per thread. When the consumer falls behind, either the oldest chunk is discarded
+ * (TIMEMORY_TRACE_DROP_OLDEST=ON, default) or the newest records are. A chunk which
+ * the consumer is copying is never overwritten: the consumer claims it first and the
+ * producer drops the new record instead of reusing a claimed chunk.
+ *
+ */
+
+#pragma once
+
+#include "timemory/bits/settings.hpp"
+#include "timemory/bits/types.hpp"
+#include "timemory/utility/macros.hpp"
+#include "timemory/utility/utility.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_UNIX)
+#    include <unistd.h>
+#endif
+
+namespace tim
+{
+namespace trace
+{
+//--------------------------------------------------------------------------------------//
+//
+//          fixed-size trace record
+//
+//--------------------------------------------------------------------------------------//
+
+struct record
+{
+    uint64_t hash;       // hash of the label (see add_hash_id)
+    uint64_t timestamp;  // nanoseconds since the trace epoch
+    double   value;      // counter value for phase 'C'
+    uint32_t thread;     // trace thread index
+    char     phase;      // 'B' (begin), 'E' (end), 'C' (counter)
+    char     padding[3];
+};
+
+//--------------------------------------------------------------------------------------//
+//
+//          single-producer, single-consumer ring of chunks
+//
+//--------------------------------------------------------------------------------------//
+
+class thread_buffer
+{
+public:
+    using hash_map_ptr_t = graph_hash_map_ptr_t;
+
+    thread_buffer(uint32_t _tid, uint64_t _chunk_size, uint64_t _max_chunks,
+                  bool _drop_oldest)
+    : m_tid(_tid)
+    , m_chunk_size(std::max<uint64_t>(_chunk_size, 1))
+    , m_drop_oldest(_drop_oldest)
+    , m_chunks(std::max<uint64_t>(_max_chunks, 2))
+    , m_hash_ids(::tim::get_hash_ids())
+    {
+        m_chunks.front().data.reset(new record[m_chunk_size]);
+    }
+
+    thread_buffer(const thread_buffer&) = delete;
+    thread_buffer& operator=(const thread_buffer&) = delete;
+
+    //----------------------------------------------------------------------------------//
+    //  producer (owning thread only)
+    //
+    void push(char _phase, uint64_t _hash, uint64_t _timestamp, double _value = 0.0)
+    {
+        auto  _head  = m_head.load(std::memory_order_relaxed);
+        auto* _chunk = &m_chunks[_head % m_chunks.size()];
+        auto  _count = _chunk->count.load(std::memory_order_relaxed);
+        if(_count == m_chunk_size)
+        {
+            if(!advance(_head))
+            {
+                ++m_dropped;
+                return;
+            }
+            _chunk = &m_chunks[(_head + 1) % m_chunks.size()];
+            _count = 0;
+        }
+
+        auto& _rec     = _chunk->data[_count];
+        _rec.hash      = _hash;
+        _rec.timestamp = _timestamp;
+        _rec.value     = _value;
+        _rec.thread    = m_tid;
+        _rec.phase     = _phase;
+        _chunk->count.store(_count + 1, std::memory_order_release);
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  consumer: write the completed chunks. When '_partial' is true, the chunk that
+    //  is currently being filled is written too (only safe when the producer is idle)
+    //
+    template <typename _Func>
+    void drain(std::vector<record>& _scratch, _Func&& _write, bool _partial = false)
+    {
+        auto _tail = m_tail.load(std::memory_order_acquire);
+        while(_tail < m_head.load(std::memory_order_acquire))
+        {
+            // claim the chunk, then make sure it was not evicted before the claim was
+            // visible to the producer (see advance)
+            m_reading.store(_tail);
+            if(m_tail.load() != _tail)
+            {
+                m_reading.store(not_reading, std::memory_order_release);
+                _tail = m_tail.load(std::memory_order_acquire);
+                continue;
+            }
+            auto& _chunk = m_chunks[_tail % m_chunks.size()];
+            auto  _count = _chunk.count.load(std::memory_order_acquire);
+            _scratch.assign(_chunk.data.get(), _chunk.data.get() + _count);
+            m_reading.store(not_reading, std::memory_order_release);
+            // if the producer evicted this chunk while we were copying, discard it
+            if(m_tail.compare_exchange_strong(_tail, _tail + 1))
+            {
+                _write(_scratch);
+                ++_tail;
+            }
+        }
+
+        if(_partial)
+        {
+            auto& _chunk = m_chunks[m_head.load() % m_chunks.size()];
+            auto  _count = _chunk.count.load(std::memory_order_acquire);
+            _scratch.assign(_chunk.data.get(), _chunk.data.get() + _count);
+            _chunk.count.store(0, std::memory_order_release);
+            _write(_scratch);
+        }
+    }
+
+    uint32_t              thread_index() const { return m_tid; }
+    uint64_t              dropped() const { return m_dropped.load(); }
+    const hash_map_ptr_t& get_hash_ids() const { return m_hash_ids; }
+
+private:
+    struct chunk
+    {
+        std::atomic<uint64_t>     count;
+        std::unique_ptr<record[]> data;
+
+        chunk()
+        : count(0)
+        {}
+    };
+
+    static constexpr uint64_t not_reading = std::numeric_limits<uint64_t>::max();
+
+    // move the producer to the next chunk, returns false if the record must be dropped
+    bool advance(uint64_t _head)
+    {
+        uint64_t _next_seq = _head + 1;
+        uint64_t _size     = m_chunks.size();
+        auto     _tail     = m_tail.load(std::memory_order_acquire);
+        if(_next_seq - _tail >= _size)
+        {
+            if(!m_drop_oldest)
+                return false;
+            // evict the oldest chunk (unless the consumer just took it)
+            if(m_tail.compare_exchange_strong(_tail, _tail + 1))
+                m_dropped += m_chunk_size;
+        }
+
+        // the next chunk previously held "_next_seq - _size". The consumer claims a
+        // chunk and then re-reads the tail while the producer moves the tail and then
+        // reads the claim, all sequentially consistent, so either the consumer sees the
+        // eviction and skips the chunk or the producer sees the claim here and drops
+        // the record instead of overwriting the chunk while it is being copied
+        if(_next_seq >= _size && m_reading.load() == _next_seq - _size)
+            return false;
+
+        auto& _next = m_chunks[_next_seq % _size];
+        if(!_next.data)
+            _next.data.reset(new record[m_chunk_size]);
+        _next.count.store(0, std::memory_order_relaxed);
+        m_head.store(_next_seq, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t              m_tid;
+    uint64_t              m_chunk_size;
+    bool                  m_drop_oldest;
+    std::atomic<uint64_t> m_head{ 0 };
+    std::atomic<uint64_t> m_tail{ 0 };
+    std::atomic<uint64_t> m_dropped{ 0 };
+    std::atomic<uint64_t> m_reading{ not_reading };
+    std::vector<chunk>    m_chunks;
+    hash_map_ptr_t        m_hash_ids;
+};
+
+//--------------------------------------------------------------------------------------//
+//
+//          trace manager: owns the buffers and the background drain thread
+//
+//--------------------------------------------------------------------------------------//
+
+class manager
+{
+public:
+    using buffer_ptr_t = std::shared_ptr<thread_buffer>;
+    using clock_type   = std::chrono::steady_clock;
+
+    static manager& instance()
+    {
+        static manager _instance;
+        return _instance;
+    }
+
+    ~manager() { finalize(); }
+
+    uint64_t now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() -
+                                                                    m_epoch)
+            .count();
+    }
+
+    bool is_finalized() const { return m_finalized.load(std::memory_order_relaxed); }
+
+    //----------------------------------------------------------------------------------//
+    //  called once per thread
+    //
+    buffer_ptr_t create_buffer()
+    {
+        std::unique_lock<std::mutex> _lk(m_mutex);
+        auto _buffer = std::make_shared<thread_buffer>(
+            m_buffers.size(), settings::trace_chunk_size(), settings::trace_max_chunks(),
+            settings::trace_drop_oldest());
+        m_buffers.push_back(_buffer);
+        if(!m_thread.joinable() && !is_finalized())
+        {
+            m_temp_fname = settings::compose_output_filename("trace", ".dat");
+            m_temp.open(m_temp_fname, std::ios::out | std::ios::binary | std::ios::trunc);
+            m_thread = std::thread(&manager::execute, this);
+        }
+        return _buffer;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  stop the drain thread, flush everything and write the Chrome trace JSON
+    //
+    void finalize()
+    {
+        if(m_finalized.exchange(true))
+            return;
+
+        {
+            std::unique_lock<std::mutex> _lk(m_mutex);
+            m_cv.notify_all();
+        }
+        if(m_thread.joinable())
+            m_thread.join();
+
+        std::unique_lock<std::mutex> _lk(m_mutex);
+        if(!m_temp.is_open())
+            return;
+
+        drain(true);
+        m_temp.close();
+        export_json();
+        std::remove(m_temp_fname.c_str());
+    }
+
+private:
+    manager()
+    : m_epoch(clock_type::now())
+    {}
+
+    void execute()
+    {
+        std::unique_lock<std::mutex> _lk(m_mutex);
+        while(!is_finalized())
+        {
+            m_cv.wait_for(_lk, std::chrono::milliseconds(50));
+            // buffers are only appended to, copy the list so the drain is unlocked
+            auto _buffers = m_buffers;
+            _lk.unlock();
+            drain(false, _buffers);
+            _lk.lock();
+        }
+    }
+
+    void drain(bool _partial) { drain(_partial, m_buffers); }
+
+    void drain(bool _partial, const std::vector<buffer_ptr_t>& _buffers)
+    {
+        auto _write = [&](const std::vector<record>& _records) {
+            m_temp.write(reinterpret_cast<const char*>(_records.data()),
+                         _records.size() * sizeof(record));
+            m_nrecords += _records.size();
+        };
+        for(auto& itr : _buffers)
+            itr->drain(m_scratch, _write, _partial);
+    }
+
+    std::string get_label(uint64_t _hash) const
+    {
+        for(const auto& itr : m_buffers)
+        {
+            const auto& _ids = itr->get_hash_ids();
+            if(!_ids)
+                continue;
+            auto _found = _ids->find(_hash);
+            if(_found != _ids->end())
+                return _found->second;
+        }
+        return std::string("unknown-hash=") + std::to_string(_hash);
+    }
+
+    static std::string escape(const std::string& _str)
+    {
+        std::string _ret;
+        _ret.reserve(_str.length());
+        for(auto itr : _str)
+        {
+            if(itr == '"' || itr == '\\')
+                _ret += '\\';
+            if(static_cast<unsigned char>(itr) < 0x20)
+                continue;
+            _ret += itr;
+        }
+        return _ret;
+    }
+
+    void export_json()
+    {
+        std::ifstream ifs(m_temp_fname, std::ios::in | std::ios::binary);
+        auto          _fname = settings::compose_output_filename("trace", ".json");
+        std::ofstream ofs(_fname);
+        if(!ifs || !ofs)
+        {
+            fprintf(stderr, "[trace]> Error opening '%s' or '%s'\n",
+                    m_temp_fname.c_str(), _fname.c_str());
+            return;
+        }
+
+        if(settings::verbose() > 0 || settings::debug())
+            printf("[trace]> Outputting '%s'...\n", _fname.c_str());
+
+        std::unordered_map<uint64_t, std::string> _labels;
+        auto _get_label = [&](uint64_t _hash) -> const std::string& {
+            auto itr = _labels.find(_hash);
+            if(itr == _labels.end())
+                itr = _labels.insert({ _hash, escape(get_label(_hash)) }).first;
+            return itr->second;
+        };
+
+#if defined(_UNIX)
+        auto _pid = static_cast<int64_t>(getpid());
+#else
+        auto _pid = static_cast<int64_t>(mpi::rank());
+#endif
+        uint64_t _dropped = 0;
+        for(const auto& itr : m_buffers)
+            _dropped += itr->dropped();
+
+        ofs << "{\"traceEvents\":[\n";
+        bool   _first = true;
+        record _rec;
+        while(ifs.read(reinterpret_cast<char*>(&_rec), sizeof(record)))
+        {
+            if(!_first)
+                ofs << ",\n";
+            _first = false;
+            ofs << "{\"name\":\"" << _get_label(_rec.hash)
+                << "\",\"cat\":\"timemory\",\"ph\":\"" << _rec.phase
+                << "\",\"ts\":" << std::fixed << std::setprecision(3)
+                << (_rec.timestamp / 1.0e3) << ",\"pid\":" << _pid
+                << ",\"tid\":" << _rec.thread;
+            if(_rec.phase == 'C')
+                ofs << ",\"args\":{\"value\":" << std::setprecision(6) << _rec.value
+                    << "}";
+            ofs << "}";
+        }
+        ofs << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"records\":" << m_nrecords
+            << ",\"dropped\":" << _dropped << "}}\n";
+
+        if(_dropped > 0)
+            fprintf(stderr, "[trace]> %llu records were dropped. Increase "
+                            "TIMEMORY_TRACE_CHUNK_SIZE or TIMEMORY_TRACE_MAX_CHUNKS\n",
+                    (long long unsigned) _dropped);
+    }
+
+private:
+    clock_type::time_point    m_epoch;
+    std::atomic<bool>         m_finalized{ false };
+    std::mutex                m_mutex;
+    std::condition_variable   m_cv;
+    std::thread               m_thread;
+    std::vector<buffer_ptr_t> m_buffers;
+    std::vector<record>       m_scratch;
+    std::string               m_temp_fname;
+    std::ofstream             m_temp;
+    uint64_t                  m_nrecords = 0;
+};
+
+//--------------------------------------------------------------------------------------//
+//
+//          public interface
+//
+//--------------------------------------------------------------------------------------//
+
+inline bool
+enabled()
+{
+    return settings::trace();
+}
+
+//--------------------------------------------------------------------------------------//
+
+inline thread_buffer*
+get_thread_buffer()
+{
+    static thread_local auto _instance = manager::instance().create_buffer();
+    return _instance.get();
+}
+
+//--------------------------------------------------------------------------------------//
+
+inline void
+begin(uint64_t _hash)
+{
+    auto& _manager = manager::instance();
+    if(_hash == 0 || _manager.is_finalized())
+        return;
+    get_thread_buffer()->push('B', _hash, _manager.now());
+}
+
+//--------------------------------------------------------------------------------------//
+
+inline void
+end(uint64_t _hash)
+{
+    auto& _manager = manager::instance();
+    if(_hash == 0 || _manager.is_finalized())
+        return;
+    get_thread_buffer()->push('E', _hash, _manager.now());
+}
+
+//--------------------------------------------------------------------------------------//
+
+inline void
+counter(const std::string& _label, double _value)
+{
+    auto& _manager = manager::instance();
+    if(!enabled() || _manager.is_finalized())
+        return;
+    get_thread_buffer()->push('C', add_hash_id(_label), _manager.now(), _value);
+}
+
+//--------------------------------------------------------------------------------------//
+
+inline void
+finalize()
+{
+    if(enabled())
+        manager::instance().finalize();
+}
+
+//--------------------------------------------------------------------------------------//
+
+}  // namespace trace
+}  // namespace tim
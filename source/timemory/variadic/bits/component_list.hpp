@@ -231,6 +231,27 @@ component_list<Types...>::stop()
     pop();
 }
 
+//--------------------------------------------------------------------------------------//
+// stop and weight the measurement as representing "_weight" invocations before it is
+// added to the call-graph (used by sampled GOTCHA wrappers)
+//
+template <typename... Types>
+void
+component_list<Types...>::scaled_stop(const int64_t& _weight)
+{
+    // stop components
+    apply<void>::access<prior_stop_t>(m_data);
+    apply<void>::access<stand_stop_t>(m_data);
+    // scale the measurements
+    if(_weight > 1)
+    {
+        m_laps += _weight - 1;
+        apply<void>::access<scale_t>(m_data, _weight);
+    }
+    // pop them off the running stack
+    pop();
+}
+
 //--------------------------------------------------------------------------------------//
 // recording
 //
@@ -119,6 +119,13 @@ component_tuple<Types...>::push()
 {
     if(m_store && !m_is_pushed)
     {
+        // measure the per-marker overhead once per bundle type
+        bool _attribute = settings::overhead_correction() && !calibrating();
+        if(_attribute)
+        {
+            static bool _calibrated = calibrate();
+            consume_parameters(_calibrated);
+        }
         // reset the data
         apply<void>::access<reset_t>(m_data);
         // avoid pushing/popping when already pushed/popped
@@ -128,6 +135,9 @@ component_tuple<Types...>::push()
             apply<void>::access<insert_node_t<scope::flat>>(m_data, m_hash);
         else
             apply<void>::access<insert_node_t<scope::process>>(m_data, m_hash);
+        // attribute the node to the overhead estimate of this bundle
+        if(_attribute)
+            apply<void>::access<calibrate_t>(m_data, bundle_id());
     }
 }
 
@@ -167,6 +177,9 @@ component_tuple<Types...>::start()
     push();
     // increment laps
     ++m_laps;
+    // record the begin event
+    if(trace::enabled() && !calibrating())
+        trace::begin(m_hash);
     // start components
     apply<void>::access<prior_start_t>(m_data);
     apply<void>::access<stand_start_t>(m_data);
@@ -181,10 +194,95 @@ component_tuple<Types...>::stop()
     // stop components
     apply<void>::access<prior_stop_t>(m_data);
     apply<void>::access<stand_stop_t>(m_data);
+    // record the end event
+    if(trace::enabled() && !calibrating())
+        trace::end(m_hash);
+    // pop them off the running stack
+    pop();
+}
+
+//--------------------------------------------------------------------------------------//
+// stop and weight the measurement as representing "_weight" invocations before it is
+// added to the call-graph (used by sampled GOTCHA wrappers)
+//
+template <typename... Types>
+inline void
+component_tuple<Types...>::scaled_stop(const int64_t& _weight)
+{
+    // stop components
+    apply<void>::access<prior_stop_t>(m_data);
+    apply<void>::access<stand_stop_t>(m_data);
+    // record the end event
+    if(trace::enabled() && !calibrating())
+        trace::end(m_hash);
+    // scale the measurements
+    if(_weight > 1)
+    {
+        m_laps += _weight - 1;
+        apply<void>::access<scale_t>(m_data, _weight);
+    }
     // pop them off the running stack
     pop();
 }
 
+//----------------------------------------------------------------------------------//
+// measure the overhead of a nested, stored start/stop as seen by each component. The
+// markers are stored under a scratch node (so that the estimate includes the key
+// lookup, graph insertion and pop) which is removed from the call-graph afterwards
+//
+template <typename... Types>
+inline bool
+component_tuple<Types...>::calibrate(int64_t _nitr)
+{
+    if(!settings::enabled() || calibrating())
+        return false;
+
+    calibrating() = true;
+    this_type _outer("timemory-calibration", true);
+    this_type _inner("timemory-calibration-marker", true);
+    // warm-up
+    _outer.start();
+    _inner.start();
+    _inner.stop();
+    _outer.stop();
+
+    _outer.start();
+    for(int64_t i = 0; i < _nitr; ++i)
+    {
+        _inner.start();
+        _inner.stop();
+    }
+    _outer.stop();
+
+    apply<void>::access<calibrate_t>(_outer.m_data, _nitr, bundle_id());
+    apply<void>::access<erase_node_t>(_inner.m_data);
+    apply<void>::access<erase_node_t>(_outer.m_data);
+    calibrating() = false;
+    return true;
+}
+
+//----------------------------------------------------------------------------------//
+// identifies the bundle type in the overhead estimates
+//
+template <typename... Types>
+inline uint64_t
+component_tuple<Types...>::bundle_id()
+{
+    static uint64_t _instance = typeid(this_type).hash_code();
+    return _instance;
+}
+
+//----------------------------------------------------------------------------------//
+// true while this thread is calibrating the bundle type
+//
+template <typename... Types>
+inline bool&
+component_tuple<Types...>::calibrating()
+{
+    static thread_local bool _instance = false;
+    return _instance;
+}
+
 //----------------------------------------------------------------------------------//
 // recording
 //
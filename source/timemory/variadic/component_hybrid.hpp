@@ -220,6 +220,12 @@ public:
         m_list.stop();
     }
 
+    void scaled_stop(const int64_t& _weight)
+    {
+        m_tuple.scaled_stop(_weight);
+        m_list.scaled_stop(_weight);
+    }
+
     //----------------------------------------------------------------------------------//
     // mark a beginning position in the execution (typically used by asynchronous
     // structures)
@@ -100,6 +100,7 @@ public:
         using minus_t            = _TypeL<operation::pointer_operator<_Types, operation::minus<_Types>>...>;
         using multiply_t         = _TypeL<operation::pointer_operator<_Types, operation::multiply<_Types>>...>;
         using divide_t           = _TypeL<operation::pointer_operator<_Types, operation::divide<_Types>>...>;
+        using scale_t            = _TypeL<operation::pointer_operator<_Types, operation::scale<_Types>>...>;
         using prior_start_t      = _TypeL<operation::pointer_operator<_Types, operation::priority_start<_Types>>...>;
         using prior_stop_t       = _TypeL<operation::pointer_operator<_Types, operation::priority_stop<_Types>>...>;
         using stand_start_t      = _TypeL<operation::pointer_operator<_Types, operation::standard_start<_Types>>...>;
@@ -160,6 +161,7 @@ public:
     using minus_t         = typename filtered<impl_unique_concat_type>::minus_t;
     using multiply_t      = typename filtered<impl_unique_concat_type>::multiply_t;
     using divide_t        = typename filtered<impl_unique_concat_type>::divide_t;
+    using scale_t         = typename filtered<impl_unique_concat_type>::scale_t;
     using print_t         = typename filtered<impl_unique_concat_type>::print_t;
     using prior_start_t   = typename filtered<impl_unique_concat_type>::prior_start_t;
     using prior_stop_t    = typename filtered<impl_unique_concat_type>::prior_stop_t;
@@ -254,6 +256,7 @@ public:
     void                    measure();
     void                    start();
     void                    stop();
+    void                    scaled_stop(const int64_t& _weight);
     this_type&              record();
     void                    reset();
     data_value_type         get() const;
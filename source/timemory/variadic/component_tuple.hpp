@@ -41,6 +41,7 @@
 #include <ios>
 #include <iostream>
 #include <string>
+#include <typeinfo>
 
 #include "timemory/backends/mpi.hpp"
 #include "timemory/bits/settings.hpp"
@@ -51,6 +52,7 @@
 #include "timemory/utility/macros.hpp"
 #include "timemory/utility/serializer.hpp"
 #include "timemory/utility/storage.hpp"
+#include "timemory/utility/trace.hpp"
 #include "timemory/variadic/types.hpp"
 
 //======================================================================================//
@@ -89,6 +91,7 @@ public:
         template <typename _Scope>
         using insert_node_t = _TypeL<operation::insert_node<_Types, _Scope>...>;
         using pop_node_t    = _TypeL<operation::pop_node<_Types>...>;
+        using erase_node_t  = _TypeL<operation::erase_node<_Types>...>;
         using measure_t     = _TypeL<operation::measure<_Types>...>;
         using record_t      = _TypeL<operation::record<_Types>...>;
         using reset_t       = _TypeL<operation::reset<_Types>...>;
@@ -96,6 +99,8 @@ public:
         using minus_t       = _TypeL<operation::minus<_Types>...>;
         using multiply_t    = _TypeL<operation::multiply<_Types>...>;
         using divide_t      = _TypeL<operation::divide<_Types>...>;
+        using scale_t       = _TypeL<operation::scale<_Types>...>;
+        using calibrate_t   = _TypeL<operation::calibrate<_Types>...>;
         using print_t       = _TypeL<operation::print<_Types>...>;
         using prior_start_t = _TypeL<operation::priority_start<_Types>...>;
         using prior_stop_t  = _TypeL<operation::priority_stop<_Types>...>;
@@ -143,6 +148,7 @@ public:
     template <typename _Scope>
     using insert_node_t = typename filtered<impl_unique_concat_type>::template insert_node_t<_Scope>;
     using pop_node_t    = typename filtered<impl_unique_concat_type>::pop_node_t;
+    using erase_node_t  = typename filtered<impl_unique_concat_type>::erase_node_t;
     using measure_t     = typename filtered<impl_unique_concat_type>::measure_t;
     using record_t      = typename filtered<impl_unique_concat_type>::record_t;
     using reset_t       = typename filtered<impl_unique_concat_type>::reset_t;
@@ -150,6 +156,8 @@ public:
     using minus_t       = typename filtered<impl_unique_concat_type>::minus_t;
     using multiply_t    = typename filtered<impl_unique_concat_type>::multiply_t;
     using divide_t      = typename filtered<impl_unique_concat_type>::divide_t;
+    using scale_t       = typename filtered<impl_unique_concat_type>::scale_t;
+    using calibrate_t   = typename filtered<impl_unique_concat_type>::calibrate_t;
     using print_t       = typename filtered<impl_unique_concat_type>::print_t;
     using prior_start_t = typename filtered<impl_unique_concat_type>::prior_start_t;
     using prior_stop_t  = typename filtered<impl_unique_concat_type>::prior_stop_t;
@@ -190,6 +198,8 @@ public:
     static constexpr std::size_t size() { return std::tuple_size<type_tuple>::value; }
     static void                  print_storage();
     static void                  init_storage();
+    static bool                  calibrate(int64_t _nitr = 1000);
+    static uint64_t              bundle_id();
 
     //----------------------------------------------------------------------------------//
     // public member functions
@@ -199,6 +209,7 @@ public:
     void                    measure();
     void                    start();
     void                    stop();
+    void                    scaled_stop(const int64_t& _weight);
     this_type&              record();
     void                    reset();
     data_value_type         get() const;
@@ -379,6 +390,7 @@ public:
 protected:
     // protected static functions
     static int64_t output_width(int64_t = 0);
+    static bool&   calibrating();
 
     // protected member functions
     inline data_type&       get_data();
@@ -0,0 +1,692 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory-bench.cpp
+ * Overhead benchmark suite. Measures the cost (in nanoseconds per operation) of:
+ *
+ *      - construct / start / stop / destruct of every available component
+ *      - the same for component_tuple, component_list, component_hybrid and the
+ *        auto_tuple, auto_list, auto_hybrid variants
+ *      - the C library API (timemory_get_begin_record / timemory_end_record)
+ *      - graph insertion at various depths and fan-outs
+ *      - merging the call-graphs of worker threads into the master
+ *      - flattening (storage::get) and JSON serialization of the call-graph
+ *
+ * Each measurement is repeated and the min/median/mean/stddev over the repetitions is
+ * written to a JSON file so that regressions can be tracked across releases.
+ *
+ *  usage: timemory-bench [options]
+ *
+ *      -n, --iterations N      operations per repetition (default: 1000)
+ *      -r, --repeat N          repetitions per measurement (default: 10)
+ *      -t, --threads N         max number of threads in merge benchmark (default: 8)
+ *      -o, --output FILE       JSON output file (default: timemory-bench.json)
+ *      -f, --filter STR        only run benchmarks whose group or name contains STR
+ *
+ */
+
+#include "timemory/timemory.hpp"
+#include "timemory/version.h"
+
+#if defined(TIMEMORY_BENCH_USE_LIBRARY)
+#    include "timemory/library.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace tim::component;
+
+using clock_type = std::chrono::steady_clock;
+using string_t   = std::string;
+
+//======================================================================================//
+//
+//      Configuration
+//
+//======================================================================================//
+
+namespace config
+{
+static int64_t  iterations = 1000;
+static int64_t  repeat     = 10;
+static int64_t  threads    = 8;
+static string_t output     = "timemory-bench.json";
+static string_t filter     = "";
+}  // namespace config
+
+//--------------------------------------------------------------------------------------//
+//  components which are excluded from the per-component benchmarks because the first
+//  start runs an expensive calibration (roofline) or writes a profile (gperftools)
+//
+template <typename _Tp>
+struct is_benchmarked : std::true_type
+{};
+
+template <>
+struct is_benchmarked<cpu_roofline_dp_flops> : std::false_type
+{};
+template <>
+struct is_benchmarked<cpu_roofline_flops> : std::false_type
+{};
+template <>
+struct is_benchmarked<cpu_roofline_sp_flops> : std::false_type
+{};
+template <>
+struct is_benchmarked<gpu_roofline_dp_flops> : std::false_type
+{};
+template <>
+struct is_benchmarked<gpu_roofline_flops> : std::false_type
+{};
+template <>
+struct is_benchmarked<gpu_roofline_hp_flops> : std::false_type
+{};
+template <>
+struct is_benchmarked<gpu_roofline_sp_flops> : std::false_type
+{};
+template <>
+struct is_benchmarked<gperf_cpu_profiler> : std::false_type
+{};
+template <>
+struct is_benchmarked<gperf_heap_profiler> : std::false_type
+{};
+
+using benchmarked_tuple_t =
+    tim::impl::filter_false<is_benchmarked, tim::available_tuple<tim::complete_tuple_t>>;
+
+//--------------------------------------------------------------------------------------//
+//  bundles
+//
+using bundle_tuple_t  = tim::component_tuple<real_clock, cpu_clock, peak_rss>;
+using bundle_list_t   = tim::component_list<real_clock, cpu_clock, peak_rss>;
+using bundle_hybrid_t = tim::component_hybrid<bundle_tuple_t, bundle_list_t>;
+using auto_tuple_t    = tim::auto_tuple<real_clock, cpu_clock, peak_rss>;
+using auto_list_t     = tim::auto_list<real_clock, cpu_clock, peak_rss>;
+using auto_hybrid_t   = tim::auto_hybrid<bundle_tuple_t, bundle_list_t>;
+using graph_tuple_t   = tim::component_tuple<real_clock>;
+
+//======================================================================================//
+//
+//      Results
+//
+//======================================================================================//
+
+struct result_type
+{
+    string_t            group   = "";
+    string_t            name    = "";
+    string_t            phase   = "";
+    int64_t             nops    = 0;
+    std::vector<double> samples = {};  // nanoseconds per operation, one per repetition
+
+    double min() const { return *std::min_element(samples.begin(), samples.end()); }
+    double max() const { return *std::max_element(samples.begin(), samples.end()); }
+    double mean() const
+    {
+        return std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    }
+    double median() const
+    {
+        auto _sorted = samples;
+        std::sort(_sorted.begin(), _sorted.end());
+        auto _n = _sorted.size();
+        return (_n % 2 == 0) ? 0.5 * (_sorted.at(_n / 2 - 1) + _sorted.at(_n / 2))
+                             : _sorted.at(_n / 2);
+    }
+    double stddev() const
+    {
+        if(samples.size() < 2)
+            return 0.0;
+        auto   _mean = mean();
+        double _sum  = 0.0;
+        for(const auto& itr : samples)
+            _sum += (itr - _mean) * (itr - _mean);
+        return std::sqrt(_sum / (samples.size() - 1));
+    }
+};
+
+using result_array_type = std::vector<result_type>;
+
+static result_array_type&
+get_results()
+{
+    static result_array_type _instance;
+    return _instance;
+}
+
+//--------------------------------------------------------------------------------------//
+
+static bool
+is_selected(const string_t& _group, const string_t& _name)
+{
+    return config::filter.empty() || _group.find(config::filter) != string_t::npos ||
+           _name.find(config::filter) != string_t::npos;
+}
+
+//--------------------------------------------------------------------------------------//
+
+static result_type&
+get_result(const string_t& _group, const string_t& _name, const string_t& _phase,
+           int64_t _nops)
+{
+    auto& _results = get_results();
+    for(auto& itr : _results)
+    {
+        if(itr.group == _group && itr.name == _name && itr.phase == _phase)
+            return itr;
+    }
+    result_type _entry;
+    _entry.group = _group;
+    _entry.name  = _name;
+    _entry.phase = _phase;
+    _entry.nops  = _nops;
+    _results.push_back(_entry);
+    return _results.back();
+}
+
+//--------------------------------------------------------------------------------------//
+
+static void
+add_sample(const string_t& _group, const string_t& _name, const string_t& _phase,
+           int64_t _nops, double _nsec)
+{
+    auto& _entry = get_result(_group, _name, _phase, _nops);
+    _entry.samples.push_back((_nops > 0) ? (_nsec / _nops) : _nsec);
+}
+
+//--------------------------------------------------------------------------------------//
+
+template <typename _Duration>
+static double
+to_nsec(const _Duration& _dur)
+{
+    return std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(_dur)
+        .count();
+}
+
+//--------------------------------------------------------------------------------------//
+//  cost of reading the clock: subtracted from the individually timed start/stop
+//
+static double
+clock_overhead()
+{
+    static double _instance = []() {
+        const int64_t n      = 100000;
+        auto          _beg   = clock_type::now();
+        auto          _dummy = _beg;
+        for(int64_t i = 0; i < n; ++i)
+            _dummy = clock_type::now();
+        auto _end = clock_type::now();
+        tim::consume_parameters(_dummy);
+        return to_nsec(_end - _beg) / n;
+    }();
+    return _instance;
+}
+
+//======================================================================================//
+//
+//      Lifecycle benchmarks: construct, start, stop, destruct
+//
+//======================================================================================//
+
+template <typename _Tp>
+struct lifecycle
+{
+    using storage_type = typename std::aligned_storage<sizeof(_Tp), alignof(_Tp)>::type;
+
+    // bundles which are started/stopped explicitly
+    static void run(const string_t& _group, const string_t& _name)
+    {
+        if(!is_selected(_group, _name))
+            return;
+
+        const auto               n = config::iterations;
+        std::vector<storage_type> _buffer(n);
+        auto _get = [&](int64_t i) { return reinterpret_cast<_Tp*>(&_buffer[i]); };
+
+        // keep the labels out of the measurement
+        const string_t _label = _group + "/" + _name;
+        for(int64_t r = 0; r < config::repeat; ++r)
+        {
+            auto _beg = clock_type::now();
+            for(int64_t i = 0; i < n; ++i)
+                new(_get(i)) _Tp(_label, true);
+            add_sample(_group, _name, "construct", n, to_nsec(clock_type::now() - _beg));
+
+            // start and stop each object before the next one is started so that the
+            // graph does not grow in depth
+            double _start = 0.0;
+            double _stop  = 0.0;
+            for(int64_t i = 0; i < n; ++i)
+            {
+                auto _t0 = clock_type::now();
+                _get(i)->start();
+                auto _t1 = clock_type::now();
+                _get(i)->stop();
+                auto _t2 = clock_type::now();
+                _start += to_nsec(_t1 - _t0);
+                _stop += to_nsec(_t2 - _t1);
+            }
+            _start = std::max(_start - n * clock_overhead(), 0.0);
+            _stop  = std::max(_stop - n * clock_overhead(), 0.0);
+            add_sample(_group, _name, "start", n, _start);
+            add_sample(_group, _name, "stop", n, _stop);
+
+            _beg = clock_type::now();
+            for(int64_t i = 0; i < n; ++i)
+                _get(i)->~_Tp();
+            add_sample(_group, _name, "destruct", n, to_nsec(clock_type::now() - _beg));
+        }
+    }
+
+    // auto_* bundles: construction starts, destruction stops
+    static void run_auto(const string_t& _group, const string_t& _name)
+    {
+        if(!is_selected(_group, _name))
+            return;
+
+        const auto     n      = config::iterations;
+        const string_t _label = _group + "/" + _name;
+        for(int64_t r = 0; r < config::repeat; ++r)
+        {
+            auto _beg = clock_type::now();
+            for(int64_t i = 0; i < n; ++i)
+            {
+                _Tp _obj(_label);
+                tim::consume_parameters(_obj);
+            }
+            add_sample(_group, _name, "scope", n, to_nsec(clock_type::now() - _beg));
+        }
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+//  apply lifecycle<component_tuple<T>> to each type in the tuple
+//
+template <typename _Tuple>
+struct component_lifecycle;
+
+template <typename... _Types>
+struct component_lifecycle<std::tuple<_Types...>>
+{
+    static void run()
+    {
+        int _dummy[] = { (lifecycle<tim::component_tuple<_Types>>::run(
+                              "component", _Types::label()),
+                          0)...,
+                         0 };
+        tim::consume_parameters(_dummy);
+    }
+};
+
+//======================================================================================//
+//
+//      C library API
+//
+//======================================================================================//
+
+static void
+run_library()
+{
+#if defined(TIMEMORY_BENCH_USE_LIBRARY)
+    const string_t _group = "library";
+    const string_t _name  = "timemory_get_begin_record";
+    if(!is_selected(_group, _name))
+        return;
+
+    timemory_push_components("real_clock");
+    const auto n = config::iterations;
+    for(int64_t r = 0; r < config::repeat; ++r)
+    {
+        double _begin = 0.0;
+        double _end   = 0.0;
+        for(int64_t i = 0; i < n; ++i)
+        {
+            auto _t0 = clock_type::now();
+            auto _id = timemory_get_begin_record("library");
+            auto _t1 = clock_type::now();
+            timemory_end_record(_id);
+            auto _t2 = clock_type::now();
+            _begin += to_nsec(_t1 - _t0);
+            _end += to_nsec(_t2 - _t1);
+        }
+        add_sample(_group, _name, "begin", n,
+                   std::max(_begin - n * clock_overhead(), 0.0));
+        add_sample(_group, _name, "end", n, std::max(_end - n * clock_overhead(), 0.0));
+    }
+    timemory_pop_components();
+#endif
+}
+
+//======================================================================================//
+//
+//      Graph insertion at various depths and fan-outs
+//
+//======================================================================================//
+
+static void
+run_graph_insert()
+{
+    const string_t _group = "graph";
+    const auto     n      = config::iterations;
+
+    for(int64_t _depth : { 1, 4, 16, 64 })
+    {
+        for(int64_t _fanout : { 1, 16, 256 })
+        {
+            auto _name = "depth=" + std::to_string(_depth) +
+                         ",fanout=" + std::to_string(_fanout);
+            if(!is_selected(_group, _name))
+                continue;
+
+            std::vector<string_t> _labels;
+            for(int64_t i = 0; i < _fanout; ++i)
+                _labels.push_back(_name + "/child-" + std::to_string(i));
+
+            // open the parents so that the measured entries are inserted at _depth
+            std::vector<graph_tuple_t> _parents;
+            _parents.reserve(_depth);
+            for(int64_t i = 0; i + 1 < _depth; ++i)
+            {
+                _parents.emplace_back(_name + "/parent-" + std::to_string(i), true);
+                _parents.back().start();
+            }
+
+            for(int64_t r = 0; r < config::repeat; ++r)
+            {
+                auto _beg = clock_type::now();
+                for(int64_t i = 0; i < n; ++i)
+                {
+                    graph_tuple_t _obj(_labels[i % _fanout], true);
+                    _obj.start();
+                    _obj.stop();
+                }
+                add_sample(_group, _name, "insert", n, to_nsec(clock_type::now() - _beg));
+            }
+
+            for(auto itr = _parents.rbegin(); itr != _parents.rend(); ++itr)
+                itr->stop();
+        }
+    }
+}
+
+//======================================================================================//
+//
+//      Thread merge: the worker storage is merged into the master when the thread
+//      exits so the join is timed after every worker has finished recording
+//
+//======================================================================================//
+
+static void
+run_thread_merge()
+{
+    const string_t _group = "merge";
+
+    std::vector<int64_t> _nthreads = { 1 };
+    while(_nthreads.back() * 2 <= config::threads)
+        _nthreads.push_back(_nthreads.back() * 2);
+
+    for(auto _nthread : _nthreads)
+    {
+        for(int64_t _nnodes : { 16, 256 })
+        {
+            auto _name = "threads=" + std::to_string(_nthread) +
+                         ",nodes=" + std::to_string(_nnodes);
+            if(!is_selected(_group, _name))
+                continue;
+
+            for(int64_t r = 0; r < config::repeat; ++r)
+            {
+                std::atomic<int64_t> _done(0);
+                auto                 _record = [&](int64_t _tid) {
+                    for(int64_t i = 0; i < _nnodes; ++i)
+                    {
+                        graph_tuple_t _obj(_name + "/thread-" + std::to_string(_tid) +
+                                               "/node-" + std::to_string(i),
+                                           true);
+                        _obj.start();
+                        _obj.stop();
+                    }
+                    ++_done;
+                };
+
+                std::vector<std::thread> _threads;
+                for(int64_t i = 0; i < _nthread; ++i)
+                    _threads.push_back(std::thread(_record, i));
+                while(_done.load() < _nthread)
+                    std::this_thread::yield();
+
+                auto _beg = clock_type::now();
+                for(auto& itr : _threads)
+                    itr.join();
+                add_sample(_group, _name, "merge", _nthread * _nnodes,
+                           to_nsec(clock_type::now() - _beg));
+            }
+        }
+    }
+}
+
+//======================================================================================//
+//
+//      Flattening and serialization of the call-graph built by the benchmarks above
+//
+//======================================================================================//
+
+static void
+run_serialization()
+{
+    const string_t _group = "serialization";
+    auto           _storage = tim::storage<real_clock>::instance();
+    auto           _name    = "real_clock,nodes=" + std::to_string(_storage->size());
+    if(!is_selected(_group, _name))
+        return;
+
+    auto _nnodes = static_cast<int64_t>(_storage->size());
+    for(int64_t r = 0; r < config::repeat; ++r)
+    {
+        auto _beg     = clock_type::now();
+        auto _results = _storage->get();
+        add_sample(_group, _name, "get", _nnodes, to_nsec(clock_type::now() - _beg));
+        tim::consume_parameters(_results);
+
+        std::stringstream ss;
+        _beg = clock_type::now();
+        {
+            cereal::JSONOutputArchive oa(ss);
+            oa(cereal::make_nvp("data", *_storage));
+        }
+        add_sample(_group, _name, "json", _nnodes, to_nsec(clock_type::now() - _beg));
+    }
+}
+
+//======================================================================================//
+//
+//      Output
+//
+//======================================================================================//
+
+static void
+print_results(std::ostream& os)
+{
+    size_t _width = 0;
+    for(const auto& itr : get_results())
+        _width = std::max(_width, (itr.group + "/" + itr.name + "/" + itr.phase).length());
+
+    os << std::setw(_width) << std::left << "benchmark" << std::right << std::setw(12)
+       << "min" << std::setw(12) << "median" << std::setw(12) << "mean"
+       << std::setw(12) << "stddev"
+       << "  [nsec/op]\n";
+    os << std::fixed << std::setprecision(2);
+    for(const auto& itr : get_results())
+    {
+        os << std::setw(_width) << std::left
+           << (itr.group + "/" + itr.name + "/" + itr.phase) << std::right
+           << std::setw(12) << itr.min() << std::setw(12) << itr.median()
+           << std::setw(12) << itr.mean() << std::setw(12) << itr.stddev() << "\n";
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+
+static void
+write_json(std::ostream& os)
+{
+    auto _str = [](const string_t& _s) { return "\"" + _s + "\""; };
+
+    os << std::setprecision(6) << std::fixed;
+    os << "{\n    \"timemory-bench\": {\n";
+    os << "        \"version\": " << _str(TIMEMORY_VERSION_STRING) << ",\n";
+#if defined(__VERSION__)
+    os << "        \"compiler\": " << _str(__VERSION__) << ",\n";
+#endif
+    os << "        \"iterations\": " << config::iterations << ",\n";
+    os << "        \"repeat\": " << config::repeat << ",\n";
+    os << "        \"clock_overhead\": " << clock_overhead() << ",\n";
+    os << "        \"units\": \"nsec/op\",\n";
+    os << "        \"results\": [";
+    auto& _results = get_results();
+    for(size_t i = 0; i < _results.size(); ++i)
+    {
+        const auto& itr = _results.at(i);
+        os << ((i == 0) ? "\n" : ",\n") << "            { \"group\": " << _str(itr.group)
+           << ", \"name\": " << _str(itr.name) << ", \"phase\": " << _str(itr.phase)
+           << ", \"nops\": " << itr.nops << ", \"min\": " << itr.min()
+           << ", \"median\": " << itr.median() << ", \"mean\": " << itr.mean()
+           << ", \"max\": " << itr.max() << ", \"stddev\": " << itr.stddev() << " }";
+    }
+    os << "\n        ]\n    }\n}\n";
+}
+
+//--------------------------------------------------------------------------------------//
+
+static void
+usage(const char* _exe)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n\n"
+            "    -n, --iterations N   operations per repetition (default: %lli)\n"
+            "    -r, --repeat     N   repetitions per measurement (default: %lli)\n"
+            "    -t, --threads    N   max threads in the merge benchmark (default: %lli)\n"
+            "    -o, --output     F   JSON output file (default: %s)\n"
+            "    -f, --filter     S   only run benchmarks whose group or name contains S\n"
+            "    -h, --help           print this message\n",
+            _exe, (long long) config::iterations, (long long) config::repeat,
+            (long long) config::threads, config::output.c_str());
+}
+
+//======================================================================================//
+
+int
+main(int argc, char** argv)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        string_t _arg = argv[i];
+        auto     _val = [&]() -> string_t {
+            if(i + 1 >= argc)
+            {
+                fprintf(stderr, "Error! Missing value for '%s'\n", _arg.c_str());
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+            }
+            return argv[++i];
+        };
+
+        if(_arg == "-h" || _arg == "--help")
+        {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        else if(_arg == "-n" || _arg == "--iterations")
+            config::iterations = std::max<int64_t>(std::stoll(_val()), 1);
+        else if(_arg == "-r" || _arg == "--repeat")
+            config::repeat = std::max<int64_t>(std::stoll(_val()), 1);
+        else if(_arg == "-t" || _arg == "--threads")
+            config::threads = std::max<int64_t>(std::stoll(_val()), 1);
+        else if(_arg == "-o" || _arg == "--output")
+            config::output = _val();
+        else if(_arg == "-f" || _arg == "--filter")
+            config::filter = _val();
+        else
+        {
+            fprintf(stderr, "Error! Unknown option '%s'\n", _arg.c_str());
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // only the benchmark results are reported
+    tim::settings::cout_output() = false;
+    tim::settings::file_output() = false;
+    tim::settings::banner()      = false;
+    tim::timemory_init(argc, argv);
+
+    bundle_list_t::get_initializer() = [](bundle_list_t& _obj) {
+        _obj.initialize<real_clock, cpu_clock, peak_rss>();
+    };
+
+    // per-component
+    component_lifecycle<benchmarked_tuple_t>::run();
+
+    // bundles
+    lifecycle<bundle_tuple_t>::run("bundle", "component_tuple");
+    lifecycle<bundle_list_t>::run("bundle", "component_list");
+    lifecycle<bundle_hybrid_t>::run("bundle", "component_hybrid");
+    lifecycle<auto_tuple_t>::run_auto("bundle", "auto_tuple");
+    lifecycle<auto_list_t>::run_auto("bundle", "auto_list");
+    lifecycle<auto_hybrid_t>::run_auto("bundle", "auto_hybrid");
+    run_library();
+
+    // storage
+    run_graph_insert();
+    run_thread_merge();
+    run_serialization();
+
+    print_results(std::cout);
+
+    std::ofstream ofs(config::output.c_str());
+    if(!ofs)
+    {
+        fprintf(stderr, "Error! Unable to open '%s'\n", config::output.c_str());
+        return EXIT_FAILURE;
+    }
+    write_json(ofs);
+    printf("\n[timemory-bench]> Outputting '%s'...\n", config::output.c_str());
+
+    return EXIT_SUCCESS;
+}
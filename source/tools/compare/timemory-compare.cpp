@@ -0,0 +1,1085 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory-compare.cpp
+ * Compares the JSON output (serialize_storage) of two or more runs and reports the
+ * call-graph nodes which regressed w.r.t. the first (baseline) result set.
+ *
+ *  usage: timemory-compare [options] <baseline> <result> [<result>...]
+ *
+ *  Each result set is a JSON file, a directory of JSON files (e.g. one per component
+ *  and/or rank), or a comma-separated list of these. Files within one entry are summed
+ *  (ranks, components, and the per-thread graphs of thread_output), multiple
+ *  comma-separated entries are treated as repeated runs and the mean and standard
+ *  deviation over the runs are used.
+ *
+ *  Nodes are aligned by their hierarchical label path (e.g. "main/solve/exchange"),
+ *  not by the raw hash, so results from different builds can be compared.
+ *
+ *      -t, --threshold PCT     min. relative change to report (default: 5)
+ *      -s, --sigma N           noise band in std. deviations for repeated runs
+ *                              (default: 2)
+ *      -n, --noise FACTOR      relative noise w/o repeated runs: FACTOR / sqrt(laps)
+ *                              (default: 0.1)
+ *      -m, --min-value VAL     ignore nodes whose values are below VAL (default: 0)
+ *      -c, --component LIST    only compare these components (e.g. "wall,peak_rss")
+ *      -i, --invert LIST       components where higher values are better
+ *      -r, --rows N            max number of rows in the report (default: 25)
+ *      -a, --all               also report improvements
+ *
+ *  exit codes: 0 (no regressions), 1 (regressions), 2 (error)
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+using string_t = std::string;
+using strvec_t = std::vector<string_t>;
+
+//======================================================================================//
+//
+//      Configuration
+//
+//======================================================================================//
+
+struct config
+{
+    double   threshold = 0.05;
+    double   sigma     = 2.0;
+    double   noise     = 0.1;
+    double   min_value = 0.0;
+    size_t   rows      = 25;
+    bool     all       = false;
+    strvec_t components;
+    strvec_t inverted;
+};
+
+//--------------------------------------------------------------------------------------//
+
+strvec_t
+delimit(const string_t& _str, const string_t& _delim = ",")
+{
+    strvec_t _ret;
+    size_t   _beg = 0;
+    while(_beg <= _str.length())
+    {
+        auto _end = _str.find_first_of(_delim, _beg);
+        if(_end == string_t::npos)
+            _end = _str.length();
+        if(_end > _beg)
+            _ret.push_back(_str.substr(_beg, _end - _beg));
+        _beg = _end + 1;
+    }
+    return _ret;
+}
+
+//--------------------------------------------------------------------------------------//
+//  array-type components (e.g. papi) are identified by their labels joined with '+',
+//  match either the full identifier or one of the labels
+//
+bool
+matches(const strvec_t& _list, const string_t& _type)
+{
+    for(const auto& itr : _list)
+    {
+        if(itr == _type)
+            return true;
+        for(const auto& litr : delimit(_type, "+"))
+            if(itr == litr)
+                return true;
+    }
+    return false;
+}
+
+//======================================================================================//
+//
+//      Streaming JSON reader
+//
+//======================================================================================//
+//
+//  the output files can be several hundred MB so the documents are never loaded into
+//  memory: the reader walks the file with a fixed-size buffer and reports the
+//  structure to a handler which only keeps the fields it needs
+//
+class json_reader
+{
+public:
+    explicit json_reader(FILE* _fp)
+    : m_fp(_fp)
+    , m_buffer(1 << 20)
+    {}
+
+    template <typename _Handler>
+    bool parse(_Handler& _handler)
+    {
+        skip_ws();
+        if(!parse_value(_handler))
+            return false;
+        skip_ws();
+        return (peek() == EOF);
+    }
+
+    const string_t& error() const { return m_error; }
+    size_t          offset() const { return m_offset; }
+
+private:
+    int peek()
+    {
+        if(m_pos == m_size)
+        {
+            m_size = fread(m_buffer.data(), 1, m_buffer.size(), m_fp);
+            m_pos  = 0;
+            if(m_size == 0)
+                return EOF;
+        }
+        return static_cast<unsigned char>(m_buffer[m_pos]);
+    }
+
+    int next()
+    {
+        int _c = peek();
+        if(_c != EOF)
+        {
+            ++m_pos;
+            ++m_offset;
+        }
+        return _c;
+    }
+
+    void skip_ws()
+    {
+        while(peek() != EOF)
+        {
+            while(m_pos < m_size)
+            {
+                char _c = m_buffer[m_pos];
+                if(_c != ' ' && _c != '\n' && _c != '\t' && _c != '\r')
+                    return;
+                ++m_pos;
+                ++m_offset;
+            }
+        }
+    }
+
+    bool fail(const string_t& _msg)
+    {
+        if(m_error.empty())
+            m_error = _msg;
+        return false;
+    }
+
+    bool expect(const char* _literal)
+    {
+        for(const char* itr = _literal; *itr != '\0'; ++itr)
+            if(next() != *itr)
+                return fail(string_t("invalid literal, expected '") + _literal + "'");
+        return true;
+    }
+
+    bool parse_string(string_t& _str)
+    {
+        _str.clear();
+        if(next() != '"')
+            return fail("expected string");
+        while(true)
+        {
+            // copy everything up to the next quote or escape in one step
+            if(peek() == EOF)
+                return fail("unterminated string");
+            size_t _end = m_pos;
+            while(_end < m_size && m_buffer[_end] != '"' && m_buffer[_end] != '\\')
+                ++_end;
+            _str.append(m_buffer.data() + m_pos, _end - m_pos);
+            m_offset += _end - m_pos;
+            m_pos = _end;
+            if(m_pos == m_size)
+                continue;
+
+            int _c = next();
+            if(_c == '"')
+                return true;
+            if(_c == '\\')
+            {
+                _c = next();
+                switch(_c)
+                {
+                    case 'n': _str += '\n'; break;
+                    case 't': _str += '\t'; break;
+                    case 'r': _str += '\r'; break;
+                    case 'b': _str += '\b'; break;
+                    case 'f': _str += '\f'; break;
+                    case 'u':
+                    {
+                        // labels are ASCII in practice: keep the escape as-is
+                        _str += "\\u";
+                        for(int i = 0; i < 4; ++i)
+                            _str += static_cast<char>(next());
+                        break;
+                    }
+                    case EOF: return fail("unterminated string");
+                    default: _str += static_cast<char>(_c); break;
+                }
+            }
+            else
+            {
+                _str += static_cast<char>(_c);
+            }
+        }
+    }
+
+    bool parse_number(double& _val)
+    {
+        char   _buf[64];
+        size_t _n = 0;
+        int    _c = peek();
+        while(_c != EOF && (isdigit(_c) || _c == '-' || _c == '+' || _c == '.' ||
+                            _c == 'e' || _c == 'E'))
+        {
+            if(_n + 1 < sizeof(_buf))
+                _buf[_n++] = static_cast<char>(_c);
+            next();
+            _c = peek();
+        }
+        _buf[_n] = '\0';
+        if(_n == 0)
+            return fail("expected value");
+        char* _end = nullptr;
+        _val       = strtod(_buf, &_end);
+        return (_end == _buf + _n) ? true : fail("invalid number");
+    }
+
+    template <typename _Handler>
+    bool parse_value(_Handler& _handler)
+    {
+        switch(peek())
+        {
+            case '{':
+            {
+                next();
+                _handler.begin_object();
+                skip_ws();
+                if(peek() == '}')
+                {
+                    next();
+                    _handler.end_object();
+                    return true;
+                }
+                while(true)
+                {
+                    skip_ws();
+                    if(!parse_string(m_key))
+                        return false;
+                    skip_ws();
+                    if(next() != ':')
+                        return fail("expected ':'");
+                    skip_ws();
+                    _handler.key(m_key);
+                    if(!parse_value(_handler))
+                        return false;
+                    skip_ws();
+                    int _c = next();
+                    if(_c == '}')
+                        break;
+                    if(_c != ',')
+                        return fail("expected ',' or '}'");
+                }
+                _handler.end_object();
+                return true;
+            }
+            case '[':
+            {
+                next();
+                _handler.begin_array();
+                skip_ws();
+                if(peek() == ']')
+                {
+                    next();
+                    _handler.end_array();
+                    return true;
+                }
+                while(true)
+                {
+                    skip_ws();
+                    if(!parse_value(_handler))
+                        return false;
+                    skip_ws();
+                    int _c = next();
+                    if(_c == ']')
+                        break;
+                    if(_c != ',')
+                        return fail("expected ',' or ']'");
+                }
+                _handler.end_array();
+                return true;
+            }
+            case '"':
+            {
+                if(!parse_string(m_str))
+                    return false;
+                _handler.string(m_str);
+                return true;
+            }
+            case 't':
+                _handler.number(1.0);
+                return expect("true");
+            case 'f':
+                _handler.number(0.0);
+                return expect("false");
+            case 'n':
+                _handler.null();
+                return expect("null");
+            default:
+            {
+                double _val = 0.0;
+                if(!parse_number(_val))
+                    return false;
+                _handler.number(_val);
+                return true;
+            }
+        }
+    }
+
+private:
+    FILE*             m_fp;
+    std::vector<char> m_buffer;
+    size_t            m_pos    = 0;
+    size_t            m_size   = 0;
+    size_t            m_offset = 0;
+    string_t          m_key;
+    string_t          m_str;
+    string_t          m_error;
+};
+
+//======================================================================================//
+//
+//      Result data
+//
+//======================================================================================//
+
+struct node_data
+{
+    uint64_t            key   = 0;
+    string_t            path  = "";
+    int64_t             depth = 0;
+    int64_t             laps  = 0;
+    std::vector<double> value;
+};
+
+//--------------------------------------------------------------------------------------//
+
+struct component_data
+{
+    string_t                             type = "";
+    string_t                             unit = "";
+    std::unordered_map<uint64_t, size_t> index;
+    std::vector<node_data>               nodes;
+
+    // sum the data of a node, e.g. from another rank or thread
+    void add(node_data&& _node)
+    {
+        auto itr = index.find(_node.key);
+        if(itr == index.end())
+        {
+            index.insert({ _node.key, nodes.size() });
+            nodes.emplace_back(std::move(_node));
+            return;
+        }
+        auto& _dst = nodes.at(itr->second);
+        _dst.laps += _node.laps;
+        if(_dst.value.size() < _node.value.size())
+            _dst.value.resize(_node.value.size(), 0.0);
+        for(size_t i = 0; i < _node.value.size(); ++i)
+            _dst.value[i] += _node.value[i];
+    }
+};
+
+using run_data_t = std::map<string_t, component_data>;
+
+//--------------------------------------------------------------------------------------//
+//  statistics over the repeated runs of a result set
+//
+struct node_stats
+{
+    string_t            path = "";
+    int64_t             laps = 0;
+    std::vector<double> mean;
+    std::vector<double> stddev;
+};
+
+struct result_set
+{
+    using node_map_t = std::unordered_map<uint64_t, node_stats>;
+
+    string_t                       name  = "";
+    size_t                         nruns = 0;
+    std::map<string_t, string_t>   units;
+    std::map<string_t, node_map_t> data;
+};
+
+//======================================================================================//
+//
+//      Handler which extracts the graph entries of serialize_storage output
+//
+//======================================================================================//
+
+class storage_handler
+{
+public:
+    explicit storage_handler(run_data_t& _data)
+    : m_data(_data)
+    {}
+
+    void begin_object()
+    {
+        m_stack.push_back(frame{ false, in_repr_data(), m_key });
+        if(in_graph_entry())
+            m_node = node_data{};
+        m_key.clear();
+    }
+
+    void end_object()
+    {
+        if(in_graph_entry())
+            finish_node();
+        // the end of a component: flush the nodes collected for its "type"
+        if(!m_type.empty() && m_stack.size() == m_type_depth)
+            flush();
+        m_stack.pop_back();
+        m_key.clear();
+    }
+
+    void begin_array()
+    {
+        if(m_key == "type" && !in_graph())
+        {
+            flush();
+            m_type_depth = m_stack.size();
+        }
+        m_stack.push_back(frame{ true, in_repr_data(), m_key });
+        // each graph (of the process or, with thread_output, of one thread) starts a
+        // new hierarchy. A component has either a "graph" or the graphs of its
+        // "threads", never both, so the per-thread graphs are summed like ranks
+        if(m_key == "graph")
+        {
+            ++m_graph;
+            m_path.clear();
+        }
+        m_key.clear();
+    }
+
+    void end_array()
+    {
+        if(m_stack.back().key == "graph")
+            --m_graph;
+        m_stack.pop_back();
+        m_key.clear();
+    }
+
+    void key(const string_t& _key) { m_key = _key; }
+
+    void string(const string_t& _str)
+    {
+        if(in_repr_data())
+            return;
+        auto _parent = parent_key();
+        if(m_key == "type" && !in_graph())
+        {
+            flush();
+            m_type       = _str;
+            m_type_depth = m_stack.size();
+        }
+        else if(_parent == "type" && m_stack.back().is_array && !in_graph())
+        {
+            // array-type components (e.g. papi) have an array of labels
+            m_type += ((m_type.empty()) ? "" : "+") + _str;
+        }
+        else if(m_key == "unit_repr" && !in_graph())
+            m_unit = _str;
+        else if(_parent == "unit_repr" && !in_graph() && m_unit.empty())
+            m_unit = _str;
+        else if(m_key == "prefix" && in_graph_entry())
+            m_node.path = _str;
+        m_key.clear();
+    }
+
+    void number(double _val)
+    {
+        if(in_repr_data())
+            m_node.value.push_back(_val);
+        else if(m_key == "depth" && in_graph_entry())
+            m_node.depth = static_cast<int64_t>(_val);
+        else if(m_key == "laps" && parent_key() == "entry" && in_graph())
+            m_node.laps = static_cast<int64_t>(_val);
+        m_key.clear();
+    }
+
+    void null() { m_key.clear(); }
+
+private:
+    struct frame
+    {
+        bool     is_array;
+        bool     is_repr;
+        string_t key;
+    };
+
+    struct path_entry
+    {
+        int64_t  depth;
+        uint64_t key;
+        string_t label;
+    };
+
+    const string_t& parent_key() const
+    {
+        static string_t _empty = "";
+        return (m_stack.empty()) ? _empty : m_stack.back().key;
+    }
+
+    // object which is an element of a "graph" array
+    bool in_graph_entry() const
+    {
+        auto n = m_stack.size();
+        return (n > 1 && !m_stack[n - 1].is_array && m_stack[n - 2].is_array &&
+                m_stack[n - 2].key == "graph");
+    }
+
+    bool in_graph() const { return (m_graph > 0); }
+
+    // the values inside entry.repr_data (scalar, array, or pair-like object)
+    bool in_repr_data() const
+    {
+        if(!m_stack.empty() && m_stack.back().is_repr)
+            return true;
+        return (m_key == "repr_data" && in_graph() && parent_key() == "entry");
+    }
+
+    // strip the rank prefix ("|0>>> ") and the indentation ("  |_") from the label
+    static string_t clean_label(const string_t& _prefix)
+    {
+        auto _pos = _prefix.find(">>> ");
+        auto _ret = (_pos == string_t::npos) ? _prefix : _prefix.substr(_pos + 4);
+        _pos      = _ret.find_first_not_of(" |_");
+        _ret      = (_pos == string_t::npos) ? _ret : _ret.substr(_pos);
+        while(!_ret.empty() && _ret.back() == ' ')
+            _ret.pop_back();
+        return _ret;
+    }
+
+    void finish_node()
+    {
+        auto _label = clean_label(m_node.path);
+        while(!m_path.empty() && m_path.back().depth >= m_node.depth)
+            m_path.pop_back();
+
+        // the key is the hash of the label combined with the key of the parent
+        uint64_t _parent = (m_path.empty()) ? 0 : m_path.back().key;
+        uint64_t _key    = std::hash<string_t>()(_label);
+        _key ^= _parent + 0x9e3779b97f4a7c15ULL + (_key << 6) + (_key >> 2);
+        m_path.push_back(path_entry{ m_node.depth, _key, _label });
+
+        m_node.key = _key;
+        m_node.path.clear();
+        for(const auto& itr : m_path)
+            m_node.path += ((m_node.path.empty()) ? "" : "/") + itr.label;
+        // the type is written before the graph, buffer the nodes if it is not
+        if(m_type.empty())
+            m_nodes.emplace_back(std::move(m_node));
+        else
+        {
+            if(!m_comp)
+                m_comp = &m_data[m_type];
+            m_comp->add(std::move(m_node));
+        }
+    }
+
+    void flush()
+    {
+        if(!m_type.empty() && (m_comp || !m_nodes.empty()))
+        {
+            auto& _comp = m_data[m_type];
+            _comp.type  = m_type;
+            if(_comp.unit.empty())
+                _comp.unit = m_unit;
+            for(auto& itr : m_nodes)
+                _comp.add(std::move(itr));
+        }
+        m_nodes.clear();
+        m_path.clear();
+        m_comp = nullptr;
+        m_type.clear();
+        m_unit.clear();
+        m_type_depth = 0;
+    }
+
+private:
+    run_data_t&                                m_data;
+    std::vector<frame>                         m_stack;
+    std::vector<path_entry>                    m_path;
+    std::vector<node_data>                     m_nodes;
+    node_data                                  m_node;
+    component_data*                            m_comp       = nullptr;
+    string_t                                   m_key        = "";
+    string_t                                   m_type       = "";
+    string_t                                   m_unit       = "";
+    size_t                                     m_type_depth = 0;
+    int64_t                                    m_graph      = 0;
+};
+
+//======================================================================================//
+//
+//      Loading
+//
+//======================================================================================//
+
+bool
+is_directory(const string_t& _path)
+{
+    struct stat _st;
+    return (stat(_path.c_str(), &_st) == 0 && S_ISDIR(_st.st_mode));
+}
+
+//--------------------------------------------------------------------------------------//
+
+strvec_t
+list_json_files(const string_t& _dir)
+{
+    strvec_t _ret;
+    DIR*     _dp = opendir(_dir.c_str());
+    if(!_dp)
+        return _ret;
+    while(struct dirent* _ent = readdir(_dp))
+    {
+        string_t _name = _ent->d_name;
+        if(_name.length() > 5 && _name.substr(_name.length() - 5) == ".json")
+            _ret.push_back(_dir + "/" + _name);
+    }
+    closedir(_dp);
+    std::sort(_ret.begin(), _ret.end());
+    return _ret;
+}
+
+//--------------------------------------------------------------------------------------//
+
+bool
+load_file(const string_t& _fname, run_data_t& _data)
+{
+    FILE* _fp = fopen(_fname.c_str(), "r");
+    if(!_fp)
+    {
+        fprintf(stderr, "Error! Unable to open '%s': %s\n", _fname.c_str(),
+                strerror(errno));
+        return false;
+    }
+
+    storage_handler _handler(_data);
+    json_reader     _reader(_fp);
+    bool            _ret = _reader.parse(_handler);
+    fclose(_fp);
+
+    if(!_ret)
+        fprintf(stderr, "Error! Unable to parse '%s' (offset %lu): %s\n",
+                _fname.c_str(), (unsigned long) _reader.offset(),
+                _reader.error().c_str());
+    return _ret;
+}
+
+//--------------------------------------------------------------------------------------//
+
+bool
+load_result_set(const string_t& _arg, const config& _config, result_set& _result)
+{
+    _result.name = _arg;
+    std::vector<run_data_t> _runs;
+
+    for(const auto& itr : delimit(_arg))
+    {
+        strvec_t _files = (is_directory(itr)) ? list_json_files(itr) : strvec_t{ itr };
+        if(_files.empty())
+        {
+            fprintf(stderr, "Error! No JSON files found in '%s'\n", itr.c_str());
+            return false;
+        }
+        _runs.push_back(run_data_t{});
+        for(const auto& fitr : _files)
+            if(!load_file(fitr, _runs.back()))
+                return false;
+    }
+
+    // mean and standard deviation over the runs
+    _result.nruns = _runs.size();
+    for(auto& ritr : _runs)
+    {
+        for(auto& citr : ritr)
+        {
+            if(!_config.components.empty() && !matches(_config.components, citr.first))
+                continue;
+            _result.units[citr.first] = citr.second.unit;
+            auto& _comp               = _result.data[citr.first];
+            _comp.reserve(citr.second.nodes.size());
+            for(auto& nitr : citr.second.nodes)
+            {
+                auto _n    = nitr.value.size();
+                auto _sitr = _comp.find(nitr.key);
+                if(_sitr == _comp.end())
+                {
+                    node_stats _stats;
+                    _stats.path = std::move(nitr.path);
+                    _stats.laps = nitr.laps;
+                    _stats.stddev.resize(_n, 0.0);
+                    for(size_t i = 0; i < _n; ++i)
+                        _stats.stddev[i] = nitr.value[i] * nitr.value[i];
+                    _stats.mean = std::move(nitr.value);
+                    _comp.insert({ nitr.key, std::move(_stats) });
+                    continue;
+                }
+
+                auto& _stats = _sitr->second;
+                if(_stats.mean.size() < _n)
+                {
+                    _stats.mean.resize(_n, 0.0);
+                    _stats.stddev.resize(_n, 0.0);
+                }
+                _stats.laps += nitr.laps;
+                for(size_t i = 0; i < _n; ++i)
+                {
+                    // accumulate sum and sum of squares, normalized below
+                    _stats.mean[i] += nitr.value[i];
+                    _stats.stddev[i] += nitr.value[i] * nitr.value[i];
+                }
+            }
+            // release the memory of the run as soon as possible
+            citr.second = component_data{};
+        }
+    }
+
+    double _nruns = static_cast<double>(_result.nruns);
+    for(auto& citr : _result.data)
+    {
+        for(auto& nitr : citr.second)
+        {
+            auto& _stats = nitr.second;
+            _stats.laps /= static_cast<int64_t>(_result.nruns);
+            for(size_t i = 0; i < _stats.mean.size(); ++i)
+            {
+                double _mean     = _stats.mean[i] / _nruns;
+                double _var      = _stats.stddev[i] / _nruns - _mean * _mean;
+                _stats.mean[i]   = _mean;
+                _stats.stddev[i] = (_result.nruns > 1)
+                                       ? std::sqrt(std::max(_var, 0.0) * _nruns /
+                                                   (_nruns - 1.0))
+                                       : 0.0;
+            }
+        }
+    }
+    return true;
+}
+
+//======================================================================================//
+//
+//      Comparison
+//
+//======================================================================================//
+
+struct comparison
+{
+    string_t type      = "";
+    string_t unit      = "";
+    string_t path      = "";
+    double   base      = 0.0;
+    double   value     = 0.0;
+    double   noise     = 0.0;
+    int64_t  base_laps = 0;
+    int64_t  laps      = 0;
+    bool     regressed = false;
+
+    double delta() const { return value - base; }
+    double ratio() const { return (base != 0.0) ? (value / base) : 0.0; }
+    double relative() const { return (base != 0.0) ? (delta() / std::fabs(base)) : 0.0; }
+};
+
+//--------------------------------------------------------------------------------------//
+
+std::vector<comparison>
+compare(const result_set& _base, const result_set& _other, const config& _config,
+        size_t& _nmissing, size_t& _nadded)
+{
+    std::vector<comparison> _ret;
+    for(const auto& citr : _other.data)
+    {
+        auto _bitr = _base.data.find(citr.first);
+        if(_bitr == _base.data.end())
+        {
+            _nadded += citr.second.size();
+            continue;
+        }
+
+        auto _labels = delimit(citr.first, "+");
+        auto _uitr = _other.units.find(citr.first);
+        auto _unit = (_uitr != _other.units.end()) ? _uitr->second : string_t("");
+
+        for(const auto& nitr : citr.second)
+        {
+            auto _node = _bitr->second.find(nitr.first);
+            if(_node == _bitr->second.end())
+            {
+                ++_nadded;
+                continue;
+            }
+
+            const auto& _b = _node->second;
+            const auto& _o = nitr.second;
+            auto        _n = std::min(_b.mean.size(), _o.mean.size());
+            for(size_t i = 0; i < _n; ++i)
+            {
+                comparison _cmp;
+                _cmp.type = citr.first;
+                if(_n > 1)
+                    _cmp.type = (_labels.size() == _n)
+                                    ? _labels.at(i)
+                                    : (citr.first + "[" + std::to_string(i) + "]");
+                _cmp.unit      = _unit;
+                _cmp.path      = _o.path;
+                _cmp.base      = _b.mean[i];
+                _cmp.value     = _o.mean[i];
+                _cmp.base_laps = _b.laps;
+                _cmp.laps      = _o.laps;
+
+                if(std::max(std::fabs(_cmp.base), std::fabs(_cmp.value)) <
+                   _config.min_value)
+                    continue;
+
+                // noise band relative to the baseline: from the run-to-run variation
+                // when both sets have repeated runs, otherwise from the lap counts
+                if(_base.nruns > 1 && _other.nruns > 1 && _cmp.base != 0.0)
+                {
+                    double _var = _b.stddev[i] * _b.stddev[i] + _o.stddev[i] * _o.stddev[i];
+                    _cmp.noise  = _config.sigma * std::sqrt(_var) / std::fabs(_cmp.base);
+                }
+                else
+                {
+                    auto _laps = std::max<int64_t>(std::min(_b.laps, _o.laps), 1);
+                    _cmp.noise = _config.noise / std::sqrt(static_cast<double>(_laps));
+                }
+
+                bool   _inverted = matches(_config.inverted, _cmp.type);
+                double _limit    = std::max(_config.threshold, _cmp.noise);
+                double _rel   = (_inverted) ? -_cmp.relative() : _cmp.relative();
+                if(_cmp.base == 0.0)
+                    _rel = (_cmp.value == 0.0) ? 0.0 : ((_inverted) ? -1.0 : 1.0);
+
+                _cmp.regressed = (_rel > _limit);
+                if(_cmp.regressed || (_config.all && _rel < -_limit))
+                    _ret.push_back(_cmp);
+            }
+        }
+
+        for(const auto& nitr : _bitr->second)
+            if(citr.second.find(nitr.first) == citr.second.end())
+                ++_nmissing;
+    }
+
+    for(const auto& citr : _base.data)
+        if(_other.data.find(citr.first) == _other.data.end())
+            _nmissing += citr.second.size();
+
+    // rank by the magnitude of the relative change, regressions first
+    std::sort(_ret.begin(), _ret.end(), [](const comparison& lhs, const comparison& rhs) {
+        if(lhs.regressed != rhs.regressed)
+            return lhs.regressed;
+        return std::fabs(lhs.relative()) > std::fabs(rhs.relative());
+    });
+    return _ret;
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+report(const result_set& _base, const result_set& _other,
+       const std::vector<comparison>& _cmp, size_t _nmissing, size_t _nadded,
+       const config& _config)
+{
+    size_t _nregress = std::count_if(_cmp.begin(), _cmp.end(),
+                                     [](const comparison& c) { return c.regressed; });
+
+    std::cout << "\n#" << std::string(86, '-') << "#\n"
+              << "  baseline : " << _base.name << " (" << _base.nruns << " run(s))\n"
+              << "  result   : " << _other.name << " (" << _other.nruns << " run(s))\n"
+              << "  regressions : " << _nregress
+              << ", improvements : " << (_cmp.size() - _nregress)
+              << ", missing nodes : " << _nmissing << ", new nodes : " << _nadded
+              << "\n#" << std::string(86, '-') << "#\n";
+
+    if(_cmp.empty())
+        return;
+
+    size_t _wtype = 9;
+    for(const auto& itr : _cmp)
+        _wtype = std::max(_wtype, itr.type.length());
+
+    std::stringstream ss;
+    ss << std::setw(4) << "#" << "  " << std::setw(12) << std::left << "status"
+       << std::setw(_wtype + 2) << "component" << std::right << std::setw(14) << "baseline"
+       << std::setw(14) << "result" << std::setw(10) << "change" << std::setw(9)
+       << "noise" << std::setw(16) << "laps" << "  " << std::left << "path" << "\n";
+
+    for(size_t i = 0; i < _cmp.size() && i < _config.rows; ++i)
+    {
+        const auto& itr   = _cmp.at(i);
+        auto        _laps = std::to_string(itr.base_laps) + "/" + std::to_string(itr.laps);
+        ss << std::right << std::setw(4) << i << "  " << std::left << std::setw(12)
+           << ((itr.regressed) ? "REGRESSION" : "improved") << std::setw(_wtype + 2)
+           << itr.type << std::right << std::setprecision(4) << std::setw(14)
+           << itr.base << std::setw(14) << itr.value << std::fixed << std::setprecision(1)
+           << std::setw(9) << (100.0 * itr.relative()) << "%" << std::setw(8)
+           << (100.0 * itr.noise) << "%" << std::defaultfloat << std::setw(16) << _laps
+           << "  " << std::left << itr.path;
+        if(!itr.unit.empty())
+            ss << " [" << itr.unit << "]";
+        ss << "\n";
+    }
+    if(_cmp.size() > _config.rows)
+        ss << "  ... " << (_cmp.size() - _config.rows) << " more\n";
+    std::cout << ss.str() << std::flush;
+}
+
+//======================================================================================//
+
+void
+usage(const char* _exe)
+{
+    fprintf(stderr,
+            "usage: %s [options] <baseline> <result> [<result>...]\n\n"
+            "    Each result set is a JSON file, a directory of JSON files, or a\n"
+            "    comma-separated list of these (repeated runs)\n\n"
+            "    -t, --threshold PCT     min. relative change to report (default: 5)\n"
+            "    -s, --sigma N           noise band in std. deviations for repeated runs "
+            "(default: 2)\n"
+            "    -n, --noise FACTOR      relative noise w/o repeated runs: FACTOR / "
+            "sqrt(laps) (default: 0.1)\n"
+            "    -m, --min-value VAL     ignore nodes whose values are below VAL\n"
+            "    -c, --component LIST    only compare these components\n"
+            "    -i, --invert LIST       components where higher values are better\n"
+            "    -r, --rows N            max number of rows in the report (default: 25)\n"
+            "    -a, --all               also report improvements\n"
+            "    -h, --help              print this message\n\n"
+            "    exit codes: 0 (no regressions), 1 (regressions), 2 (error)\n",
+            _exe);
+}
+
+//======================================================================================//
+
+int
+main(int argc, char** argv)
+{
+    config   _config;
+    strvec_t _sets;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        string_t _arg = argv[i];
+        auto     _val = [&]() -> string_t {
+            if(i + 1 >= argc)
+            {
+                fprintf(stderr, "Error! Missing value for '%s'\n", _arg.c_str());
+                usage(argv[0]);
+                exit(2);
+            }
+            return argv[++i];
+        };
+
+        if(_arg == "-h" || _arg == "--help")
+        {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        else if(_arg == "-t" || _arg == "--threshold")
+            _config.threshold = atof(_val().c_str()) / 100.0;
+        else if(_arg == "-s" || _arg == "--sigma")
+            _config.sigma = atof(_val().c_str());
+        else if(_arg == "-n" || _arg == "--noise")
+            _config.noise = atof(_val().c_str());
+        else if(_arg == "-m" || _arg == "--min-value")
+            _config.min_value = atof(_val().c_str());
+        else if(_arg == "-c" || _arg == "--component")
+            _config.components = delimit(_val());
+        else if(_arg == "-i" || _arg == "--invert")
+            _config.inverted = delimit(_val());
+        else if(_arg == "-r" || _arg == "--rows")
+            _config.rows = strtoul(_val().c_str(), nullptr, 10);
+        else if(_arg == "-a" || _arg == "--all")
+            _config.all = true;
+        else if(_arg.find('-') == 0 && _arg.length() > 1)
+        {
+            fprintf(stderr, "Error! Unknown option '%s'\n", _arg.c_str());
+            usage(argv[0]);
+            return 2;
+        }
+        else
+            _sets.push_back(_arg);
+    }
+
+    if(_sets.size() < 2)
+    {
+        fprintf(stderr, "Error! At least two result sets are required\n");
+        usage(argv[0]);
+        return 2;
+    }
+
+    result_set _baseline;
+    if(!load_result_set(_sets.front(), _config, _baseline))
+        return 2;
+
+    size_t _nregress = 0;
+    for(size_t i = 1; i < _sets.size(); ++i)
+    {
+        result_set _result;
+        if(!load_result_set(_sets.at(i), _config, _result))
+            return 2;
+
+        size_t _nmissing = 0;
+        size_t _nadded   = 0;
+        auto   _cmp      = compare(_baseline, _result, _config, _nmissing, _nadded);
+        report(_baseline, _result, _cmp, _nmissing, _nadded, _config);
+        _nregress += std::count_if(_cmp.begin(), _cmp.end(),
+                                   [](const comparison& c) { return c.regressed; });
+    }
+
+    return (_nregress > 0) ? 1 : EXIT_SUCCESS;
+}
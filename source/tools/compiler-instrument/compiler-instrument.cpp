@@ -0,0 +1,785 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file compiler-instrument.cpp
+ * Implementation of the __cyg_profile_func_enter/exit hooks emitted by compiling with
+ * -finstrument-functions. Link the resulting timemory-compiler-instrument library
+ * into a code compiled with that flag to profile every function.
+ *
+ * The hot path does no string work: each thread owns an open-addressing table keyed
+ * on (function address, parent node) which maps to a node of a flat, per-thread
+ * call-graph. When the process finalizes, the graphs of the threads are merged, the
+ * names are resolved with dladdr + demangle, the filters are applied and the result
+ * is folded into the wall_clock storage, i.e. it is reported (text, JSON, etc.) like
+ * any other timemory measurement.
+ *
+ * Environment:
+ *      TIMEMORY_COMPILER_ENABLED        (bool)      enable/disable recording
+ *      TIMEMORY_COMPILER_INCLUDE        (regex)     only report matching functions
+ *      TIMEMORY_COMPILER_EXCLUDE        (regex)     never report matching functions
+ *      TIMEMORY_COMPILER_MIN_DURATION   (usec)      do not report functions whose
+ *                                                   mean duration is below this cutoff
+ *      TIMEMORY_COMPILER_THROTTLE_COUNT (count)     stop timing a function once its
+ *                                                   mean duration over this many calls
+ *                                                   (default: 1000) is below the
+ *                                                   MIN_DURATION cutoff
+ *
+ * Functions which are not reported are not dropped: their time is part of the nearest
+ * reported ancestor and their reported descendants are attached to it.
+ */
+
+#if !defined(_GNU_SOURCE)
+#    define _GNU_SOURCE
+#endif
+
+#include "timemory/timemory.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dlfcn.h>
+
+#define TIMEMORY_NO_INSTRUMENT __attribute__((no_instrument_function))
+
+using namespace tim::component;
+
+//======================================================================================//
+
+namespace
+{
+using bundle_t = tim::component_tuple<wall_clock>;
+
+//--------------------------------------------------------------------------------------//
+//  process-wide configuration, read once by initialize(). Intentionally leaked so that
+//  hooks invoked during static destruction never touch a destroyed object
+//
+struct config_t
+{
+    double                      min_duration   = 0.0;  // nanoseconds
+    uint64_t                    throttle_count = 1000;
+    std::unique_ptr<std::regex> include;
+    std::unique_ptr<std::regex> exclude;
+};
+
+TIMEMORY_NO_INSTRUMENT config_t&
+get_config()
+{
+    static auto _instance = new config_t;
+    return *_instance;
+}
+
+//--------------------------------------------------------------------------------------//
+//  false before initialize() when recording is disabled and after stop()
+//
+std::atomic<bool> f_active(true);
+
+//--------------------------------------------------------------------------------------//
+//  false from initialize() (when recording is enabled) until the output is written
+//
+std::atomic<bool> f_finalized(true);
+
+TIMEMORY_NO_INSTRUMENT void
+finalize();
+
+//--------------------------------------------------------------------------------------//
+//  a function called by a thread. Only updated when a MIN_DURATION cutoff is set
+//
+struct function_t
+{
+    void*    addr;
+    uint64_t count;
+    int64_t  total;  // nanoseconds
+    bool     throttled;
+};
+
+//--------------------------------------------------------------------------------------//
+//  a node in the per-thread call-graph
+//
+struct node_t
+{
+    void*    addr;
+    int32_t  parent;
+    int32_t  func;
+    uint64_t count;
+    int64_t  total;  // nanoseconds
+};
+
+//--------------------------------------------------------------------------------------//
+//  an entry on the per-thread call-stack. The start is negative when the function is
+//  throttled, i.e. not timed
+//
+struct frame_t
+{
+    int32_t node;
+    int64_t start;
+};
+
+//--------------------------------------------------------------------------------------//
+//  open-addressing table keyed on a function address and the index of its parent
+//  node, which maps to an index in the node (or function) array of the thread. It
+//  only grows and the load factor is kept at or below 1/2
+//
+class lookup_table
+{
+public:
+    TIMEMORY_NO_INSTRUMENT lookup_table()
+    : m_slots(initial_size)
+    , m_mask(initial_size - 1)
+    {}
+
+    TIMEMORY_NO_INSTRUMENT int32_t find(void* _addr, int32_t _parent) const
+    {
+        auto _idx = hash(_addr, _parent) & m_mask;
+        while(m_slots[_idx].index >= 0)
+        {
+            if(m_slots[_idx].addr == _addr && m_slots[_idx].parent == _parent)
+                return m_slots[_idx].index;
+            _idx = (_idx + 1) & m_mask;
+        }
+        return -1;
+    }
+
+    TIMEMORY_NO_INSTRUMENT void insert(void* _addr, int32_t _parent, int32_t _index)
+    {
+        if(2 * (m_size + 1) > m_slots.size())
+            rehash();
+        place(m_slots, m_mask, slot_t(_addr, _parent, _index));
+        ++m_size;
+    }
+
+private:
+    static constexpr size_t initial_size = 1024;
+
+    struct slot_t
+    {
+        TIMEMORY_NO_INSTRUMENT slot_t(void* _addr = nullptr, int32_t _parent = -1,
+                                      int32_t _index = -1)
+        : addr(_addr)
+        , parent(_parent)
+        , index(_index)
+        {}
+
+        void*   addr;
+        int32_t parent;
+        int32_t index;
+    };
+
+    static TIMEMORY_NO_INSTRUMENT size_t hash(void* _addr, int32_t _parent)
+    {
+        auto _val = reinterpret_cast<uintptr_t>(_addr) >> 2;
+        _val ^= static_cast<uintptr_t>(_parent + 2) * 0x9e3779b97f4a7c15ULL;
+        _val ^= (_val >> 29);
+        return static_cast<size_t>(_val);
+    }
+
+    static TIMEMORY_NO_INSTRUMENT void place(std::vector<slot_t>& _slots, size_t _mask,
+                                             const slot_t& _slot)
+    {
+        auto _idx = hash(_slot.addr, _slot.parent) & _mask;
+        while(_slots[_idx].index >= 0)
+            _idx = (_idx + 1) & _mask;
+        _slots[_idx] = _slot;
+    }
+
+    TIMEMORY_NO_INSTRUMENT void rehash()
+    {
+        std::vector<slot_t> _slots(2 * m_slots.size());
+        m_mask = _slots.size() - 1;
+        for(const auto& itr : m_slots)
+        {
+            if(itr.index >= 0)
+                place(_slots, m_mask, itr);
+        }
+        std::swap(m_slots, _slots);
+    }
+
+private:
+    std::vector<slot_t> m_slots;
+    size_t              m_mask;
+    size_t              m_size = 0;
+};
+
+//--------------------------------------------------------------------------------------//
+//  per-thread recorder: the functions seen by the thread, its call-graph and its
+//  call-stack
+//
+class thread_data
+{
+public:
+    TIMEMORY_NO_INSTRUMENT thread_data()
+    {
+        m_nodes.reserve(512);
+        m_stack.reserve(256);
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  announce a hook in flight. Pairs with the exchange of f_active in stop():
+    //  with both sequentially consistent, either stop() sees the hook in flight
+    //  and waits for it or the hook sees that recording has stopped
+    //
+    TIMEMORY_NO_INSTRUMENT bool acquire()
+    {
+        m_busy.store(true);
+        if(f_active.load())
+            return true;
+        m_busy.store(false, std::memory_order_release);
+        return false;
+    }
+
+    TIMEMORY_NO_INSTRUMENT void release()
+    {
+        m_busy.store(false, std::memory_order_release);
+    }
+
+    TIMEMORY_NO_INSTRUMENT bool busy() const { return m_busy.load(); }
+
+    TIMEMORY_NO_INSTRUMENT void enter(void* _addr)
+    {
+        int32_t _parent = (m_stack.empty()) ? -1 : m_stack.back().node;
+        int32_t _node   = m_node_table.find(_addr, _parent);
+        if(_node < 0)
+            _node = add_node(_addr, _parent);
+
+        auto _throttled = m_functions[m_nodes[_node].func].throttled;
+        m_stack.push_back({ _node, (_throttled) ? int64_t(-1) : now() });
+
+        // registered after the first call so that it runs before the storage
+        // singletons created after that point are destroyed
+        static bool _registered = (std::atexit(&finalize) == 0);
+        tim::consume_parameters(_registered);
+    }
+
+    TIMEMORY_NO_INSTRUMENT void exit(void* _addr)
+    {
+        auto _end = now();
+        // unwind frames skipped by exceptions or longjmp until the matching one
+        auto _n = m_stack.size();
+        while(_n > 0 && m_nodes[m_stack[_n - 1].node].addr != _addr)
+            --_n;
+        if(_n == 0)
+            return;
+        while(m_stack.size() >= _n)
+            pop(_end);
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  end the functions which are still on the call-stack
+    //
+    TIMEMORY_NO_INSTRUMENT void stop_all()
+    {
+        auto _end = now();
+        while(!m_stack.empty())
+            pop(_end);
+    }
+
+    const std::vector<node_t>&     nodes() const { return m_nodes; }
+    const std::vector<function_t>& functions() const { return m_functions; }
+
+private:
+    static TIMEMORY_NO_INSTRUMENT int64_t now()
+    {
+        return tim::get_clock_real_now<int64_t, std::nano>();
+    }
+
+    TIMEMORY_NO_INSTRUMENT int32_t add_node(void* _addr, int32_t _parent)
+    {
+        int32_t _func = m_function_table.find(_addr, -1);
+        if(_func < 0)
+        {
+            _func = static_cast<int32_t>(m_functions.size());
+            m_functions.push_back(function_t{ _addr, 0, 0, false });
+            m_function_table.insert(_addr, -1, _func);
+        }
+
+        auto _node = static_cast<int32_t>(m_nodes.size());
+        m_nodes.push_back(node_t{ _addr, _parent, _func, 0, 0 });
+        m_node_table.insert(_addr, _parent, _node);
+        return _node;
+    }
+
+    TIMEMORY_NO_INSTRUMENT void pop(int64_t _end)
+    {
+        auto _frame = m_stack.back();
+        m_stack.pop_back();
+        if(_frame.start < 0)
+            return;
+
+        auto& _node    = m_nodes[_frame.node];
+        auto  _elapsed = _end - _frame.start;
+        _node.count += 1;
+        _node.total += _elapsed;
+
+        // stop timing functions whose mean duration is below the cutoff. The calls
+        // which were already timed are removed when the process finalizes
+        auto& _config = get_config();
+        if(_config.min_duration > 0.0)
+        {
+            auto& _func = m_functions[_node.func];
+            _func.count += 1;
+            _func.total += _elapsed;
+            if(_func.count >= _config.throttle_count &&
+               static_cast<double>(_func.total) / _func.count < _config.min_duration)
+                _func.throttled = true;
+        }
+    }
+
+private:
+    std::atomic<bool>       m_busy{ false };
+    lookup_table            m_function_table;
+    lookup_table            m_node_table;
+    std::vector<function_t> m_functions;
+    std::vector<node_t>     m_nodes;
+    std::vector<frame_t>    m_stack;
+};
+
+//--------------------------------------------------------------------------------------//
+//  process-wide registry of the per-thread data. Intentionally leaked so that hooks
+//  invoked during static destruction never touch a destroyed object
+//
+using thread_data_ptr = std::shared_ptr<thread_data>;
+
+struct global_data
+{
+    std::mutex                   mutex;
+    std::vector<thread_data_ptr> threads;
+};
+
+TIMEMORY_NO_INSTRUMENT global_data*
+get_global_data()
+{
+    static auto _instance = new global_data;
+    return _instance;
+}
+
+TIMEMORY_NO_INSTRUMENT thread_data*
+get_thread_data()
+{
+    static thread_local thread_data* _instance = nullptr;
+    if(!_instance)
+    {
+        auto  _data = std::make_shared<thread_data>();
+        auto* _glob = get_global_data();
+        std::lock_guard<std::mutex> _lk(_glob->mutex);
+        _glob->threads.push_back(_data);
+        _instance = _data.get();
+    }
+    return _instance;
+}
+
+//--------------------------------------------------------------------------------------//
+//  recursion guard: anything called from the hooks must not record itself
+//
+thread_local bool f_in_hook = false;
+
+struct hook_guard
+{
+    TIMEMORY_NO_INSTRUMENT hook_guard()
+    : m_owner(!f_in_hook)
+    {
+        f_in_hook = true;
+    }
+
+    TIMEMORY_NO_INSTRUMENT ~hook_guard()
+    {
+        if(m_owner)
+            f_in_hook = false;
+    }
+
+    explicit operator bool() const { return m_owner; }
+
+private:
+    bool m_owner;
+};
+
+//======================================================================================//
+//
+//      finalization (not on the hot path)
+//
+//======================================================================================//
+
+struct entry_t
+{
+    void*                addr   = nullptr;
+    int64_t              parent = -1;
+    uint64_t             count  = 0;
+    int64_t              total  = 0;
+    std::vector<int64_t> children;
+};
+
+struct summary_t
+{
+    uint64_t    count     = 0;
+    int64_t     total     = 0;
+    bool        throttled = false;
+    bool        reported  = true;
+    std::string name;
+};
+
+using graph_t     = std::vector<entry_t>;
+using key_t       = std::pair<int64_t, void*>;
+using key_map_t   = std::map<key_t, int64_t>;
+using summaries_t = std::map<void*, summary_t>;
+
+//--------------------------------------------------------------------------------------//
+//  merge or append a node keyed on (parent, address)
+//
+TIMEMORY_NO_INSTRUMENT int64_t
+merge_node(graph_t& _graph, key_map_t& _keys, int64_t _parent, void* _addr,
+           uint64_t _count, int64_t _total)
+{
+    auto _key = key_t(_parent, _addr);
+    auto itr  = _keys.find(_key);
+    if(itr == _keys.end())
+    {
+        entry_t _entry;
+        _entry.addr   = _addr;
+        _entry.parent = _parent;
+        _graph.push_back(_entry);
+        auto _index = static_cast<int64_t>(_graph.size() - 1);
+        if(_parent >= 0)
+            _graph[_parent].children.push_back(_index);
+        itr = _keys.insert({ _key, _index }).first;
+    }
+    auto& _entry = _graph[itr->second];
+    _entry.count += _count;
+    _entry.total += _total;
+    return itr->second;
+}
+
+//--------------------------------------------------------------------------------------//
+//  resolve a function address to a (demangled) name
+//
+TIMEMORY_NO_INSTRUMENT std::string
+resolve(void* _addr)
+{
+    Dl_info _info;
+    if(dladdr(_addr, &_info) != 0)
+    {
+        if(_info.dli_sname)
+            return tim::demangle(_info.dli_sname);
+        if(_info.dli_fname)
+        {
+            std::stringstream ss;
+            std::string       _fname = _info.dli_fname;
+            ss << _fname.substr(_fname.find_last_of('/') + 1) << "+0x" << std::hex
+               << (reinterpret_cast<uintptr_t>(_addr) -
+                   reinterpret_cast<uintptr_t>(_info.dli_fbase));
+            return ss.str();
+        }
+    }
+    std::stringstream ss;
+    ss << _addr;
+    return ss.str();
+}
+
+//--------------------------------------------------------------------------------------//
+//  merge the graphs of the threads by call-path and sum the calls of each function.
+//  Parents always precede their children in the per-thread graphs so a single
+//  forward pass is sufficient
+//
+TIMEMORY_NO_INSTRUMENT graph_t
+merge_threads(const std::vector<thread_data_ptr>& _threads, summaries_t& _summaries)
+{
+    graph_t   _graph;
+    key_map_t _keys;
+    for(const auto& titr : _threads)
+    {
+        const auto&          _nodes = titr->nodes();
+        std::vector<int64_t> _local(_nodes.size(), -1);
+        for(size_t i = 0; i < _nodes.size(); ++i)
+        {
+            const auto& _node   = _nodes[i];
+            int64_t     _parent = (_node.parent < 0) ? -1 : _local[_node.parent];
+            _local[i] =
+                merge_node(_graph, _keys, _parent, _node.addr, _node.count, _node.total);
+
+            auto& _summary = _summaries[_node.addr];
+            _summary.count += _node.count;
+            _summary.total += _node.total;
+        }
+        for(const auto& itr : titr->functions())
+        {
+            if(itr.throttled)
+                _summaries[itr.addr].throttled = true;
+        }
+    }
+    return _graph;
+}
+
+//--------------------------------------------------------------------------------------//
+//  remove the functions which are not reported: their reported descendants are
+//  attached to the nearest reported ancestor and merged with its other children
+//
+TIMEMORY_NO_INSTRUMENT graph_t
+collapse(const graph_t& _graph, const summaries_t& _summaries)
+{
+    graph_t              _collapsed;
+    key_map_t            _keys;
+    std::vector<int64_t> _remap(_graph.size(), -1);
+    for(size_t i = 0; i < _graph.size(); ++i)
+    {
+        const auto& _entry  = _graph[i];
+        int64_t     _parent = (_entry.parent < 0) ? -1 : _remap[_entry.parent];
+        if(_summaries.at(_entry.addr).reported)
+            _remap[i] = merge_node(_collapsed, _keys, _parent, _entry.addr,
+                                   _entry.count, _entry.total);
+        else
+            _remap[i] = _parent;
+    }
+    return _collapsed;
+}
+
+//--------------------------------------------------------------------------------------//
+//  write the graph in the format of storage::pack(): the records are in pre-order and
+//  the level of a record is its depth in the graph, starting at 1
+//
+TIMEMORY_NO_INSTRUMENT std::string
+pack(const graph_t& _graph, const summaries_t& _summaries)
+{
+    using value_type = typename wall_clock::value_type;
+
+    auto _write = [](std::string& _dst, const void* _src, size_t _len) {
+        _dst.append(static_cast<const char*>(_src), _len);
+    };
+
+    std::string _records;
+    uint64_t    _nrecords = 0;
+    auto        _record   = [&](int64_t _index, int64_t _level) {
+        const auto& _entry = _graph[_index];
+        const auto& _name  = _summaries.at(_entry.addr).name;
+        value_type  _value = _entry.total;
+
+        tim::details::packed_record _rec;
+        memset(&_rec, 0, sizeof(_rec));
+        _rec.id          = tim::add_hash_id(_name) * _level;
+        _rec.depth       = _level;
+        _rec.level       = _level;
+        _rec.laps        = static_cast<int64_t>(_entry.count);
+        _rec.prefix_size = static_cast<uint32_t>(_name.length());
+        _write(_records, &_rec, sizeof(_rec));
+        _write(_records, &_value, sizeof(value_type));
+        _write(_records, &_value, sizeof(value_type));
+        _write(_records, _name.c_str(), _name.length());
+        ++_nrecords;
+    };
+
+    std::vector<std::pair<int64_t, int64_t>> _stack;
+    for(size_t i = _graph.size(); i > 0; --i)
+    {
+        if(_graph[i - 1].parent < 0)
+            _stack.push_back({ static_cast<int64_t>(i - 1), 1 });
+    }
+    while(!_stack.empty())
+    {
+        auto _top = _stack.back();
+        _stack.pop_back();
+        _record(_top.first, _top.second);
+        const auto& _children = _graph[_top.first].children;
+        for(auto itr = _children.rbegin(); itr != _children.rend(); ++itr)
+            _stack.push_back({ *itr, _top.second + 1 });
+    }
+
+    std::string _buffer;
+    if(_nrecords == 0)
+        return _buffer;
+
+    auto                         _label = wall_clock::label();
+    tim::details::packed_section _section;
+    memset(&_section, 0, sizeof(_section));
+    _section.label_size = static_cast<uint32_t>(_label.length());
+    _section.value_size = static_cast<uint32_t>(sizeof(value_type));
+    _section.nrecords   = _nrecords;
+    _section.nbytes     = _records.size();
+    _write(_buffer, &_section, sizeof(_section));
+    _write(_buffer, _label.c_str(), _label.length());
+    _buffer.append(_records);
+    return _buffer;
+}
+
+//--------------------------------------------------------------------------------------//
+//  stop recording, wait for the hooks in flight and fold the call-graphs into the
+//  storage of the calling thread. Safe to call more than once and from any thread
+//
+TIMEMORY_NO_INSTRUMENT void
+stop()
+{
+    if(!f_active.exchange(false))
+        return;
+
+    f_in_hook = true;
+
+    // registers the data of this thread if it did not call any function yet
+    auto*       _data = get_thread_data();
+    auto*       _glob = get_global_data();
+    std::string _buffer;
+    {
+        std::lock_guard<std::mutex> _lk(_glob->mutex);
+        // wait for the hooks which were in flight when recording stopped
+        for(const auto& itr : _glob->threads)
+        {
+            while(itr->busy())
+                std::this_thread::yield();
+        }
+
+        // end the functions still on the call-stack of this thread (e.g. when exit()
+        // is called from a nested function). The functions which other threads are
+        // still executing have not returned and are not reported
+        _data->stop_all();
+
+        summaries_t _summaries;
+        auto        _graph  = merge_threads(_glob->threads, _summaries);
+        auto&       _config = get_config();
+        for(auto& itr : _summaries)
+        {
+            auto& _summary = itr.second;
+            _summary.name  = resolve(itr.first);
+            if(_config.include && !std::regex_search(_summary.name, *_config.include))
+                _summary.reported = false;
+            if(_config.exclude && std::regex_search(_summary.name, *_config.exclude))
+                _summary.reported = false;
+            if(_summary.throttled ||
+               (_config.min_duration > 0.0 && _summary.count > 0 &&
+                static_cast<double>(_summary.total) / _summary.count <
+                    _config.min_duration))
+                _summary.reported = false;
+        }
+        _buffer = pack(collapse(_graph, _summaries), _summaries);
+    }
+
+    tim::manager::get_storage<bundle_t>::unpack(_buffer);
+}
+
+//--------------------------------------------------------------------------------------//
+//  stop recording and write the output
+//
+TIMEMORY_NO_INSTRUMENT void
+finalize()
+{
+    stop();
+    if(!f_finalized.exchange(true))
+        tim::timemory_finalize();
+}
+
+//--------------------------------------------------------------------------------------//
+
+TIMEMORY_NO_INSTRUMENT __attribute__((constructor)) void
+initialize()
+{
+    f_in_hook = true;
+    if(!tim::get_env<bool>("TIMEMORY_COMPILER_ENABLED", true))
+    {
+        f_active.store(false);
+        f_in_hook = false;
+        return;
+    }
+
+    auto& _config  = get_config();
+    auto  _include = tim::get_env<std::string>("TIMEMORY_COMPILER_INCLUDE", "");
+    auto  _exclude = tim::get_env<std::string>("TIMEMORY_COMPILER_EXCLUDE", "");
+
+    _config.min_duration =
+        1.0e3 * tim::get_env<double>("TIMEMORY_COMPILER_MIN_DURATION", 0.0);
+    _config.throttle_count =
+        tim::get_env<uint64_t>("TIMEMORY_COMPILER_THROTTLE_COUNT", 1000);
+
+    try
+    {
+        if(!_include.empty())
+            _config.include.reset(
+                new std::regex(_include, std::regex_constants::optimize));
+        if(!_exclude.empty())
+            _config.exclude.reset(
+                new std::regex(_exclude, std::regex_constants::optimize));
+    } catch(std::regex_error& e)
+    {
+        fprintf(stderr, "[timemory-compiler-instrument]> invalid regex: %s\n",
+                e.what());
+    }
+
+    tim::timemory_init(program_invocation_short_name);
+    f_finalized.store(false);
+    f_in_hook = false;
+}
+
+TIMEMORY_NO_INSTRUMENT __attribute__((destructor)) void
+destroy()
+{
+    finalize();
+}
+
+}  // namespace
+
+//======================================================================================//
+
+extern "C"
+{
+    TIMEMORY_NO_INSTRUMENT void __cyg_profile_func_enter(void* _func, void*)
+    {
+        if(!f_active.load(std::memory_order_relaxed))
+            return;
+        hook_guard _guard;
+        if(!_guard)
+            return;
+        auto* _data = get_thread_data();
+        if(_data->acquire())
+        {
+            _data->enter(_func);
+            _data->release();
+        }
+    }
+
+    TIMEMORY_NO_INSTRUMENT void __cyg_profile_func_exit(void* _func, void*)
+    {
+        if(!f_active.load(std::memory_order_relaxed))
+            return;
+        hook_guard _guard;
+        if(!_guard)
+            return;
+        auto* _data = get_thread_data();
+        if(_data->acquire())
+        {
+            _data->exit(_func);
+            _data->release();
+        }
+    }
+
+    /// stop recording and fold the call-graph into the wall_clock storage. The report
+    /// is written at process exit (or by timemory_compiler_instrument_finalize)
+    TIMEMORY_NO_INSTRUMENT void timemory_compiler_instrument_stop() { stop(); }
+
+    /// stop recording and write the report now instead of at process exit
+    TIMEMORY_NO_INSTRUMENT void timemory_compiler_instrument_finalize() { finalize(); }
+}
@@ -33,6 +33,7 @@ cat <<EOF>> ${OUT}
 
 #include <timemory/library.h>
 #include <timemory/timemory.hpp>
+#include <timemory/components/derived/mpi_comm_matrix.hpp>
 
 #include <memory>
 #include <set>
@@ -40,7 +41,8 @@ cat <<EOF>> ${OUT}
 
 using namespace tim::component;
 using stringset_t   = std::set<std::string>;
-using mpi_toolset_t = tim::auto_timer;
+using mpi_tuple_t   = tim::component_tuple<tim::auto_timer_tuple_t, mpi_comm_matrix>;
+using mpi_toolset_t = tim::auto_hybrid<mpi_tuple_t, tim::auto_timer_list_t>;
 using mpip_gotcha_t = tim::component::gotcha<${GOTCHA_SIZE}, mpi_toolset_t>;
 using mpip_tuple_t  = tim::component_tuple<tim::auto_timer_tuple_t, mpip_gotcha_t>;
 using mpip_list_t   = tim::auto_timer_list_t;
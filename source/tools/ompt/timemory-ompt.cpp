@@ -0,0 +1,1003 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory-ompt.cpp
+ * OpenMP tool (OMPT) which instruments an OpenMP code without source changes.
+ * Link the timemory-ompt library into the application or list it in
+ * OMP_TOOL_LIBRARIES. It requires an OMPT-capable runtime (LLVM libomp or Intel
+ * libiomp5). Code compiled with GCC can use libomp through its GOMP compatibility
+ * layer, e.g. by linking -lomp instead of -lgomp. libgomp does not implement OMPT.
+ *
+ * Regions are created for parallel regions, work-sharing constructs (loop, sections,
+ * single, ...), barriers and other synchronization regions (with the time spent
+ * waiting) and explicit tasks. A construct is identified by its codeptr_ra, the
+ * construct kind and its parent. Each thread owns an open-addressing table which
+ * maps this pre-hashed key to a node in a process-wide graph, and accumulates its
+ * statistics in per-thread storage, so the global graph is only locked the first
+ * time a thread encounters a construct.
+ *
+ * The implicit task of every thread in a team is recorded on the node of the
+ * parallel region created by the encountering thread, and explicit tasks are
+ * recorded under the node which created them, independent of the thread which
+ * executes them. When the tool is finalized, the per-thread statistics of each node
+ * are combined into an ompt_construct component and the graph is inserted into its
+ * timemory storage, so the report follows the usual output settings (text, json,
+ * cout). The load imbalance is (max / mean - 1) of the per-thread time.
+ *
+ * Environment:
+ *      TIMEMORY_OMPT_ENABLED   (bool)      enable/disable the tool
+ *      TIMEMORY_OMPT_TASKS     (bool)      record explicit tasks
+ *
+ * Time spent executing tasks inside a barrier is not counted as barrier wait time.
+ */
+
+#if !defined(_GNU_SOURCE)
+#    define _GNU_SOURCE
+#endif
+
+#include "timemory/timemory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dlfcn.h>
+#include <omp-tools.h>
+
+//======================================================================================//
+
+namespace tim
+{
+namespace component
+{
+struct ompt_construct;
+}
+
+namespace trait
+{
+template <>
+struct is_timing_category<component::ompt_construct> : std::true_type
+{};
+
+template <>
+struct uses_timing_units<component::ompt_construct> : std::true_type
+{};
+
+template <>
+struct custom_unit_printing<component::ompt_construct> : std::true_type
+{};
+
+template <>
+struct custom_label_printing<component::ompt_construct> : std::true_type
+{};
+
+}  // namespace trait
+
+namespace component
+{
+//--------------------------------------------------------------------------------------//
+/// \class ompt_construct
+/// \brief the statistics of an OpenMP construct combined over the threads which
+/// executed it: { total, min, max, wait, max wait } of the per-thread time (nsec) and
+/// the number of threads. The laps are the number of times the construct completed
+//
+struct ompt_construct : base<ompt_construct, std::array<int64_t, 6>>
+{
+    using ratio_t     = std::nano;
+    using value_type  = std::array<int64_t, 6>;
+    using this_type   = ompt_construct;
+    using base_type   = base<this_type, value_type>;
+    using result_type = std::tuple<double, double, double, double, double>;
+
+    enum : size_t
+    {
+        total_idx = 0,
+        min_idx,
+        max_idx,
+        wait_idx,
+        max_wait_idx,
+        threads_idx
+    };
+
+    static std::string label() { return "ompt"; }
+    static std::string description()
+    {
+        return "OpenMP construct time, load imbalance and barrier wait time";
+    }
+    static value_type record() { return value_type{}; }
+
+    using base_type::accum;
+    using base_type::is_transient;
+    using base_type::laps;
+    using base_type::value;
+
+    /// add the statistics of one thread which executed the construct
+    void add_thread(int64_t _time, int64_t _wait, int64_t _count)
+    {
+        value_type _val{};
+        _val[total_idx]    = _time;
+        _val[min_idx]      = _time;
+        _val[max_idx]      = _time;
+        _val[wait_idx]     = _wait;
+        _val[max_wait_idx] = _wait;
+        _val[threads_idx]  = 1;
+        combine(value, _val);
+        combine(accum, _val);
+        laps += _count;
+    }
+
+    this_type& operator+=(const this_type& rhs)
+    {
+        combine(value, rhs.value);
+        combine(accum, rhs.accum);
+        return *this;
+    }
+
+    /// total, mean, max (sec), load imbalance (%) and wait (sec)
+    result_type get() const
+    {
+        auto& val   = (is_transient) ? accum : value;
+        auto  _conv = [](int64_t _val) {
+            return static_cast<double>(_val) / static_cast<double>(ratio_t::den) *
+                   base_type::get_unit();
+        };
+        auto _total = _conv(val[total_idx]);
+        auto _mean  = _total / std::max<int64_t>(val[threads_idx], 1);
+        auto _max   = _conv(val[max_idx]);
+        auto _imbal = (_mean > 0.0) ? (100.0 * (_max / _mean - 1.0)) : 0.0;
+        return result_type(_total, _mean, _max, _imbal, _conv(val[wait_idx]));
+    }
+
+    std::string get_display() const
+    {
+        std::stringstream ss;
+        auto              _prec  = base_type::get_precision();
+        auto              _width = base_type::get_width();
+        auto              _flags = base_type::get_format_flags();
+        auto              _disp  = base_type::get_display_unit();
+        auto              _val   = get();
+
+        auto _print = [&](double _v, const std::string& _unit, const char* _tag) {
+            std::stringstream ssv;
+            ssv.setf(_flags);
+            ssv << std::setw(_width) << std::setprecision(_prec) << _v << " " << _unit
+                << " " << _tag;
+            return ssv.str();
+        };
+
+        ss << _print(std::get<0>(_val), _disp, "total") << ", "
+           << _print(std::get<1>(_val), _disp, "mean") << ", "
+           << _print(std::get<2>(_val), _disp, "max") << ", "
+           << _print(std::get<3>(_val), "%", "imbalance") << ", "
+           << _print(std::get<4>(_val), _disp, "wait");
+        return ss.str();
+    }
+
+    //----------------------------------------------------------------------------------//
+    // serialization
+    //
+    template <typename Archive>
+    void serialize(Archive& ar, const unsigned int)
+    {
+        auto& val   = (is_transient) ? accum : value;
+        auto  _data = get();
+        ar(serializer::make_nvp("is_transient", is_transient),
+           serializer::make_nvp("laps", laps), serializer::make_nvp("repr_data", _data),
+           serializer::make_nvp("value", value), serializer::make_nvp("accum", accum),
+           serializer::make_nvp("nthreads", val[threads_idx]),
+           serializer::make_nvp("imbalance", std::get<3>(_data)),
+           serializer::make_nvp("wait", std::get<4>(_data)));
+    }
+
+private:
+    /// totals are summed and extrema are kept, an empty rhs is ignored
+    static void combine(value_type& lhs, const value_type& rhs)
+    {
+        if(rhs[threads_idx] == 0)
+            return;
+        lhs[min_idx] = (lhs[threads_idx] == 0) ? rhs[min_idx]
+                                               : std::min(lhs[min_idx], rhs[min_idx]);
+        lhs[max_idx]      = std::max(lhs[max_idx], rhs[max_idx]);
+        lhs[max_wait_idx] = std::max(lhs[max_wait_idx], rhs[max_wait_idx]);
+        lhs[total_idx] += rhs[total_idx];
+        lhs[wait_idx] += rhs[wait_idx];
+        lhs[threads_idx] += rhs[threads_idx];
+    }
+};
+
+}  // namespace component
+}  // namespace tim
+
+//======================================================================================//
+
+namespace
+{
+//--------------------------------------------------------------------------------------//
+//  construct kinds, the sync kinds are grouped at the end
+//
+enum construct_t : int32_t
+{
+    CONSTRUCT_PARALLEL = 0,
+    CONSTRUCT_LOOP,
+    CONSTRUCT_SECTIONS,
+    CONSTRUCT_SINGLE,
+    CONSTRUCT_WORKSHARE,
+    CONSTRUCT_DISTRIBUTE,
+    CONSTRUCT_TASKLOOP,
+    CONSTRUCT_SCOPE,
+    CONSTRUCT_TASK,
+    CONSTRUCT_BARRIER,
+    CONSTRUCT_IMPLICIT_BARRIER,
+    CONSTRUCT_EXPLICIT_BARRIER,
+    CONSTRUCT_IMPLEMENTATION_BARRIER,
+    CONSTRUCT_TASKWAIT,
+    CONSTRUCT_TASKGROUP,
+    CONSTRUCT_REDUCTION,
+    CONSTRUCT_SYNC,
+    CONSTRUCT_SIZE
+};
+
+const char* construct_labels[CONSTRUCT_SIZE] = { "parallel",
+                                                "loop",
+                                                "sections",
+                                                "single",
+                                                "workshare",
+                                                "distribute",
+                                                "taskloop",
+                                                "scope",
+                                                "task",
+                                                "barrier",
+                                                "implicit barrier",
+                                                "explicit barrier",
+                                                "barrier",
+                                                "taskwait",
+                                                "taskgroup",
+                                                "reduction",
+                                                "sync" };
+
+inline bool
+is_sync(int32_t _kind)
+{
+    return _kind >= CONSTRUCT_BARRIER;
+}
+
+//--------------------------------------------------------------------------------------//
+//  the enumerators of the header are not used in the switch statements because older
+//  omp-tools.h headers do not define the OpenMP 5.1 values
+//
+inline int32_t
+get_work_kind(ompt_work_t _wstype)
+{
+    switch(static_cast<int>(_wstype))
+    {
+        case 1: return CONSTRUCT_LOOP;
+        case 2: return CONSTRUCT_SECTIONS;
+        case 3:
+        case 4: return CONSTRUCT_SINGLE;
+        case 5: return CONSTRUCT_WORKSHARE;
+        case 6: return CONSTRUCT_DISTRIBUTE;
+        case 7: return CONSTRUCT_TASKLOOP;
+        case 8: return CONSTRUCT_SCOPE;
+        default: return CONSTRUCT_LOOP;
+    }
+}
+
+inline int32_t
+get_sync_kind(ompt_sync_region_t _kind)
+{
+    switch(static_cast<int>(_kind))
+    {
+        case 1: return CONSTRUCT_BARRIER;
+        case 2:
+        case 8:
+        case 9: return CONSTRUCT_IMPLICIT_BARRIER;
+        case 3: return CONSTRUCT_EXPLICIT_BARRIER;
+        case 4: return CONSTRUCT_IMPLEMENTATION_BARRIER;
+        case 5: return CONSTRUCT_TASKWAIT;
+        case 6: return CONSTRUCT_TASKGROUP;
+        case 7: return CONSTRUCT_REDUCTION;
+        default: return CONSTRUCT_SYNC;
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+//  a node in the process-wide graph. Nodes are never moved so the ompt_data_t of
+//  parallel regions and tasks can point to them
+//
+struct node_t
+{
+    const void* codeptr = nullptr;
+    int32_t     kind    = CONSTRUCT_SYNC;
+    int32_t     index   = -1;
+    int32_t     parent  = -1;
+    int32_t     depth   = 0;
+};
+
+//--------------------------------------------------------------------------------------//
+//  the statistics of a node on one thread
+//
+struct stats_t
+{
+    uint64_t count = 0;
+    int64_t  time  = 0;  // nanoseconds
+    int64_t  wait  = 0;  // nanoseconds
+};
+
+//--------------------------------------------------------------------------------------//
+//  an entry on the per-thread stack. The wait fields are only used by sync regions
+//
+struct frame_t
+{
+    const node_t* node;
+    int64_t       start;
+    int64_t       wait_start;
+    int64_t       wait_excluded;
+};
+
+struct construct_key_t
+{
+    const void* codeptr;
+    int32_t     kind;
+    int32_t     parent;
+
+    bool operator==(const construct_key_t& rhs) const
+    {
+        return codeptr == rhs.codeptr && kind == rhs.kind && parent == rhs.parent;
+    }
+};
+
+inline size_t
+hash_key(const construct_key_t& _key)
+{
+    auto _val = reinterpret_cast<uintptr_t>(_key.codeptr);
+    _val ^= static_cast<uintptr_t>(_key.kind + 1) * 0xc2b2ae3d27d4eb4fULL;
+    _val ^= static_cast<uintptr_t>(_key.parent + 1) * 0x9e3779b97f4a7c15ULL;
+    _val ^= (_val >> 29);
+    return static_cast<size_t>(_val);
+}
+
+struct key_hash
+{
+    size_t operator()(const construct_key_t& _key) const { return hash_key(_key); }
+};
+
+//--------------------------------------------------------------------------------------//
+//  process-wide state. Intentionally leaked so that callbacks invoked during the
+//  shutdown of the runtime never touch a destroyed object
+//
+class thread_data;
+using thread_data_ptr = std::shared_ptr<thread_data>;
+using key_map_t       = std::unordered_map<construct_key_t, const node_t*, key_hash>;
+
+struct global_data
+{
+    std::mutex                   mutex;
+    std::deque<node_t>           nodes;
+    key_map_t                    keys;
+    std::vector<thread_data_ptr> threads;
+};
+
+std::atomic<bool> f_active(false);
+
+global_data*
+get_global_data()
+{
+    static auto _instance = new global_data;
+    return _instance;
+}
+
+//--------------------------------------------------------------------------------------//
+//  insert a node into the global graph, only called when the per-thread table misses.
+//  A construct nested in itself (e.g. recursive tasks and their taskwait) is folded
+//  into its ancestor so the depth of the graph does not follow the recursion
+//
+const node_t*
+get_global_node(const construct_key_t& _key)
+{
+    auto*                       _glob = get_global_data();
+    std::lock_guard<std::mutex> _lk(_glob->mutex);
+    auto                        itr = _glob->keys.find(_key);
+    if(itr != _glob->keys.end())
+        return itr->second;
+
+    for(auto _parent = _key.parent; _parent >= 0;)
+    {
+        const auto& _ancestor = _glob->nodes[_parent];
+        if(_ancestor.codeptr == _key.codeptr && _ancestor.kind == _key.kind)
+        {
+            _glob->keys.insert({ _key, &_ancestor });
+            return &_ancestor;
+        }
+        _parent = _ancestor.parent;
+    }
+
+    node_t _obj;
+    _obj.codeptr = _key.codeptr;
+    _obj.kind    = _key.kind;
+    _obj.index   = static_cast<int32_t>(_glob->nodes.size());
+    _obj.parent  = _key.parent;
+    _obj.depth   = (_key.parent < 0) ? 0 : _glob->nodes[_key.parent].depth + 1;
+    _glob->nodes.push_back(_obj);
+
+    const node_t* _node = &_glob->nodes.back();
+    _glob->keys.insert({ _key, _node });
+    return _node;
+}
+
+//--------------------------------------------------------------------------------------//
+//  per-thread recorder: key-to-node open-addressing table + statistics + stack
+//
+class thread_data
+{
+public:
+    thread_data()
+    : m_table(initial_size)
+    , m_mask(initial_size - 1)
+    {
+        m_stats.reserve(initial_size / 2);
+        m_stack.reserve(64);
+    }
+
+    static int64_t now() { return tim::get_clock_real_now<int64_t, std::nano>(); }
+
+    /// node of a construct encountered now
+    const node_t* get_node(const void* _codeptr, int32_t _kind)
+    {
+        auto _parent = (m_stack.empty()) ? -1 : m_stack.back().node->index;
+        return find_or_insert({ _codeptr, _kind, _parent });
+    }
+
+    void push(const node_t* _node)
+    {
+        m_last = now();
+        m_stack.push_back({ _node, m_last, 0, 0 });
+    }
+
+    /// pop the innermost frame of the given kind (and the frames above it)
+    void pop(int32_t _kind, bool _count = true)
+    {
+        auto _n = m_stack.size();
+        while(_n > 0 && m_stack[_n - 1].node->kind != _kind)
+            --_n;
+        if(_n == 0)
+            return;
+        m_last = now();
+        unwind(_n - 1, m_last, _count);
+    }
+
+    /// close the frames left open, e.g. the implicit task of an idle worker thread
+    void flush() { unwind(0, m_last, true); }
+
+    void wait_begin()
+    {
+        for(auto itr = m_stack.rbegin(); itr != m_stack.rend(); ++itr)
+        {
+            if(is_sync(itr->node->kind))
+            {
+                itr->wait_start    = now();
+                itr->wait_excluded = 0;
+                return;
+            }
+        }
+    }
+
+    void wait_end()
+    {
+        for(auto itr = m_stack.rbegin(); itr != m_stack.rend(); ++itr)
+        {
+            if(is_sync(itr->node->kind) && itr->wait_start > 0)
+            {
+                auto _wait = now() - itr->wait_start - itr->wait_excluded;
+                if(!is_nested(itr.base() - 1))
+                    get_stats(itr->node->index).wait += std::max<int64_t>(_wait, 0);
+                itr->wait_start = 0;
+                return;
+            }
+        }
+    }
+
+    const std::vector<stats_t>& stats() const { return m_stats; }
+
+private:
+    static constexpr size_t initial_size = 256;
+
+    using frame_iterator = std::vector<frame_t>::const_iterator;
+
+    struct slot_t
+    {
+        construct_key_t key  = { nullptr, 0, -1 };
+        const node_t*   node = nullptr;
+    };
+
+    stats_t& get_stats(int32_t _index)
+    {
+        if(static_cast<size_t>(_index) >= m_stats.size())
+            m_stats.resize(_index + 1);
+        return m_stats[_index];
+    }
+
+    const node_t* find_or_insert(const construct_key_t& _key)
+    {
+        auto _idx = hash_key(_key) & m_mask;
+        while(true)
+        {
+            auto& _slot = m_table[_idx];
+            if(!_slot.node)
+                break;
+            if(_slot.key == _key)
+                return _slot.node;
+            _idx = (_idx + 1) & m_mask;
+        }
+
+        auto _node          = get_global_node(_key);
+        m_table[_idx].key   = _key;
+        m_table[_idx].node  = _node;
+
+        // keep the load factor at or below 1/2
+        if(++m_size * 2 > m_table.size())
+            rehash();
+        return _node;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  whether a frame below _pos is on the same (folded) node
+    //
+    bool is_nested(frame_iterator _pos, const node_t* _node) const
+    {
+        for(auto itr = m_stack.begin(); itr != _pos; ++itr)
+            if(itr->node == _node)
+                return true;
+        return false;
+    }
+
+    bool is_nested(frame_iterator _pos) const
+    {
+        return is_nested(_pos, _pos->node);
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  pop the frames down to and including index _n. Only the outermost frame of a
+    //  folded (recursive) node accumulates time so it is not counted twice
+    //
+    void unwind(size_t _n, int64_t _end, bool _count)
+    {
+        while(m_stack.size() > _n)
+        {
+            auto _frame   = m_stack.back();
+            auto _elapsed = _end - _frame.start;
+            auto& _obj    = get_stats(_frame.node->index);
+            m_stack.pop_back();
+
+            if(_count || m_stack.size() > _n)
+                _obj.count += 1;
+
+            if(!is_nested(m_stack.end(), _frame.node))
+                _obj.time += _elapsed;
+
+            // a task executed while waiting in a sync region is not wait time
+            if(_frame.node->kind != CONSTRUCT_TASK)
+                continue;
+            for(auto itr = m_stack.rbegin(); itr != m_stack.rend(); ++itr)
+            {
+                if(is_sync(itr->node->kind) && itr->wait_start > 0)
+                {
+                    itr->wait_excluded += _elapsed;
+                    break;
+                }
+            }
+        }
+    }
+
+    void rehash()
+    {
+        std::vector<slot_t> _table(2 * m_table.size());
+        m_mask = _table.size() - 1;
+        for(const auto& itr : m_table)
+        {
+            if(!itr.node)
+                continue;
+            auto _idx = hash_key(itr.key) & m_mask;
+            while(_table[_idx].node)
+                _idx = (_idx + 1) & m_mask;
+            _table[_idx] = itr;
+        }
+        std::swap(m_table, _table);
+    }
+
+private:
+    std::vector<slot_t>  m_table;
+    size_t               m_mask;
+    size_t               m_size = 0;
+    int64_t              m_last = 0;
+    std::vector<stats_t> m_stats;
+    std::vector<frame_t> m_stack;
+};
+
+thread_data*
+get_thread_data()
+{
+    static thread_local thread_data* _instance = nullptr;
+    if(!_instance)
+    {
+        auto  _data = std::make_shared<thread_data>();
+        auto* _glob = get_global_data();
+        std::lock_guard<std::mutex> _lk(_glob->mutex);
+        _glob->threads.push_back(_data);
+        _instance = _data.get();
+    }
+    return _instance;
+}
+
+//======================================================================================//
+//
+//      OMPT callbacks
+//
+//======================================================================================//
+
+void
+on_parallel_begin(ompt_data_t*, const ompt_frame_t*, ompt_data_t* _parallel_data,
+                  unsigned int, int, const void* _codeptr)
+{
+    if(!f_active.load(std::memory_order_relaxed))
+        return;
+    // read by every thread of the team when its implicit task begins
+    _parallel_data->ptr = const_cast<node_t*>(
+        get_thread_data()->get_node(_codeptr, CONSTRUCT_PARALLEL));
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+on_implicit_task(ompt_scope_endpoint_t _endpoint, ompt_data_t* _parallel_data,
+                 ompt_data_t* _task_data, unsigned int, unsigned int, int _flags)
+{
+    if(!f_active.load(std::memory_order_relaxed) || (_flags & ompt_task_initial))
+        return;
+    auto* _data = get_thread_data();
+    if(_endpoint == ompt_scope_begin)
+    {
+        _task_data->ptr = nullptr;
+        // the parallel data is empty if the region began before the tool was active
+        auto* _node = (_parallel_data && _parallel_data->ptr)
+                          ? static_cast<const node_t*>(_parallel_data->ptr)
+                          : _data->get_node(nullptr, CONSTRUCT_PARALLEL);
+        _data->push(_node);
+    }
+    else
+    {
+        _data->pop(CONSTRUCT_PARALLEL);
+    }
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+on_work(ompt_work_t _wstype, ompt_scope_endpoint_t _endpoint, ompt_data_t*,
+        ompt_data_t*, uint64_t, const void* _codeptr)
+{
+    // the threads which skip a single construct only wait in the barrier after it
+    if(!f_active.load(std::memory_order_relaxed) || _wstype == ompt_work_single_other)
+        return;
+    auto* _data = get_thread_data();
+    auto  _kind = get_work_kind(_wstype);
+    if(_endpoint == ompt_scope_begin)
+        _data->push(_data->get_node(_codeptr, _kind));
+    else
+        _data->pop(_kind);
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+on_sync_region(ompt_sync_region_t _sync_kind, ompt_scope_endpoint_t _endpoint,
+               ompt_data_t*, ompt_data_t*, const void* _codeptr)
+{
+    if(!f_active.load(std::memory_order_relaxed))
+        return;
+    auto* _data = get_thread_data();
+    auto  _kind = get_sync_kind(_sync_kind);
+    if(_endpoint == ompt_scope_begin)
+        _data->push(_data->get_node(_codeptr, _kind));
+    else
+        _data->pop(_kind);
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+on_sync_region_wait(ompt_sync_region_t, ompt_scope_endpoint_t _endpoint, ompt_data_t*,
+                    ompt_data_t*, const void*)
+{
+    if(!f_active.load(std::memory_order_relaxed))
+        return;
+    auto* _data = get_thread_data();
+    if(_endpoint == ompt_scope_begin)
+        _data->wait_begin();
+    else
+        _data->wait_end();
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+on_task_create(ompt_data_t*, const ompt_frame_t*, ompt_data_t* _new_task_data,
+               int _flags, int, const void* _codeptr)
+{
+    if(!f_active.load(std::memory_order_relaxed))
+        return;
+    _new_task_data->ptr = nullptr;
+    if(!(_flags & ompt_task_explicit))
+        return;
+    // the task is recorded under the creating node on whichever thread executes it
+    _new_task_data->ptr =
+        const_cast<node_t*>(get_thread_data()->get_node(_codeptr, CONSTRUCT_TASK));
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+on_task_schedule(ompt_data_t* _prior_task_data, ompt_task_status_t _prior_status,
+                 ompt_data_t* _next_task_data)
+{
+    if(!f_active.load(std::memory_order_relaxed))
+        return;
+    auto* _data = get_thread_data();
+    if(_prior_task_data && _prior_task_data->ptr)
+    {
+        // a suspended task accumulates its time but only completes once
+        bool _done = (_prior_status == ompt_task_complete ||
+                      _prior_status == ompt_task_cancel ||
+                      _prior_status == ompt_task_detach);
+        _data->pop(CONSTRUCT_TASK, _done);
+    }
+    if(_next_task_data && _next_task_data->ptr)
+        _data->push(static_cast<const node_t*>(_next_task_data->ptr));
+}
+
+//======================================================================================//
+//
+//      finalization (not on the hot path)
+//
+//======================================================================================//
+
+//--------------------------------------------------------------------------------------//
+//  resolve a codeptr_ra to <function>+<offset>
+//
+std::string
+resolve(const void* _addr)
+{
+    std::stringstream ss;
+    Dl_info           _info;
+    if(_addr && dladdr(_addr, &_info) != 0)
+    {
+        auto _offset = [&](const void* _base) {
+            return reinterpret_cast<uintptr_t>(_addr) -
+                   reinterpret_cast<uintptr_t>(_base);
+        };
+        if(_info.dli_sname)
+        {
+            ss << tim::demangle(_info.dli_sname) << "+0x" << std::hex
+               << _offset(_info.dli_saddr);
+            return ss.str();
+        }
+        if(_info.dli_fname)
+        {
+            std::string _fname = _info.dli_fname;
+            ss << _fname.substr(_fname.find_last_of('/') + 1) << "+0x" << std::hex
+               << _offset(_info.dli_fbase);
+            return ss.str();
+        }
+    }
+    if(_addr)
+        ss << _addr;
+    return ss.str();
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+finalize()
+{
+    using tim::component::ompt_construct;
+
+    if(!f_active.exchange(false))
+        return;
+
+    auto* _glob = get_global_data();
+    {
+        std::lock_guard<std::mutex> _lk(_glob->mutex);
+        if(_glob->nodes.empty())
+            return;
+
+        // the implicit task of a worker only ends when the next parallel region begins
+        for(auto& itr : _glob->threads)
+            itr->flush();
+
+        auto _nnodes  = _glob->nodes.size();
+        auto _combine = [&](size_t _idx, ompt_construct& _obj) {
+            for(const auto& titr : _glob->threads)
+            {
+                const auto& _stats = titr->stats();
+                if(_idx < _stats.size() && _stats[_idx].count > 0)
+                    _obj.add_thread(_stats[_idx].time, _stats[_idx].wait,
+                                    _stats[_idx].count);
+            }
+        };
+
+        //------------------------------------------------------------------------------//
+        //  combine the per-thread statistics of each node
+        //
+        std::vector<ompt_construct> _graph(_nnodes);
+        for(size_t i = 0; i < _nnodes; ++i)
+            _combine(i, _graph[i]);
+
+        //------------------------------------------------------------------------------//
+        //  insert the nodes into the storage depth-first, the children of a node are
+        //  ordered by decreasing total time
+        //
+        std::vector<std::vector<int64_t>> _children(_nnodes);
+        std::vector<int64_t>              _roots;
+        for(size_t i = 0; i < _nnodes; ++i)
+        {
+            if(_glob->nodes[i].parent < 0)
+                _roots.push_back(i);
+            else
+                _children[_glob->nodes[i].parent].push_back(i);
+        }
+
+        std::deque<ompt_construct> _stack;
+        std::vector<int64_t>       _pending(_roots.rbegin(), _roots.rend());
+        while(!_pending.empty())
+        {
+            auto _idx = _pending.back();
+            _pending.pop_back();
+            if(_graph[_idx].nlaps() == 0)
+                continue;
+
+            const auto& _node = _glob->nodes[_idx];
+            while(_stack.size() > static_cast<size_t>(_node.depth))
+            {
+                tim::operation::pop_node<ompt_construct>(_stack.back());
+                _stack.pop_back();
+            }
+
+            std::string _label = construct_labels[_node.kind];
+            if(_node.codeptr)
+                _label += " [" + resolve(_node.codeptr) + "]";
+
+            // the node is inserted empty and receives the statistics when it is popped
+            _stack.push_back(ompt_construct{});
+            tim::operation::insert_node<ompt_construct, tim::scope::process>(
+                _stack.back(), tim::add_hash_id(_label));
+            _combine(_idx, _stack.back());
+
+            auto& _child = _children[_idx];
+            std::sort(_child.begin(), _child.end(), [&](int64_t lhs, int64_t rhs) {
+                return _graph[lhs].get_value()[ompt_construct::total_idx] <
+                       _graph[rhs].get_value()[ompt_construct::total_idx];
+            });
+            for(auto itr : _child)
+                _pending.push_back(itr);
+        }
+
+        while(!_stack.empty())
+        {
+            tim::operation::pop_node<ompt_construct>(_stack.back());
+            _stack.pop_back();
+        }
+    }
+
+    tim::timemory_finalize();
+}
+
+//--------------------------------------------------------------------------------------//
+
+template <typename _Tp>
+void
+set_callback(ompt_set_callback_t _set_callback, ompt_callbacks_t _event, _Tp _func)
+{
+    auto _ret = _set_callback(_event, reinterpret_cast<ompt_callback_t>(_func));
+    if(_ret == ompt_set_error || _ret == ompt_set_never)
+        fprintf(stderr, "[timemory-ompt]> callback %i is not supported\n",
+                static_cast<int>(_event));
+}
+
+//--------------------------------------------------------------------------------------//
+
+int
+initialize(ompt_function_lookup_t _lookup, int, ompt_data_t*)
+{
+    auto _set_callback =
+        reinterpret_cast<ompt_set_callback_t>(_lookup("ompt_set_callback"));
+    if(!_set_callback)
+        return 0;
+
+    set_callback(_set_callback, ompt_callback_parallel_begin, &on_parallel_begin);
+    set_callback(_set_callback, ompt_callback_implicit_task, &on_implicit_task);
+    set_callback(_set_callback, ompt_callback_work, &on_work);
+    set_callback(_set_callback, ompt_callback_sync_region, &on_sync_region);
+    set_callback(_set_callback, ompt_callback_sync_region_wait, &on_sync_region_wait);
+    if(tim::get_env<bool>("TIMEMORY_OMPT_TASKS", true))
+    {
+        set_callback(_set_callback, ompt_callback_task_create, &on_task_create);
+        set_callback(_set_callback, ompt_callback_task_schedule, &on_task_schedule);
+    }
+
+    tim::timemory_init(program_invocation_short_name);
+    tim::component::ompt_construct::initialize_storage();
+    // registered after the storage is created so the report is generated before the
+    // timemory singletons are destroyed
+    std::atexit(&finalize);
+
+    f_active.store(true);
+    return 1;
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+finalize_tool(ompt_data_t*)
+{
+    finalize();
+}
+
+//--------------------------------------------------------------------------------------//
+//  the runtime normally finalizes the tool, this handles runtimes which do not
+//
+__attribute__((destructor)) void
+destroy()
+{
+    finalize();
+}
+
+}  // namespace
+
+//======================================================================================//
+
+extern "C"
+{
+    /// entry point of the tool, looked up by the OpenMP runtime when it initializes
+    ompt_start_tool_result_t* ompt_start_tool(unsigned int, const char*)
+    {
+        if(!tim::get_env<bool>("TIMEMORY_OMPT_ENABLED", true))
+            return nullptr;
+        static ompt_start_tool_result_t _result = { &initialize, &finalize_tool,
+                                                    ompt_data_none };
+        return &_result;
+    }
+
+    /// write the report now instead of when the runtime shuts down
+    void timemory_ompt_finalize() { finalize(); }
+}
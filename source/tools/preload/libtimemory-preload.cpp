@@ -0,0 +1,439 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file libtimemory-preload.cpp
+ * Library loaded via LD_PRELOAD (see timemory-preload) which wraps functions listed
+ * at runtime with GOTCHA. Unlike the gotcha component, the signatures are not known
+ * at compile time: each function is assigned a pre-generated generic trampoline
+ * which forwards every argument register of the calling convention to the original
+ * function, so any function whose arguments are all passed in registers can be
+ * wrapped. The trampolines are grouped into signature classes by return type:
+ *
+ *      int     integer, pointer, or void return (default)
+ *      fp      double return ("double" is an alias)
+ *      float   float return
+ *
+ * Limitations: arguments passed on the stack (more than 6 integer/pointer arguments
+ * on x86-64, more than 8 on AArch64, or structs passed by value), struct returns,
+ * and variadic functions (e.g. printf) are not supported.
+ *
+ * Environment:
+ *      TIMEMORY_PRELOAD_FUNCTIONS      "name[:class]" entries delimited by ",; "
+ *      TIMEMORY_PRELOAD_FILE           file with one "name [class]" entry per line
+ *      TIMEMORY_PRELOAD_COMPONENTS     components to record (default: real_clock)
+ */
+
+#include "timemory/timemory.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if !defined(TIMEMORY_USE_GOTCHA)
+#    error "timemory-preload requires GOTCHA"
+#endif
+
+#if !defined(TIMEMORY_PRELOAD_MAX_FUNCTIONS)
+#    define TIMEMORY_PRELOAD_MAX_FUNCTIONS 128
+#endif
+
+using namespace tim::component;
+
+//======================================================================================//
+
+namespace
+{
+using ireg_t = uintptr_t;
+
+#if defined(__aarch64__)
+#    define TIMEMORY_PRELOAD_IREGS(_Tp)                                                  \
+        _Tp a0, _Tp a1, _Tp a2, _Tp a3, _Tp a4, _Tp a5, _Tp a6, _Tp a7
+#    define TIMEMORY_PRELOAD_IARGS a0, a1, a2, a3, a4, a5, a6, a7
+#else
+#    define TIMEMORY_PRELOAD_IREGS(_Tp) _Tp a0, _Tp a1, _Tp a2, _Tp a3, _Tp a4, _Tp a5
+#    define TIMEMORY_PRELOAD_IARGS a0, a1, a2, a3, a4, a5
+#endif
+
+#define TIMEMORY_PRELOAD_FREGS(_Tp)                                                      \
+    _Tp f0, _Tp f1, _Tp f2, _Tp f3, _Tp f4, _Tp f5, _Tp f6, _Tp f7
+#define TIMEMORY_PRELOAD_FARGS f0, f1, f2, f3, f4, f5, f6, f7
+
+using toolset_t        = tim::complete_list_t;
+using toolset_stack_t  = std::deque<toolset_t>;
+using component_enum_t = std::vector<TIMEMORY_COMPONENT>;
+using binding_t        = tim::gotcha::binding_t;
+using wrappee_t        = tim::gotcha::wrappee_t;
+
+constexpr size_t max_functions = TIMEMORY_PRELOAD_MAX_FUNCTIONS;
+
+//--------------------------------------------------------------------------------------//
+//  signature classes
+//
+enum class signature : short
+{
+    integral = 0,
+    floating,
+    single
+};
+
+using int_func_t = ireg_t (*)(TIMEMORY_PRELOAD_IREGS(ireg_t),
+                              TIMEMORY_PRELOAD_FREGS(double));
+using fp_func_t  = double (*)(TIMEMORY_PRELOAD_IREGS(ireg_t),
+                             TIMEMORY_PRELOAD_FREGS(double));
+using flt_func_t = float (*)(TIMEMORY_PRELOAD_IREGS(ireg_t),
+                             TIMEMORY_PRELOAD_FREGS(double));
+
+//--------------------------------------------------------------------------------------//
+//  per-function data referenced by a trampoline
+//
+struct slot_t
+{
+    bool        filled  = false;
+    std::string name    = "";
+    std::string label   = "";
+    wrappee_t   wrappee = wrappee_t{};
+    binding_t   binding = binding_t{};
+};
+
+template <signature _Sig>
+std::array<slot_t, max_functions>&
+get_slots()
+{
+    static std::array<slot_t, max_functions> _instance;
+    return _instance;
+}
+
+//--------------------------------------------------------------------------------------//
+
+std::atomic<bool>&
+get_ready()
+{
+    static std::atomic<bool> _instance(false);
+    return _instance;
+}
+
+component_enum_t&
+get_components()
+{
+    static component_enum_t _instance;
+    return _instance;
+}
+
+//--------------------------------------------------------------------------------------//
+//  thread-local state: the guard prevents recursion when recording calls a wrapped
+//  function (e.g. malloc or write) and the stack keeps the bundles alive
+//
+bool&
+get_suppress()
+{
+    static thread_local bool _instance = false;
+    return _instance;
+}
+
+toolset_stack_t&
+get_toolset_stack()
+{
+    static thread_local toolset_stack_t _instance;
+    return _instance;
+}
+
+//--------------------------------------------------------------------------------------//
+//  generic begin/end shared by all trampolines
+//
+toolset_t*
+begin_record(const slot_t& _slot)
+{
+    auto& _suppress = get_suppress();
+    if(_suppress || !get_ready().load(std::memory_order_relaxed))
+        return nullptr;
+
+    _suppress   = true;
+    auto& _data = get_toolset_stack();
+    _data.emplace_back(_slot.label, true, tim::settings::flat_profile());
+    auto* _obj = &_data.back();
+    tim::initialize(*_obj, get_components());
+    _obj->start();
+    _suppress = false;
+    return _obj;
+}
+
+void
+end_record(toolset_t* _obj)
+{
+    if(!_obj)
+        return;
+
+    auto& _suppress = get_suppress();
+    _suppress       = true;
+    _obj->stop();
+    get_toolset_stack().pop_back();
+    _suppress = false;
+}
+
+//--------------------------------------------------------------------------------------//
+//  the trampolines. Arguments which are not used by the original function are
+//  forwarded as-is (i.e. whatever is in the unused registers). errno is preserved
+//  so that recording does not clobber the result of the wrapped function
+//
+template <size_t _Idx>
+ireg_t
+int_trampoline(TIMEMORY_PRELOAD_IREGS(ireg_t), TIMEMORY_PRELOAD_FREGS(double))
+{
+    auto& _slot = get_slots<signature::integral>()[_Idx];
+    auto  _orig = (int_func_t) gotcha_get_wrappee(_slot.wrappee);
+    auto* _obj  = begin_record(_slot);
+    auto  _ret  = (*_orig)(TIMEMORY_PRELOAD_IARGS, TIMEMORY_PRELOAD_FARGS);
+    auto  _err  = errno;
+    end_record(_obj);
+    errno = _err;
+    return _ret;
+}
+
+template <size_t _Idx>
+double
+fp_trampoline(TIMEMORY_PRELOAD_IREGS(ireg_t), TIMEMORY_PRELOAD_FREGS(double))
+{
+    auto& _slot = get_slots<signature::floating>()[_Idx];
+    auto  _orig = (fp_func_t) gotcha_get_wrappee(_slot.wrappee);
+    auto* _obj  = begin_record(_slot);
+    auto  _ret  = (*_orig)(TIMEMORY_PRELOAD_IARGS, TIMEMORY_PRELOAD_FARGS);
+    auto  _err  = errno;
+    end_record(_obj);
+    errno = _err;
+    return _ret;
+}
+
+template <size_t _Idx>
+float
+flt_trampoline(TIMEMORY_PRELOAD_IREGS(ireg_t), TIMEMORY_PRELOAD_FREGS(double))
+{
+    auto& _slot = get_slots<signature::single>()[_Idx];
+    auto  _orig = (flt_func_t) gotcha_get_wrappee(_slot.wrappee);
+    auto* _obj  = begin_record(_slot);
+    auto  _ret  = (*_orig)(TIMEMORY_PRELOAD_IARGS, TIMEMORY_PRELOAD_FARGS);
+    auto  _err  = errno;
+    end_record(_obj);
+    errno = _err;
+    return _ret;
+}
+
+//--------------------------------------------------------------------------------------//
+//  the pool of trampolines for each signature class
+//
+using pool_t = std::array<void*, max_functions>;
+
+template <size_t... _Idx>
+pool_t
+make_pool(signature _sig, tim::index_sequence<_Idx...>)
+{
+    switch(_sig)
+    {
+        case signature::floating: return pool_t{ { (void*) &fp_trampoline<_Idx>... } };
+        case signature::single: return pool_t{ { (void*) &flt_trampoline<_Idx>... } };
+        case signature::integral: break;
+    }
+    return pool_t{ { (void*) &int_trampoline<_Idx>... } };
+}
+
+void*
+get_trampoline(signature _sig, size_t _idx)
+{
+    using sequence_t = tim::make_index_sequence<max_functions>;
+    static auto _int = make_pool(signature::integral, sequence_t{});
+    static auto _fp  = make_pool(signature::floating, sequence_t{});
+    static auto _flt = make_pool(signature::single, sequence_t{});
+    switch(_sig)
+    {
+        case signature::floating: return _fp.at(_idx);
+        case signature::single: return _flt.at(_idx);
+        case signature::integral: break;
+    }
+    return _int.at(_idx);
+}
+
+std::array<slot_t, max_functions>&
+get_slots(signature _sig)
+{
+    switch(_sig)
+    {
+        case signature::floating: return get_slots<signature::floating>();
+        case signature::single: return get_slots<signature::single>();
+        case signature::integral: break;
+    }
+    return get_slots<signature::integral>();
+}
+
+const char*
+get_class_name(signature _sig)
+{
+    switch(_sig)
+    {
+        case signature::floating: return "fp";
+        case signature::single: return "float";
+        case signature::integral: break;
+    }
+    return "int";
+}
+
+//--------------------------------------------------------------------------------------//
+//  parse "name[:class]" or "name class"
+//
+bool
+parse_entry(std::string _entry, std::string& _name, signature& _sig)
+{
+    for(auto& itr : _entry)
+        if(itr == ':' || itr == '\t')
+            itr = ' ';
+    auto _fields = tim::delimit(_entry, " ");
+    if(_fields.empty() || _fields.front().front() == '#')
+        return false;
+
+    _name = _fields.at(0);
+    _sig  = signature::integral;
+    if(_fields.size() > 1)
+    {
+        auto _class = _fields.at(1);
+        for(auto& itr : _class)
+            itr = tolower(itr);
+        if(_class == "fp" || _class == "double")
+            _sig = signature::floating;
+        else if(_class == "float")
+            _sig = signature::single;
+        else if(_class != "int" && _class != "ptr" && _class != "void")
+            fprintf(stderr,
+                    "[timemory-preload]> Unknown signature class '%s' for '%s'. "
+                    "Using 'int'...\n",
+                    _class.c_str(), _name.c_str());
+    }
+    return true;
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+wrap(const std::string& _name, signature _sig)
+{
+    auto& _slots = get_slots(_sig);
+    for(size_t i = 0; i < _slots.size(); ++i)
+    {
+        auto& _slot = _slots[i];
+        if(_slot.filled)
+        {
+            if(_slot.name == _name)
+                return;
+            continue;
+        }
+
+        _slot.filled  = true;
+        _slot.name    = _name;
+        _slot.label   = tim::demangle(_name);
+        _slot.binding = binding_t{ _slot.name.c_str(), get_trampoline(_sig, i),
+                                   &_slot.wrappee };
+
+        auto _tool = std::string("timemory-preload/") + _slot.label;
+        auto _ret  = tim::gotcha::wrap(_slot.binding, _tool);
+        if(_ret != GOTCHA_SUCCESS)
+        {
+            fprintf(stderr, "[timemory-preload]> Failed to wrap '%s': %s\n",
+                    _name.c_str(), tim::gotcha::get_error(_ret).c_str());
+        }
+        else if(tim::settings::verbose() > 0 || tim::settings::debug())
+        {
+            printf("[timemory-preload]> Wrapped '%s' (%s)\n", _name.c_str(),
+                   get_class_name(_sig));
+        }
+        return;
+    }
+
+    fprintf(stderr,
+            "[timemory-preload]> Unable to wrap '%s': the maximum of %i functions per "
+            "signature class has been reached\n",
+            _name.c_str(), (int) max_functions);
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+finalize()
+{
+    get_ready().store(false);
+    get_suppress() = true;
+    tim::timemory_finalize();
+}
+
+//--------------------------------------------------------------------------------------//
+
+__attribute__((constructor)) void
+initialize()
+{
+    auto& _suppress = get_suppress();
+    _suppress       = true;
+
+    std::vector<std::string> _entries;
+    for(const auto& itr : tim::delimit(
+            tim::get_env<std::string>("TIMEMORY_PRELOAD_FUNCTIONS", ""), ",; "))
+        _entries.push_back(itr);
+
+    auto _fname = tim::get_env<std::string>("TIMEMORY_PRELOAD_FILE", "");
+    if(!_fname.empty())
+    {
+        std::ifstream ifs(_fname.c_str());
+        if(!ifs)
+            fprintf(stderr, "[timemory-preload]> Unable to open '%s'\n",
+                    _fname.c_str());
+        std::string _line;
+        while(std::getline(ifs, _line))
+            _entries.push_back(_line);
+    }
+
+    if(_entries.empty())
+    {
+        _suppress = false;
+        return;
+    }
+
+    tim::timemory_init(program_invocation_short_name);
+    get_components() =
+        tim::enumerate_components("real_clock", "TIMEMORY_PRELOAD_COMPONENTS");
+
+    for(const auto& itr : _entries)
+    {
+        std::string _name;
+        signature   _sig;
+        if(parse_entry(itr, _name, _sig))
+            wrap(_name, _sig);
+    }
+
+    atexit(&finalize);
+    get_ready().store(true);
+    _suppress = false;
+}
+
+}  // namespace
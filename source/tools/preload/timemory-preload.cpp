@@ -0,0 +1,183 @@
+// MIT License
+//
+// Copyright (c) 2019, The Regents of the University of California,
+// through Lawrence Berkeley National Laboratory (subject to receipt of any
+// required approvals from the U.S. Dept. of Energy).  All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+/** \file timemory-preload.cpp
+ * Launcher which runs a command with libtimemory-preload in LD_PRELOAD so that the
+ * listed functions are wrapped without rebuilding the application.
+ *
+ *  usage: timemory-preload [options] -- <command> [args...]
+ *
+ *      -f, --function  NAME[:CLASS]    wrap NAME (CLASS: int, fp, float)
+ *      -F, --file      FILE            file with one "NAME [CLASS]" entry per line
+ *      -c, --components LIST           components to record (e.g. "real_clock,peak_rss")
+ *      -l, --library   PATH            path to libtimemory-preload
+ *
+ *  example:
+ *      timemory-preload -f fread -f fwrite -f cos:fp -- ./myapp input.dat
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#if !defined(TIMEMORY_PRELOAD_LIBRARY_NAME)
+#    define TIMEMORY_PRELOAD_LIBRARY_NAME "libtimemory-preload.so"
+#endif
+
+#if !defined(TIMEMORY_PRELOAD_LIBRARY_INSTALL_DIR)
+#    define TIMEMORY_PRELOAD_LIBRARY_INSTALL_DIR "lib"
+#endif
+
+//======================================================================================//
+
+void
+usage(const char* _exe)
+{
+    fprintf(stderr,
+            "usage: %s [options] -- <command> [args...]\n\n"
+            "    -f, --function   NAME[:CLASS]  wrap NAME (CLASS: int, fp, float)\n"
+            "    -F, --file       FILE          one 'NAME [CLASS]' entry per line\n"
+            "    -c, --components LIST          components to record\n"
+            "    -l, --library    PATH          path to %s\n"
+            "    -h, --help                     print this message\n",
+            _exe, TIMEMORY_PRELOAD_LIBRARY_NAME);
+}
+
+//--------------------------------------------------------------------------------------//
+//  locate the library relative to this executable, e.g. <prefix>/bin/../lib
+//
+std::string
+find_library()
+{
+    char    _exe[4096];
+    ssize_t _len = readlink("/proc/self/exe", _exe, sizeof(_exe) - 1);
+    if(_len > 0)
+    {
+        _exe[_len]       = '\0';
+        std::string _dir = _exe;
+        _dir             = _dir.substr(0, _dir.find_last_of('/'));
+        for(const auto& itr :
+            { _dir + "/../" TIMEMORY_PRELOAD_LIBRARY_INSTALL_DIR "/", _dir + "/" })
+        {
+            auto _path = itr + TIMEMORY_PRELOAD_LIBRARY_NAME;
+            if(access(_path.c_str(), R_OK) == 0)
+                return _path;
+        }
+    }
+    // rely on the dynamic linker search path
+    return TIMEMORY_PRELOAD_LIBRARY_NAME;
+}
+
+//--------------------------------------------------------------------------------------//
+
+void
+append_env(const char* _env_id, const std::string& _value, const char* _delim)
+{
+    std::string _current = (getenv(_env_id)) ? getenv(_env_id) : "";
+    auto        _result  = (_current.empty()) ? _value : (_value + _delim + _current);
+    setenv(_env_id, _result.c_str(), 1);
+}
+
+//======================================================================================//
+
+int
+main(int argc, char** argv)
+{
+    std::vector<std::string> _functions;
+    std::string              _library = "";
+    int                      _cmd     = -1;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string _arg = argv[i];
+        auto        _val = [&]() -> std::string {
+            if(i + 1 >= argc)
+            {
+                fprintf(stderr, "Error! Missing value for '%s'\n", _arg.c_str());
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+            }
+            return argv[++i];
+        };
+
+        if(_arg == "--")
+        {
+            _cmd = i + 1;
+            break;
+        }
+        else if(_arg == "-h" || _arg == "--help")
+        {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        else if(_arg == "-f" || _arg == "--function")
+            _functions.push_back(_val());
+        else if(_arg == "-F" || _arg == "--file")
+            setenv("TIMEMORY_PRELOAD_FILE", _val().c_str(), 1);
+        else if(_arg == "-c" || _arg == "--components")
+            setenv("TIMEMORY_PRELOAD_COMPONENTS", _val().c_str(), 1);
+        else if(_arg == "-l" || _arg == "--library")
+            _library = _val();
+        else if(_arg.find('-') == 0)
+        {
+            fprintf(stderr, "Error! Unknown option '%s'\n", _arg.c_str());
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        else
+        {
+            // no "--" separator: the command starts here
+            _cmd = i;
+            break;
+        }
+    }
+
+    if(_cmd < 0 || _cmd >= argc)
+    {
+        fprintf(stderr, "Error! No command provided\n");
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if(!_functions.empty())
+    {
+        std::string _list;
+        for(const auto& itr : _functions)
+            _list += ((_list.empty()) ? "" : ",") + itr;
+        append_env("TIMEMORY_PRELOAD_FUNCTIONS", _list, ",");
+    }
+
+    if(_library.empty())
+        _library = find_library();
+    append_env("LD_PRELOAD", _library, ":");
+
+    execvp(argv[_cmd], argv + _cmd);
+    fprintf(stderr, "Error! Unable to execute '%s': %s\n", argv[_cmd], strerror(errno));
+    return EXIT_FAILURE;
+}
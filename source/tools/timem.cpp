@@ -37,15 +37,26 @@
 #endif
 
 #if defined(_UNIX)
+#    include <fcntl.h>
 #    include <unistd.h>
 #endif
 
+#if defined(_LINUX)
+#    include <dirent.h>
+#    include <sys/prctl.h>
+#    include <sys/resource.h>
+#    include <time.h>
+#endif
+
 // C++ includes
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <map>
 #include <thread>
 #include <vector>
 
@@ -161,6 +172,668 @@ command()
     return _instance;
 }
 
+//--------------------------------------------------------------------------------------//
+//
+//  Time-series sampling of the child process
+//
+//  TIMEM_SAMPLE_INTERVAL       interval in milliseconds (0 == disabled)
+//  TIMEM_SAMPLE_DESCENDANTS    include all descendants of the child in each sample
+//  TIMEM_SAMPLE_FORMAT         "csv" or "binary"
+//  TIMEM_SAMPLE_BUFFER         number of samples held in memory before they are
+//                              appended to the output file
+//
+//  The samples are stored in a preallocated buffer which is flushed to the output
+//  file by the sampling thread when it is full so the memory usage is constant
+//  regardless of the run-time. The files under /proc for the child are kept open
+//  and re-read with pread(2) so each sample costs a handful of system calls.
+//
+//--------------------------------------------------------------------------------------//
+
+struct timem_sample
+{
+    int64_t  time;         // nanoseconds since the start of the sampling
+    int64_t  nproc;        // number of processes in the sample
+    uint64_t user_time;    // clock ticks
+    uint64_t system_time;  // clock ticks
+    uint64_t virtual_mem;  // bytes
+    uint64_t resident;     // bytes
+    uint64_t shared;       // bytes
+    uint64_t read_bytes;   // bytes
+    uint64_t write_bytes;  // bytes
+    uint64_t minor_faults;
+    uint64_t major_faults;
+    uint64_t num_threads;
+
+    timem_sample& operator+=(const timem_sample& rhs)
+    {
+        nproc += rhs.nproc;
+        user_time += rhs.user_time;
+        system_time += rhs.system_time;
+        virtual_mem += rhs.virtual_mem;
+        resident += rhs.resident;
+        shared += rhs.shared;
+        read_bytes += rhs.read_bytes;
+        write_bytes += rhs.write_bytes;
+        minor_faults += rhs.minor_faults;
+        major_faults += rhs.major_faults;
+        num_threads += rhs.num_threads;
+        return *this;
+    }
+};
+
+//--------------------------------------------------------------------------------------//
+
+class timem_sampler
+{
+public:
+    using clock_type    = std::chrono::steady_clock;
+    using duration_type = std::chrono::nanoseconds;
+
+    // binary file header: the records which follow are "sizeof(timem_sample)" bytes
+    struct header
+    {
+        char     magic[8]     = { 'T', 'I', 'M', 'E', 'M', 'S', 'M', 'P' };
+        uint32_t version      = 1;
+        uint32_t record_size  = sizeof(timem_sample);
+        int64_t  interval     = 0;
+        int64_t  clock_ticks  = 0;
+        int64_t  page_size    = 0;
+        int64_t  process_id   = 0;
+        int64_t  num_records  = 0;  // updated when the file is closed
+        int64_t  descendants  = 0;
+    };
+
+    static int64_t& interval()
+    {
+        static int64_t _instance = tim::get_env<int64_t>("TIMEM_SAMPLE_INTERVAL", 0);
+        return _instance;
+    }
+
+    static bool& descendants()
+    {
+        static bool _instance = tim::get_env<bool>("TIMEM_SAMPLE_DESCENDANTS", false);
+        return _instance;
+    }
+
+    static bool& binary()
+    {
+        static bool _instance =
+            (tim::get_env<std::string>("TIMEM_SAMPLE_FORMAT", "csv") == "binary");
+        return _instance;
+    }
+
+    static uint64_t& buffer_size()
+    {
+        static uint64_t _instance =
+            std::max<uint64_t>(tim::get_env<uint64_t>("TIMEM_SAMPLE_BUFFER", 8192), 1);
+        return _instance;
+    }
+
+public:
+    explicit timem_sampler(pid_t _pid)
+    : m_pid(_pid)
+    , m_buffer(buffer_size())
+    {}
+
+    ~timem_sampler() { stop(); }
+
+    timem_sampler(const timem_sampler&) = delete;
+    timem_sampler& operator=(const timem_sampler&) = delete;
+
+    void start()
+    {
+#if defined(_LINUX)
+        if(interval() <= 0 || m_thread)
+            return;
+
+        m_fds[0] = open_proc(m_pid, "stat");
+        m_fds[1] = open_proc(m_pid, "statm");
+        m_fds[2] = open_proc(m_pid, "io");
+        if(m_fds[0] < 0)
+        {
+            close_fds();
+            return;
+        }
+
+        auto _ext   = (binary()) ? ".dat" : ".csv";
+        auto _fname = tim::settings::compose_output_filename("timem-samples", _ext);
+        m_file      = fopen(_fname.c_str(), (binary()) ? "wb" : "w");
+        if(!m_file)
+        {
+            fprintf(stderr, "[timem]> Error opening '%s'...\n", _fname.c_str());
+            close_fds();
+            return;
+        }
+        m_fname = _fname;
+
+        if(binary())
+        {
+            m_header.interval    = interval();
+            m_header.clock_ticks = sysconf(_SC_CLK_TCK);
+            m_header.page_size   = sysconf(_SC_PAGESIZE);
+            m_header.process_id  = m_pid;
+            m_header.descendants = (descendants()) ? 1 : 0;
+            fwrite(&m_header, sizeof(header), 1, m_file);
+        }
+        else
+        {
+            fprintf(m_file, "# interval (msec): %lli, clock ticks: %li, page size: %li\n",
+                    static_cast<long long>(interval()), sysconf(_SC_CLK_TCK),
+                    sysconf(_SC_PAGESIZE));
+            fprintf(m_file, "time,nproc,user_time,system_time,virtual_mem,resident,"
+                            "shared,read_bytes,write_bytes,minor_faults,major_faults,"
+                            "num_threads\n");
+        }
+
+        m_active = true;
+        m_thread = std::unique_ptr<std::thread>(new std::thread([&]() { execute(); }));
+#endif
+    }
+
+    void stop()
+    {
+        if(!m_thread)
+            return;
+
+        m_active = false;
+        m_thread->join();
+        m_thread.reset();
+
+        close_fds();
+        flush();
+
+        if(binary())
+        {
+            fseek(m_file, 0, SEEK_SET);
+            fwrite(&m_header, sizeof(header), 1, m_file);
+        }
+
+        fclose(m_file);
+        m_file = nullptr;
+        printf("[timem]> Outputting '%s'...\n", m_fname.c_str());
+    }
+
+private:
+    //----------------------------------------------------------------------------------//
+    //  release the /proc file descriptors of the child process
+    //
+    void close_fds()
+    {
+        for(auto& itr : m_fds)
+        {
+            if(itr >= 0)
+                close(itr);
+            itr = -1;
+        }
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  sampling loop
+    //
+    void execute()
+    {
+        auto _interval = std::chrono::milliseconds(interval());
+        auto _start    = clock_type::now();
+        auto _next     = _start;
+
+        while(m_active)
+        {
+            timem_sample _sample{};
+            if(!read_process(m_pid, m_fds, _sample))
+                break;
+
+            if(descendants())
+            {
+                m_children.clear();
+                get_children(m_pid, m_children);
+                for(auto itr : m_children)
+                {
+                    int _fds[3] = { open_proc(itr, "stat"), open_proc(itr, "statm"),
+                                    open_proc(itr, "io") };
+                    timem_sample _child{};
+                    if(read_process(itr, _fds, _child))
+                        _sample += _child;
+                    for(auto& fitr : _fds)
+                        if(fitr >= 0)
+                            close(fitr);
+                }
+            }
+
+            _sample.time =
+                std::chrono::duration_cast<duration_type>(clock_type::now() - _start)
+                    .count();
+
+            m_buffer[m_count++] = _sample;
+            if(m_count == m_buffer.size())
+                flush();
+
+            _next += _interval;
+            std::this_thread::sleep_until(_next);
+        }
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  append the buffered samples to the output file
+    //
+    void flush()
+    {
+        if(!m_file || m_count == 0)
+            return;
+
+        if(binary())
+        {
+            fwrite(m_buffer.data(), sizeof(timem_sample), m_count, m_file);
+        }
+        else
+        {
+            for(uint64_t i = 0; i < m_count; ++i)
+            {
+                const auto& itr = m_buffer[i];
+                fprintf(m_file,
+                        "%lli,%lli,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+                        static_cast<long long>(itr.time),
+                        static_cast<long long>(itr.nproc),
+                        static_cast<unsigned long long>(itr.user_time),
+                        static_cast<unsigned long long>(itr.system_time),
+                        static_cast<unsigned long long>(itr.virtual_mem),
+                        static_cast<unsigned long long>(itr.resident),
+                        static_cast<unsigned long long>(itr.shared),
+                        static_cast<unsigned long long>(itr.read_bytes),
+                        static_cast<unsigned long long>(itr.write_bytes),
+                        static_cast<unsigned long long>(itr.minor_faults),
+                        static_cast<unsigned long long>(itr.major_faults),
+                        static_cast<unsigned long long>(itr.num_threads));
+            }
+        }
+        m_header.num_records += m_count;
+        m_count = 0;
+    }
+
+    //----------------------------------------------------------------------------------//
+
+    static int open_proc(pid_t _pid, const char* _name)
+    {
+        char _path[64];
+        snprintf(_path, sizeof(_path), "/proc/%li/%s", static_cast<long>(_pid), _name);
+        return open(_path, O_RDONLY | O_CLOEXEC);
+    }
+
+    static ssize_t read_proc(int _fd, char* _buf, size_t _size)
+    {
+        if(_fd < 0)
+            return -1;
+        auto _n = pread(_fd, _buf, _size - 1, 0);
+        _buf[(_n > 0) ? _n : 0] = '\0';
+        return _n;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  read /proc/<pid>/{stat,statm,io} into a sample
+    //
+    static bool read_process(pid_t, int* _fds, timem_sample& _sample)
+    {
+        static const uint64_t _page = sysconf(_SC_PAGESIZE);
+        char                  _buf[1024];
+
+        // /proc/<pid>/stat: the command name may contain spaces so parse after ')'
+        if(read_proc(_fds[0], _buf, sizeof(_buf)) <= 0)
+            return false;
+        const char* _pos = strrchr(_buf, ')');
+        if(!_pos)
+            return false;
+        char               _state = 0;
+        unsigned long      _minflt = 0, _majflt = 0, _utime = 0, _stime = 0;
+        long               _nthreads = 0;
+        unsigned long      _vsize    = 0;
+        unsigned long long _start    = 0;
+        long               _rss      = 0;
+        int _n = sscanf(_pos + 2,
+                        "%c %*d %*d %*d %*d %*d %*u %lu %*u %lu %*u %lu %lu %*d %*d %*d "
+                        "%*d %ld %*d %llu %lu %ld",
+                        &_state, &_minflt, &_majflt, &_utime, &_stime, &_nthreads,
+                        &_start, &_vsize, &_rss);
+        if(_n < 9)
+            return false;
+
+        _sample.nproc        = 1;
+        _sample.user_time    = _utime;
+        _sample.system_time  = _stime;
+        _sample.minor_faults = _minflt;
+        _sample.major_faults = _majflt;
+        _sample.num_threads  = _nthreads;
+        _sample.virtual_mem  = _vsize;
+        _sample.resident     = _rss * _page;
+
+        // /proc/<pid>/statm: size resident shared text lib data dt (pages)
+        if(read_proc(_fds[1], _buf, sizeof(_buf)) > 0)
+        {
+            unsigned long _size = 0, _resident = 0, _shared = 0;
+            if(sscanf(_buf, "%lu %lu %lu", &_size, &_resident, &_shared) == 3)
+            {
+                _sample.resident = _resident * _page;
+                _sample.shared   = _shared * _page;
+            }
+        }
+
+        // /proc/<pid>/io: may not be readable depending on permissions
+        if(read_proc(_fds[2], _buf, sizeof(_buf)) > 0)
+        {
+            const char* _read  = strstr(_buf, "\nread_bytes:");
+            const char* _write = strstr(_buf, "\nwrite_bytes:");
+            if(_read)
+                _sample.read_bytes = strtoull(_read + 12, nullptr, 10);
+            if(_write)
+                _sample.write_bytes = strtoull(_write + 13, nullptr, 10);
+        }
+
+        return true;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  recursively find the descendants via /proc/<pid>/task/<tid>/children
+    //
+    static void get_children(pid_t _pid, std::vector<pid_t>& _children)
+    {
+#if defined(_LINUX)
+        char _path[64];
+        snprintf(_path, sizeof(_path), "/proc/%li/task", static_cast<long>(_pid));
+        DIR* _dir = opendir(_path);
+        if(!_dir)
+            return;
+
+        std::vector<pid_t> _direct;
+        while(struct dirent* _entry = readdir(_dir))
+        {
+            if(_entry->d_name[0] == '.')
+                continue;
+            char _fname[320];
+            snprintf(_fname, sizeof(_fname), "/proc/%li/task/%s/children",
+                     static_cast<long>(_pid), _entry->d_name);
+            int _fd = open(_fname, O_RDONLY | O_CLOEXEC);
+            if(_fd < 0)
+                continue;
+            char _buf[4096];
+            if(read_proc(_fd, _buf, sizeof(_buf)) > 0)
+            {
+                char* _end = nullptr;
+                for(const char* _itr = _buf; *_itr != '\0'; _itr = _end)
+                {
+                    auto _child = strtol(_itr, &_end, 10);
+                    if(_end == _itr)
+                        break;
+                    _direct.push_back(static_cast<pid_t>(_child));
+                }
+            }
+            close(_fd);
+        }
+        closedir(_dir);
+
+        for(auto itr : _direct)
+        {
+            _children.push_back(itr);
+            get_children(itr, _children);
+        }
+#else
+        tim::consume_parameters(_pid, _children);
+#endif
+    }
+
+private:
+    pid_t                        m_pid;
+    std::atomic<bool>            m_active{ false };
+    int                          m_fds[3] = { -1, -1, -1 };
+    uint64_t                     m_count  = 0;
+    std::vector<timem_sample>    m_buffer;
+    std::vector<pid_t>           m_children;
+    std::unique_ptr<std::thread> m_thread;
+    FILE*                        m_file = nullptr;
+    std::string                  m_fname;
+    header                       m_header;
+};
+
+//--------------------------------------------------------------------------------------//
+
+timem_sampler*&
+get_sampler()
+{
+    static timem_sampler* _instance = nullptr;
+    return _instance;
+}
+
+//--------------------------------------------------------------------------------------//
+//
+//  Process-tree aggregation
+//
+//  TIMEM_PROCESS_TREE          track every descendant of the child
+//
+//  timem becomes a child subreaper (PR_SET_CHILD_SUBREAPER) so orphaned descendants
+//  are re-parented to timem instead of init. Every process which exits is found with
+//  waitid(WNOWAIT) so that /proc/<pid>/{comm,stat,io} can be read from the zombie
+//  before it is reaped with wait4(2) to get its rusage. The results are accumulated
+//  per command name. timem waits for descendants until the child it launched has
+//  exited, after which only descendants which have already exited are reaped so that
+//  a daemonized or long-lived descendant cannot keep timem running. A process which
+//  is reaped by another descendant (e.g. a shell waiting on a pipeline) is included
+//  in the rusage and io of the descendant which reaped it.
+//
+//--------------------------------------------------------------------------------------//
+
+class timem_process_tree
+{
+public:
+    struct entry
+    {
+        int64_t  count       = 0;
+        double   wall        = 0.0;  // seconds
+        double   cpu         = 0.0;  // seconds
+        int64_t  peak_rss    = 0;    // kilobytes
+        uint64_t read_bytes  = 0;
+        uint64_t write_bytes = 0;
+    };
+
+    using entry_map_t = std::map<std::string, entry>;
+
+    static bool& enabled()
+    {
+        static bool _instance = tim::get_env<bool>("TIMEM_PROCESS_TREE", false);
+        return _instance;
+    }
+
+    static entry_map_t& get_entries()
+    {
+        static entry_map_t _instance;
+        return _instance;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  must be called before the fork
+    //
+    static void configure()
+    {
+#if defined(_LINUX) && defined(PR_SET_CHILD_SUBREAPER)
+        if(enabled() && prctl(PR_SET_CHILD_SUBREAPER, 1, 0, 0, 0) != 0)
+        {
+            perror("[timem]> prctl(PR_SET_CHILD_SUBREAPER)");
+            enabled() = false;
+        }
+#else
+        enabled() = false;
+#endif
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  reap descendants until "_main" is reaped, then reap the descendants which have
+    //  already exited without blocking. Returns true if "_main" was reaped and sets
+    //  the status
+    //
+    static bool wait_all(pid_t _main, int& _status)
+    {
+#if defined(_LINUX)
+        bool _found = false;
+        while(true)
+        {
+            siginfo_t _info;
+            memset(&_info, 0, sizeof(_info));
+            int _flags = WEXITED | WNOWAIT | ((_found) ? WNOHANG : 0);
+            if(waitid(P_ALL, 0, &_info, _flags) != 0)
+            {
+                if(errno == EINTR)
+                    continue;
+                break;  // ECHILD: no more descendants
+            }
+
+            // with WNOHANG, si_pid is zero when no descendant has exited
+            pid_t _pid = _info.si_pid;
+            if(_pid <= 0)
+            {
+                if(_found)
+                    break;
+                continue;
+            }
+
+            // read the information of the zombie before it is reaped
+            std::string _name;
+            entry       _entry;
+            read_zombie(_pid, _name, _entry);
+
+            int           _st = 0;
+            struct rusage _ru;
+            memset(&_ru, 0, sizeof(_ru));
+            if(wait4(_pid, &_st, 0, &_ru) != _pid)
+                continue;
+
+            _entry.count    = 1;
+            _entry.cpu      = to_seconds(_ru.ru_utime) + to_seconds(_ru.ru_stime);
+            _entry.peak_rss = _ru.ru_maxrss;
+
+            auto& _itr = get_entries()[_name];
+            _itr.count += _entry.count;
+            _itr.wall += _entry.wall;
+            _itr.cpu += _entry.cpu;
+            _itr.peak_rss = std::max(_itr.peak_rss, _entry.peak_rss);
+            _itr.read_bytes += _entry.read_bytes;
+            _itr.write_bytes += _entry.write_bytes;
+
+            if(_pid == _main)
+            {
+                _status = _st;
+                _found  = true;
+            }
+        }
+        return _found;
+#else
+        return (waitpid(_main, &_status, 0) > 0);
+#endif
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  per-command breakdown sorted by cpu time
+    //
+    static std::string report()
+    {
+        using pair_t = std::pair<std::string, entry>;
+        std::vector<pair_t> _entries(get_entries().begin(), get_entries().end());
+        std::sort(_entries.begin(), _entries.end(),
+                  [](const pair_t& lhs, const pair_t& rhs) {
+                      return lhs.second.cpu > rhs.second.cpu;
+                  });
+
+        int64_t _nproc = 0;
+        size_t  _width = 7;
+        for(const auto& itr : _entries)
+        {
+            _nproc += itr.second.count;
+            _width = std::max(_width, itr.first.length());
+        }
+
+        const double _mb = tim::units::megabyte;
+
+        std::stringstream ss;
+        ss << "\n[" << command() << "] process tree (" << _nproc << " processes):\n";
+        ss << "    " << std::setw(_width) << std::left << "COMMAND" << std::right
+           << std::setw(8) << "COUNT" << std::setw(14) << "WALL (sec)" << std::setw(14)
+           << "CPU (sec)" << std::setw(16) << "PEAK RSS (MB)" << std::setw(14)
+           << "READ (MB)" << std::setw(14) << "WRITE (MB)" << "\n";
+        ss << std::fixed << std::setprecision(3);
+        for(const auto& itr : _entries)
+        {
+            const auto& _e = itr.second;
+            ss << "    " << std::setw(_width) << std::left << itr.first << std::right
+               << std::setw(8) << _e.count << std::setw(14) << _e.wall << std::setw(14)
+               << _e.cpu << std::setw(16) << (_e.peak_rss * tim::units::kilobyte) / _mb
+               << std::setw(14) << _e.read_bytes / _mb << std::setw(14)
+               << _e.write_bytes / _mb << "\n";
+        }
+        return ss.str();
+    }
+
+private:
+    static double to_seconds(const struct timeval& _tv)
+    {
+        return static_cast<double>(_tv.tv_sec) + 1.0e-6 * _tv.tv_usec;
+    }
+
+    //----------------------------------------------------------------------------------//
+    //  command name, wall-clock time, and io of an un-reaped process
+    //
+    static void read_zombie(pid_t _pid, std::string& _name, entry& _entry)
+    {
+        char _path[64];
+        char _buf[1024];
+
+        auto _read = [&](const char* _file) {
+            snprintf(_path, sizeof(_path), "/proc/%li/%s", static_cast<long>(_pid), _file);
+            FILE* _fp = fopen(_path, "r");
+            if(!_fp)
+                return false;
+            auto _n  = fread(_buf, 1, sizeof(_buf) - 1, _fp);
+            _buf[_n] = '\0';
+            fclose(_fp);
+            return (_n > 0);
+        };
+
+        _name = "unknown";
+        if(_read("comm"))
+        {
+            _name = _buf;
+            while(!_name.empty() && _name.back() == '\n')
+                _name.pop_back();
+        }
+
+        // field 22 of /proc/<pid>/stat is the start time in clock ticks since boot
+        if(_read("stat"))
+        {
+            const char*        _pos   = strrchr(_buf, ')');
+            unsigned long long _start = 0;
+            if(_pos && sscanf(_pos + 2,
+                              "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d "
+                              "%*d %*d %*d %*d %*d %llu",
+                              &_start) == 1)
+            {
+                struct timespec _ts;
+#if defined(CLOCK_BOOTTIME)
+                clock_gettime(CLOCK_BOOTTIME, &_ts);
+#else
+                clock_gettime(CLOCK_MONOTONIC, &_ts);
+#endif
+                double _now = _ts.tv_sec + 1.0e-9 * _ts.tv_nsec;
+                double _beg = static_cast<double>(_start) / sysconf(_SC_CLK_TCK);
+                _entry.wall = std::max(0.0, _now - _beg);
+            }
+        }
+
+        if(_read("io"))
+        {
+            const char* _rb = strstr(_buf, "\nread_bytes:");
+            const char* _wb = strstr(_buf, "\nwrite_bytes:");
+            if(_rb)
+                _entry.read_bytes = strtoull(_rb + 12, nullptr, 10);
+            if(_wb)
+                _entry.write_bytes = strtoull(_wb + 13, nullptr, 10);
+        }
+    }
+};
+
 //--------------------------------------------------------------------------------------//
 
 declare_attribute(noreturn) void failed_fork()
@@ -184,10 +857,18 @@ parent_process(pid_t pid)
     // see wait() man page for all the flags or options
     // used here
 
-    int status;
+    int status = 0;
     int ret = 0;
 
-    if(waitpid(pid, &status, 0) > 0)
+    // start the time-series sampling of the child (if enabled)
+    get_sampler() = new timem_sampler(pid);
+    get_sampler()->start();
+
+    bool _reaped = (timem_process_tree::enabled())
+                       ? timem_process_tree::wait_all(pid, status)
+                       : (waitpid(pid, &status, 0) > 0);
+
+    if(_reaped)
     {
         get_measure()->stop();
 
@@ -218,8 +899,13 @@ parent_process(pid_t pid)
         printf("waitpid() failed\n");
     }
 
+    delete get_sampler();
+    get_sampler() = nullptr;
+
     std::stringstream _oss;
     _oss << "\n" << *get_measure() << std::flush;
+    if(timem_process_tree::enabled())
+        _oss << timem_process_tree::report() << std::flush;
 
     if(tim::settings::file_output())
     {
@@ -415,6 +1101,9 @@ main(int argc, char** argv)
     tim::get_rusage_type() = RUSAGE_CHILDREN;
     get_measure()          = new comp_tuple_t(compose_prefix());
 
+    // become a subreaper for the process tree (if enabled)
+    timem_process_tree::configure();
+
     get_measure()->start();
 
     pid_t pid = fork();
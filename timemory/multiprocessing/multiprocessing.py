@@ -0,0 +1,151 @@
+#!@PYTHON_EXECUTABLE@
+#
+# MIT License
+#
+# Copyright (c) 2018, The Regents of the University of California,
+# through Lawrence Berkeley National Laboratory (subject to receipt of any
+# required approvals from the U.S. Dept. of Energy).  All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+## @file multiprocessing.py
+## Aggregation of the data of multiprocessing workers for TiMemory module
+##
+## The workers of a Pool send their storage to the parent process in a compact
+## binary form (see timemory.pack) when they exit and the parent merges it into its
+## own storage when the pool is joined, i.e. the pool produces one profile.
+##
+
+from __future__ import absolute_import
+import threading
+import multiprocessing as _mp
+from multiprocessing import util as _util
+
+__all__ = ['collect',
+           'merge',
+           'Pool']
+
+
+#----------------------------------------------------------------------------------------#
+def collect():
+    """Returns the storage data of this process in a compact binary form"""
+    import timemory
+    return timemory.pack()
+
+
+#----------------------------------------------------------------------------------------#
+def merge(data):
+    """Merges the storage data returned by collect() in another process"""
+    import timemory
+    if data:
+        timemory.merge(data)
+
+
+#----------------------------------------------------------------------------------------#
+def _worker_exit(conn, lock):
+    data = collect()
+    # an empty message marks the end of the data
+    if data:
+        with lock:
+            conn.send_bytes(data)
+    conn.close()
+
+
+#----------------------------------------------------------------------------------------#
+def _worker_init(conn, lock, initializer, initargs):
+    import timemory
+    # forked workers inherit the storage data of the parent
+    timemory.clear()
+    timemory.settings.auto_output = False
+    _util.Finalize(None, _worker_exit, args=(conn, lock), exitpriority=100)
+    if initializer is not None:
+        initializer(*initargs)
+
+
+#----------------------------------------------------------------------------------------#
+class Pool(object):
+    """
+    multiprocessing.Pool whose workers send their storage data to this process when
+    they exit. The data is merged into the storage of the thread which calls join().
+    The data of the workers is discarded if the pool is terminated. When used as a
+    context manager, the pool is closed and joined (instead of terminated) on exit.
+    """
+
+    def __init__(self, processes=None, initializer=None, initargs=(),
+                 maxtasksperchild=None, context=None):
+        ctx = context if context is not None else _mp
+        self._reader, self._writer = ctx.Pipe(duplex=False)
+        self._lock = ctx.Lock()
+        self._data = []
+        self._discard = False
+        # drain the pipe while the pool runs so the workers never block on exit
+        self._thread = threading.Thread(target=self._receive)
+        self._thread.daemon = True
+        self._thread.start()
+        self._pool = ctx.Pool(processes, _worker_init,
+                              (self._writer, self._lock, initializer, initargs),
+                              maxtasksperchild)
+
+    def __getattr__(self, name):
+        if name == '_pool':
+            raise AttributeError(name)
+        return getattr(self._pool, name)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        if exc_type is None:
+            self.close()
+        else:
+            self.terminate()
+        self.join()
+
+    def _receive(self):
+        while True:
+            try:
+                data = self._reader.recv_bytes()
+            except (EOFError, OSError):
+                break
+            if not data:
+                break
+            self._data.append(data)
+
+    def close(self):
+        self._pool.close()
+
+    def terminate(self):
+        self._discard = True
+        self._pool.terminate()
+
+    def join(self):
+        self._pool.join()
+        if self._thread is None:
+            return
+        if not self._discard:
+            # every worker has exited so its data is already in the pipe
+            self._writer.send_bytes(b'')
+            self._thread.join()
+            for data in self._data:
+                merge(data)
+        self._thread = None
+        self._data = []
+        self._reader.close()
+        self._writer.close()
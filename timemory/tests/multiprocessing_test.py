@@ -0,0 +1,122 @@
+#!@PYTHON_EXECUTABLE@
+#
+# MIT License
+#
+# Copyright (c) 2018, The Regents of the University of California, 
+# through Lawrence Berkeley National Laboratory (subject to receipt of any 
+# required approvals from the U.S. Dept. of Energy).  All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+## @file multiprocessing_test.py
+## Test of the aggregation of multiprocessing workers (timemory.multiprocessing)
+##
+
+import sys
+import os
+import unittest as unittest
+import traceback
+
+import timemory
+
+nprocs = 2
+ntasks = 8
+task_key = 'multiprocessing_task'
+
+
+# ---------------------------------------------------------------------------- #
+def fibonacci(n):
+    return n if n < 2 else fibonacci(n - 1) + fibonacci(n - 2)
+
+
+# ---------------------------------------------------------------------------- #
+def task(n):
+    t = timemory.timer(task_key)
+    t.start()
+    ret = fibonacci(n)
+    t.stop()
+    return (os.getpid(), ret)
+
+
+# ---------------------------------------------------------------------------- #
+def get_laps(data, key):
+    """Returns the laps of the graph entries whose prefix contains key, per
+    component"""
+    laps = {}
+    for label, obj in data.get('rank', {}).items():
+        if not isinstance(obj, dict) or 'graph' not in obj:
+            continue
+        for itr in obj['graph']:
+            if key in itr['prefix']:
+                laps[label] = laps.get(label, 0) + itr['entry']['laps']
+    return laps
+
+
+# ============================================================================ #
+class multiprocessing_test(unittest.TestCase):
+
+    # ------------------------------------------------------------------------ #
+    def setUp(self):
+        timemory.settings.output_path = "test_output"
+        timemory.settings.enabled = True
+        timemory.clear()
+
+    # ------------------------------------------------------------------------ #
+    # The laps recorded by the workers of a pool are merged into the parent
+    def test_1_pool_laps(self):
+        print('\n\n--> Testing function: "{}"...\n\n'.format(timemory.FUNC()))
+
+        with timemory.multiprocessing.Pool(nprocs) as pool:
+            results = pool.map(task, [15] * ntasks)
+
+        # the tasks ran in the workers, not in this process
+        pids = set([itr[0] for itr in results])
+        self.assertFalse(os.getpid() in pids)
+        self.assertEqual(len(results), ntasks)
+
+        laps = get_laps(timemory.get(), task_key)
+        print('laps: {}'.format(laps))
+
+        self.assertTrue(len(laps) > 0)
+        for label, nlaps in laps.items():
+            self.assertEqual(nlaps, ntasks, label)
+
+    # ------------------------------------------------------------------------ #
+    # The data of the workers is discarded if the pool is terminated
+    def test_2_pool_terminate(self):
+        print('\n\n--> Testing function: "{}"...\n\n'.format(timemory.FUNC()))
+
+        pool = timemory.multiprocessing.Pool(nprocs)
+        pool.map(task, [10] * ntasks)
+        pool.terminate()
+        pool.join()
+
+        self.assertEqual(get_laps(timemory.get(), task_key), {})
+
+
+# ---------------------------------------------------------------------------- #
+if __name__ == '__main__':
+    try:
+        unittest.main(verbosity=5, buffer=False)
+    except Exception as e:
+        exc_type, exc_value, exc_traceback = sys.exc_info()
+        traceback.print_exception(exc_type, exc_value, exc_traceback, limit=5)
+        print('Exception - {}'.format(e))
+        raise
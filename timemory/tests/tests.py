@@ -56,7 +56,7 @@ def run(pattern="", exit_at_failure=True):
     """
     import timemory
     manager = timemory.manager()
-    test_names = [ 'timemory', 'array', 'nested', 'simple' ]
+    test_names = [ 'timemory', 'array', 'nested', 'simple', 'multiprocessing' ]
     names = []
     try:
         import re